@@ -0,0 +1,21 @@
+#pragma once
+
+#ifndef CHEAP_ALLOCATOR_AVAILABLE
+#define CHEAP_ALLOCATOR_AVAILABLE
+#endif
+
+#include <stddef.h>
+
+// The memory source behind a container. Every buffer, page and node block the
+// container allocates goes through it, and ctx is handed back on every call.
+// A zeroed Allocator uses the standard library. Otherwise alloc and free must
+// be set, while a NULL realloc is emulated by alloc, copy and free. realloc is
+// told the old size, so sources that cannot look it up can still move the
+// contents.
+typedef struct Allocator
+{
+	void *(*alloc)(void *ctx, size_t size);
+	void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+	void (*free)(void *ctx, void *ptr);
+	void *ctx;
+} Allocator;
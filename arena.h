@@ -4,16 +4,86 @@
 #define CHEAP_ARENA_AVAILABLE
 #endif
 
+#include "allocator.h"
+#include "large_page.h"
 #include <stddef.h>
 
 #define ALLOC __attribute__((warn_unused_result))
 
 typedef struct Arena Arena;
 
+// A save point in an arena. Resetting to it releases everything allocated
+// since, including any pages the arena grew by.
+typedef struct ArenaMark
+{
+	void  *page;
+	void  *large;
+	size_t offset;
+} ArenaMark;
+
+// A scope of temporary allocations that is rolled back as a whole.
+typedef struct ArenaScratch
+{
+	Arena    *arena;
+	ArenaMark mark;
+} ArenaScratch;
+
 ALLOC Arena *create_arena(size_t size);
 void         destroy_arena(Arena **arena);
 
+// Reserves reserve bytes of address space without backing memory and commits
+// it as allocations reach it. The arena never grows past the reservation, so
+// every allocation stays contiguous and nothing is ever malloc'd. Allocations
+// that do not fit in the rest of the reservation, or that the system refuses to
+// commit, return NULL. A clear returns the committed memory beyond the
+// retention budget to the system.
+ALLOC Arena *create_virtual_arena(size_t reserve);
+
+// Maps every page straight from the system with the LargePageFlags in flags,
+// so pages can be backed by huge pages and faulted in up front. Pages are
+// rounded up to whole (huge) pages and the arena uses all of each one.
+ALLOC Arena *create_large_page_arena(size_t size, unsigned flags);
+
+// plain allocations are aligned for any standard type (max_align_t)
 ALLOC void *alloc_arena(Arena *arena, size_t size);
 ALLOC void *calloc_arena(Arena *arena, size_t size);
 
+// Grows or shrinks in place when ptr is the latest allocation and its page has
+// room, otherwise copies to a new allocation. The old memory is not reused.
+ALLOC void *realloc_arena(Arena *arena,
+                          void  *ptr,
+                          size_t old_size,
+                          size_t new_size);
+
+// align must be a power of two
+ALLOC void *alloc_arena_aligned(Arena *arena, size_t size, size_t align);
+ALLOC void *calloc_arena_aligned(Arena *arena, size_t size, size_t align);
+
+// aligned to a 64-byte cache line, for SIMD buffers and contended atomics
+ALLOC void *alloc_arena_cache_line(Arena *arena, size_t size);
+
+// Allocations larger than the current page get a page of their own sized to
+// fit. A clear keeps the largest page for the next cycle.
 void clear_arena(Arena *arena);
+
+// Pages released by a clear or a reset are kept for reuse, up to budget bytes
+// in total, instead of being freed. The budget starts at zero.
+void retain_arena(Arena *arena, size_t budget);
+
+// Each thread gets its own arena, created on first use and destroyed when the
+// thread exits. Threads that outlive their work, including the main thread,
+// should release it themselves. Returns NULL if the system cannot provide the
+// thread-specific key the arenas are destroyed through.
+Arena *thread_arena(void);
+void   release_thread_arena(void);
+
+// Backs a container with the arena. Nodes and buffers the container frees are
+// not reused until the arena is cleared or reset, so the arena must outlive
+// the container.
+Allocator arena_allocator(Arena *arena);
+
+ArenaMark mark_arena(const Arena *arena);
+void      reset_arena(Arena *arena, ArenaMark mark);
+
+ArenaScratch begin_scratch_arena(Arena *arena);
+void         end_scratch_arena(ArenaScratch scratch);
@@ -10,6 +10,12 @@ typedef struct Array Array;
 ALLOC Array *create_array(size_t size, size_t nmemb);
 void         destroy_array(Array **array);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC Array *create_array_with_allocator(size_t    size,
+                                         size_t    nmemb,
+                                         Allocator allocator);
+#endif
+
 void set_array(Array *array, const void *value, size_t index);
 
 void *at_array(const Array *array, size_t index);
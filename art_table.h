@@ -0,0 +1,253 @@
+/**
+ * @file art_table.h
+ * @brief Adaptive radix tree table implementation for C
+ *
+ * This header defines a sorted key-value pair @c ArtTable
+ * which stores pairs in an adaptive radix tree. Keys are ordered by their
+ * bytes rather than by a comparison function and the table supports
+ * standard operations such as @c insert @c erase @c find and @c clear as well
+ * as prefix queries.
+ *
+ * @author Riain Ó Tuathail
+ * @date 2026-10-19
+ * @version 0.1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+#ifndef CHEAP_KEY_VALUE_PAIR_DEFINED
+typedef struct PairKV
+{
+	const void *key;
+	void       *value;
+} PairKV;
+#define CHEAP_KEY_VALUE_PAIR_DEFINED
+#endif
+
+/**
+ * @brief A sorted associative container that stores key-value pairs with unique
+ * keys in an adaptive radix tree
+ *
+ * A lookup follows one byte of the key per level, so its cost depends on the
+ * key length rather than on the number of pairs, and no comparison function is
+ * called. Inner nodes grow and shrink between four sizes (4, 16, 48 and 256
+ * children) to keep sparse levels small, and single-child paths are compressed
+ * into their parent.
+ *
+ * Keys are either null-terminated strings, when @c k_size is zero, or unsigned
+ * integers of @c k_size bytes. Strings are ordered bytewise as by strcmp() and
+ * integers are ordered numerically.
+ *
+ * @warning The ArtTable object must be constructed and destroyed by the
+ * provided functions
+ * @note The ArtTable object is a pointer to an incomplete type and should not
+ * be dereferenced
+ * @note Prefer a @c Table when keys need a custom ordering
+ */
+typedef struct ArtTable ArtTable;
+
+/**
+ * @brief Create an ArtTable object
+ *
+ * @param k_size The size of the key type, or 0 for null-terminated strings
+ * @param v_size The size of the value type
+ * @return ArtTable object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_art_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ * @note Signed integer keys are ordered by their two's complement bit pattern,
+ * so negative keys sort after positive ones
+ */
+ALLOC ArtTable *create_art_table(size_t k_size, size_t v_size);
+
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create an ArtTable object whose memory comes from @p allocator
+ *
+ * @param k_size The size of the key type, or 0 for null-terminated strings
+ * @param v_size The size of the value type
+ * @param allocator The source of every allocation the table makes
+ * @return ArtTable object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_art_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ * @note Signed integer keys are ordered by their two's complement bit pattern,
+ * so negative keys sort after positive ones
+ * @note The table keeps a copy of @p allocator, whose context must
+ * outlive the table
+ */
+ALLOC ArtTable *create_art_table_with_allocator(size_t    k_size,
+                                                size_t    v_size,
+                                                Allocator allocator);
+#endif
+
+/**
+ * @brief Destroy an ArtTable object
+ *
+ * @param table A pointer to an ArtTable object
+ * @return Nothing
+ *
+ * @note The ArtTable object is set to NULL upon successful execution
+ */
+void destroy_art_table(ArtTable **table);
+
+/**
+ * @brief Insert a @p key @p value pair into the table
+ *
+ * @param table The ArtTable object
+ * @param key The key to insert
+ * @param value The value to insert
+ * @return Nothing
+ *
+ * @warning Ensure @p key and @p value are of the correct specialised types
+ * @note If the key already exists its value is replaced
+ */
+void insert_art_table(ArtTable *table, const void *key, const void *value);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Inserts unique copies of @p range key-value pairs into the table
+ *
+ * @param table The ArtTable object
+ * @param range The range to insert
+ * @return Nothing
+ *
+ * @warning The range must iterate over @p PairKV types
+ */
+void insert_range_art_table(ArtTable *table, Range range);
+#endif
+
+/**
+ * @brief Count the number of @p key @c value pairs in the table with an
+ * equivalent @p key
+ *
+ * @param table The ArtTable object
+ * @param key Key from which to count the resulting stored elements
+ * @return The count of @p key @c value pairs in the table
+ *
+ * @note Because keys are unique the result is always either 1 or 0
+ */
+size_t count_art_table(const ArtTable *table, const void *key);
+
+/**
+ * @brief Finds a @c value with key equivalent to @p key
+ *
+ * @param table The ArtTable object
+ * @param key Key from which to derive the @c value
+ * @return Pointer to the @c value if found, @c NULL otherwise
+ *
+ * @note The pointer stays valid until its pair is erased
+ * @note The result is of @c void* type and must be cast to the correct type
+ */
+void *find_art_table(const ArtTable *table, const void *key);
+
+/**
+ * @brief Check if there is a @c value with @p key equivalent in the table
+ *
+ * @param table The ArtTable object
+ * @param key Key from which to find the @c value
+ * @return @c true if found, @c false otherwise
+ */
+bool contains_art_table(const ArtTable *table, const void *key);
+
+/**
+ * @brief Erases the @p key @c value pair from the table
+ *
+ * @param table The ArtTable object
+ * @param key The key to erase the equivalent @p key @c value pair
+ * @return Nothing
+ *
+ * @note If no @p key @c value pair is found the function does nothing
+ */
+void erase_art_table(ArtTable *table, const void *key);
+
+/**
+ * @brief Erases all pairs from the table
+ *
+ * @param table The ArtTable object
+ * @return Nothing
+ */
+void clear_art_table(ArtTable *table);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Returns the range of pairs whose keys begin with @p prefix
+ *
+ * @param table The ArtTable object
+ * @param prefix The leading key bytes to match
+ * @param length The number of bytes in @p prefix
+ * @return Range over the matching pairs in key order, empty if none match
+ *
+ * @warning The range is invalidated by the next insert or erase
+ * @note For string keys pass strlen(prefix) as @p length; including the null
+ * terminator matches the exact key only
+ * @note For integer keys the prefix is read most significant byte first, so a
+ * @p length of 1 selects the keys sharing the top byte of @p prefix
+ */
+Range prefix_art_table(const ArtTable *table,
+                       const void     *prefix,
+                       size_t          length);
+#endif
+
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Returns an iterator to the first element of the table
+ *
+ * @param table The ArtTable object
+ * @return Iterator to the first element
+ *
+ * @note Leaves are chained in key order so iteration never visits inner nodes
+ */
+Iter begin_art_table(const ArtTable *table);
+
+/**
+ * @brief Returns an iterator to the end of the table
+ *
+ * @param table The ArtTable object
+ * @return Sentinel iterator representing the end of the table
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter end_art_table(const ArtTable *table);
+
+/**
+ * @brief Returns a reverse iterator to the last element of the table
+ *
+ * @param table The ArtTable object
+ * @return Reverse iterator to the last element
+ */
+Iter rbegin_art_table(const ArtTable *table);
+
+/**
+ * @brief Returns an iterator to the reverse end of the table
+ *
+ * @param table The ArtTable object
+ * @return Sentinel iterator representing the reverse end of the table
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter rend_art_table(const ArtTable *table);
+#endif
+
+/**
+ * @brief Checks if the table has no pairs
+ *
+ * @param table The ArtTable object
+ * @return @c true if the table is empty, @c false otherwise
+ */
+bool empty_art_table(const ArtTable *table);
+
+/**
+ * @brief Returns the number of pairs in the table
+ *
+ * @param table The ArtTable object
+ * @return Number of elements in the table
+ */
+size_t size_art_table(const ArtTable *table);
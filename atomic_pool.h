@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+typedef struct AtomicPoolAlloc AtomicPoolAlloc;
+typedef struct PoolMagazine    PoolMagazine;
+
+// A pool that any number of threads may allocate from and free to at once. The
+// free lists are lock-free stacks and the pool grows by chaining chunks.
+ALLOC AtomicPoolAlloc *create_atomic_pool_allocator(size_t nmemb, size_t size);
+void                   destroy_atomic_pool_allocator(AtomicPoolAlloc **pool);
+
+ALLOC void *alloc_atomic_pool_allocator(AtomicPoolAlloc *pool);
+ALLOC void *calloc_atomic_pool_allocator(AtomicPoolAlloc *pool);
+
+void free_atomic_pool_allocator(AtomicPoolAlloc *pool, void *ptr);
+
+// A magazine caches blocks for a single thread and trades them with the pool a
+// full batch at a time. It must be used by one thread only and destroyed
+// before its pool.
+ALLOC PoolMagazine *create_pool_magazine(AtomicPoolAlloc *pool);
+void                destroy_pool_magazine(PoolMagazine **magazine);
+
+ALLOC void *alloc_pool_magazine(PoolMagazine *magazine);
+ALLOC void *calloc_pool_magazine(PoolMagazine *magazine);
+
+void free_pool_magazine(PoolMagazine *magazine, void *ptr);
@@ -9,8 +9,23 @@ typedef struct BumpAlloc BumpAlloc;
 ALLOC BumpAlloc *create_bump_allocator(size_t size);
 void             destroy_bump_allocator(BumpAlloc **bump);
 
+// Plain allocations are aligned for any standard type (max_align_t). Every
+// allocation returns NULL once the rest of the region cannot hold it.
 ALLOC void *bump_alloc(BumpAlloc *bump, size_t size);
 ALLOC void *bump_calloc(BumpAlloc *bump, size_t size);
+
+// align must be a power of two
+ALLOC void *bump_alloc_aligned(BumpAlloc *bump, size_t size, size_t align);
+
+// aligned to a 64-byte cache line, for SIMD buffers and contended atomics
+ALLOC void *bump_alloc_cache_line(BumpAlloc *bump, size_t size);
 ALLOC void *bump_salloc(BumpAlloc *bump, const char *string);
 
+// Lock-free variants for a region shared between threads. They may run
+// concurrently with each other but not with the plain calls or bump_clear.
+ALLOC void *bump_alloc_atomic(BumpAlloc *bump, size_t size);
+ALLOC void *bump_alloc_atomic_aligned(BumpAlloc *bump,
+                                      size_t     size,
+                                      size_t     align);
+
 void bump_clear(BumpAlloc *bump);
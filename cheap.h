@@ -147,10 +147,14 @@
 
 
 #define reserve(container, new_cap) _Generic((container), \
+    FList*:  reserve_forward_list,                        \
+    List*:   reserve_list,                                \
     Vector*: reserve_vector                               \
 )(container, new_cap)
 
 #define shrink_to_fit(container) _Generic((container), \
+    FList*:  shrink_to_fit_forward_list,               \
+    List*:   shrink_to_fit_list,                       \
     Vector*: shrink_to_fit_vector                      \
 )(container)
 
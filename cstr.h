@@ -44,6 +44,8 @@ void string_slice(String str, uint32_t start, uint32_t end);
 void string_strip(String str, const char *reject);
 
 #ifdef CHEAP_ARENA_AVAILABLE
+// Arena strings are NULL when the arena has no room left for them, as can
+// happen with a virtual arena. A string that fails to grow is left unchanged.
 ALLOC FORMAT_EXT String arena_string_new(Arena *arena, const char *fmt, ...);
 ALLOC String            arena_string_from_stream(Arena *arena, FILE *stream);
 
@@ -10,6 +10,10 @@ typedef struct DoubleEndedQueue DoubleEndedQueue, Deque;
 ALLOC Deque *create_deque(size_t size);
 void         destroy_deque(Deque **deque);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC Deque *create_deque_with_allocator(size_t size, Allocator allocator);
+#endif
+
 void push_front_deque(Deque *deque, const void *value);
 void push_back_deque(Deque *deque, const void *value);
 void insert_deque(Deque *deque, const void *value, size_t index);
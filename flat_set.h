@@ -0,0 +1,231 @@
+/**
+ * @file flat_set.h
+ * @brief Flat set implementation for C
+ *
+ * This header defines a sorted associative @c FlatSet
+ * which stores unique keys in a single contiguous array. The sort comparison
+ * function is provided by the user and the set supports
+ * standard operations such as @c insert @c erase @c find and @c clear .
+ *
+ * @author Riain Ó Tuathail
+ * @date 2026-10-19
+ * @version 0.1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+/**
+ * @brief A sorted associative container that stores unique keys contiguously
+ *
+ * Keys are sorted using the @p compare function pointer provided during
+ * initialisation and laid out in Eytzinger (breadth-first) order, so a search
+ * touches one predictable path through the array and the next levels can be
+ * prefetched. Find has logarithmic complexity.
+ *
+ * Inserts are appended to a pending buffer and sort-merged into the array on
+ * the next read, so a batch of @c n inserts costs one O(n log n) merge rather
+ * than @c n individual insertions. Erase is linear.
+ *
+ * @warning The FlatSet object must be constructed and destroyed by the
+ * provided functions
+ * @note The FlatSet object is a pointer to an incomplete type and should not be
+ * dereferenced
+ * @note Prefer a @c Set when inserts and erases are interleaved with lookups
+ */
+typedef struct FlatSet FlatSet;
+
+/**
+ * @brief A comparison function for sorting keys
+ *
+ * @param a The first key
+ * @param b The second key
+ *
+ * @return An integer less than, equal to, or greater than zero depending on the
+ * comparison.
+ */
+typedef int (*KComp)(const void *, const void *);
+
+/**
+ * @brief Create a FlatSet object
+ *
+ * @param size The size of the key type
+ * @param compare A function pointer for comparing keys
+ * @return FlatSet object specialised for the given key type
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass set to destroy_flat_set() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ */
+ALLOC FlatSet *create_flat_set(size_t size, KComp compare);
+
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a FlatSet object whose memory comes from @p allocator
+ *
+ * @param size The size of the key type
+ * @param compare A function pointer for comparing keys
+ * @param allocator The source of every allocation the set makes
+ * @return FlatSet object specialised for the given key type
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass set to destroy_flat_set() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The set keeps a copy of @p allocator, whose context must
+ * outlive the set
+ */
+ALLOC FlatSet *create_flat_set_with_allocator(size_t    size,
+                                              KComp     compare,
+                                              Allocator allocator);
+#endif
+
+/**
+ * @brief Destroy a FlatSet object
+ *
+ * @param set A pointer to a FlatSet object
+ * @return Nothing
+ *
+ * @note The FlatSet object is set to NULL upon successful execution
+ */
+void destroy_flat_set(FlatSet **set);
+
+/**
+ * @brief Insert a @p key into the set
+ *
+ * @param set The FlatSet object
+ * @param key The key to insert
+ * @return Nothing
+ *
+ * @warning Ensure @p key is of the correct specialised type
+ * @note The key is merged into the set on the next read
+ */
+void insert_flat_set(FlatSet *set, const void *key);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Inserts unique copies of @p range elements into the set
+ *
+ * @param set The FlatSet object
+ * @param range The range to insert
+ * @return Nothing
+ *
+ * @note The keys are merged into the set on the next read
+ */
+void insert_range_flat_set(FlatSet *set, Range range);
+#endif
+
+/**
+ * @brief Count the number of @c keys in the set
+ *
+ * @param set The FlatSet object
+ * @param key Key to count
+ * @return The count of @c keys in the set
+ *
+ * @note Because keys are unique the result is always either 1 or 0
+ */
+size_t count_flat_set(FlatSet *set, const void *key);
+
+/**
+ * @brief Finds a @p key in the set
+ *
+ * @param set The FlatSet object
+ * @param key Key to find
+ * @return Pointer to @p key if found, @c NULL otherwise
+ *
+ * @warning The pointer is invalidated by the next insert or erase
+ * @note The result is of @c void* type and must be cast to the correct type
+ */
+void *find_flat_set(FlatSet *set, const void *key);
+
+/**
+ * @brief Check if there is a @p key in the set
+ *
+ * @param set The FlatSet object
+ * @param key Key to check
+ * @return @c true if found, @c false otherwise
+ */
+bool contains_flat_set(FlatSet *set, const void *key);
+
+/**
+ * @brief Erases the @p key from the set
+ *
+ * @param set The FlatSet object
+ * @param key The key to erase
+ * @return Nothing
+ *
+ * @note If no @p key is found the function does nothing
+ * @note Erasing re-lays the whole array and has linear complexity
+ */
+void erase_flat_set(FlatSet *set, const void *key);
+
+/**
+ * @brief Erases all keys from the set
+ *
+ * @param set The FlatSet object
+ * @return Nothing
+ *
+ * @note The allocated storage is kept for reuse
+ */
+void clear_flat_set(FlatSet *set);
+
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Returns an iterator to the first element of the set
+ *
+ * @param set The FlatSet object
+ * @return Iterator to the first element
+ *
+ * @warning Iterators are invalidated by the next insert or erase
+ */
+Iter begin_flat_set(FlatSet *set);
+
+/**
+ * @brief Returns an iterator to the end of the set
+ *
+ * @param set The FlatSet object
+ * @return Sentinel iterator representing the end of the set
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter end_flat_set(FlatSet *set);
+
+/**
+ * @brief Returns a reverse iterator to the last element of the set
+ *
+ * @param set The FlatSet object
+ * @return Reverse iterator to the last element
+ *
+ * @warning Iterators are invalidated by the next insert or erase
+ */
+Iter rbegin_flat_set(FlatSet *set);
+
+/**
+ * @brief Returns a reverse iterator to the reverse end of the set
+ *
+ * @param set The FlatSet object
+ * @return Sentinel iterator representing the reverse end of the set
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter rend_flat_set(FlatSet *set);
+#endif
+
+/**
+ * @brief Checks if the set has no keys
+ *
+ * @param set The FlatSet object
+ * @return @c true if the set is empty, @c false otherwise
+ */
+bool empty_flat_set(FlatSet *set);
+
+/**
+ * @brief Returns the number of keys in the set
+ *
+ * @param set The FlatSet object
+ * @return Number of keys in the set
+ */
+size_t size_flat_set(FlatSet *set);
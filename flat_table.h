@@ -0,0 +1,248 @@
+/**
+ * @file flat_table.h
+ * @brief Flat table implementation for C
+ *
+ * This header defines a sorted key-value pair @c FlatTable
+ * which stores pairs sorted by keys in a single contiguous array. The sort
+ * comparison function is provided by the user and the table supports
+ * standard operations such as @c insert @c erase @c find and @c clear .
+ *
+ * @author Riain Ó Tuathail
+ * @date 2026-10-19
+ * @version 0.1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+#ifndef CHEAP_KEY_VALUE_PAIR_DEFINED
+typedef struct PairKV
+{
+	const void *key;
+	void       *value;
+} PairKV;
+#define CHEAP_KEY_VALUE_PAIR_DEFINED
+#endif
+
+/**
+ * @brief A sorted associative container that stores key-value pairs with unique
+ * keys contiguously
+ *
+ * Keys are sorted using the @p compare function pointer provided during
+ * initialisation and laid out in Eytzinger (breadth-first) order, so a search
+ * touches one predictable path through the array and the next levels can be
+ * prefetched. Find has logarithmic complexity.
+ *
+ * Inserts are appended to a pending buffer and sort-merged into the array on
+ * the next read, so a batch of @c n inserts costs one O(n log n) merge rather
+ * than @c n individual insertions. Erase is linear.
+ *
+ * @warning The FlatTable object must be constructed and destroyed by the
+ * provided functions
+ * @note The FlatTable object is a pointer to an incomplete type and should not
+ * be dereferenced
+ * @note Prefer a @c Table when inserts and erases are interleaved with lookups
+ */
+typedef struct FlatTable FlatTable;
+
+/**
+ * @brief A comparison function for sorting keys
+ *
+ * @param a The first key
+ * @param b The second key
+ *
+ * @return An integer less than, equal to, or greater than zero depending on the
+ * comparison.
+ */
+typedef int (*KComp)(const void *a, const void *b);
+
+/**
+ * @brief Create a FlatTable object
+ *
+ * @param k_size The size of the key type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing keys
+ * @return FlatTable object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_flat_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ */
+ALLOC FlatTable *create_flat_table(size_t k_size, size_t v_size, KComp compare);
+
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a FlatTable object whose memory comes from @p allocator
+ *
+ * @param k_size The size of the key type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing keys
+ * @param allocator The source of every allocation the table makes
+ * @return FlatTable object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_flat_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ * @note The table keeps a copy of @p allocator, whose context must
+ * outlive the table
+ */
+ALLOC FlatTable *create_flat_table_with_allocator(size_t    k_size,
+                                                  size_t    v_size,
+                                                  KComp     compare,
+                                                  Allocator allocator);
+#endif
+
+/**
+ * @brief Destroy a FlatTable object
+ *
+ * @param table A pointer to a FlatTable object
+ * @return Nothing
+ *
+ * @note The FlatTable object is set to NULL upon successful execution
+ */
+void destroy_flat_table(FlatTable **table);
+
+/**
+ * @brief Insert a @p key @p value pair into the table
+ *
+ * @param table The FlatTable object
+ * @param key The key to insert
+ * @param value The value to insert
+ * @return Nothing
+ *
+ * @warning Ensure @p key and @p value are of the correct specialised types
+ * @note The pair is merged into the table on the next read. If the key already
+ * exists, the most recently inserted value replaces it
+ */
+void insert_flat_table(FlatTable *table, const void *key, const void *value);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Inserts unique copies of @p range key-value pairs into the table
+ *
+ * @param table The FlatTable object
+ * @param range The range to insert
+ * @return Nothing
+ *
+ * @warning The range must iterate over @p PairKV types
+ * @note The pairs are merged into the table on the next read
+ */
+void insert_range_flat_table(FlatTable *table, Range range);
+#endif
+
+/**
+ * @brief Count the number of @p key @c value pairs in the table with an
+ * equivalent @p key
+ *
+ * @param table The FlatTable object
+ * @param key Key from which to count the resulting stored elements
+ * @return The count of @p key @c value pairs in the table
+ *
+ * @note Because keys are unique the result is always either 1 or 0
+ */
+size_t count_flat_table(FlatTable *table, const void *key);
+
+/**
+ * @brief Finds a @c value with key equivalent to @p key
+ *
+ * @param table The FlatTable object
+ * @param key Key from which to derive the @c value
+ * @return Pointer to the @c value if found, @c NULL otherwise
+ *
+ * @warning The pointer is invalidated by the next insert or erase
+ * @note The result is of @c void* type and must be cast to the correct type
+ */
+void *find_flat_table(FlatTable *table, const void *key);
+
+/**
+ * @brief Check if there is a @c value with @p key equivalent in the table
+ *
+ * @param table The FlatTable object
+ * @param key Key from which to find the @c value
+ * @return @c true if found, @c false otherwise
+ */
+bool contains_flat_table(FlatTable *table, const void *key);
+
+/**
+ * @brief Erases the @p key @c value pair from the table
+ *
+ * @param table The FlatTable object
+ * @param key The key to erase the equivalent @p key @c value pair
+ * @return Nothing
+ *
+ * @note If no @p key @c value pair is found the function does nothing
+ * @note Erasing re-lays the whole array and has linear complexity
+ */
+void erase_flat_table(FlatTable *table, const void *key);
+
+/**
+ * @brief Erases all pairs from the table
+ *
+ * @param table The FlatTable object
+ * @return Nothing
+ *
+ * @note The allocated storage is kept for reuse
+ */
+void clear_flat_table(FlatTable *table);
+
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Returns an iterator to the first element of the table
+ *
+ * @param table The FlatTable object
+ * @return Iterator to the first element
+ *
+ * @warning Iterators are invalidated by the next insert or erase
+ */
+Iter begin_flat_table(FlatTable *table);
+
+/**
+ * @brief Returns an iterator to the end of the table
+ *
+ * @param table The FlatTable object
+ * @return Sentinel iterator representing the end of the table
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter end_flat_table(FlatTable *table);
+
+/**
+ * @brief Returns a reverse iterator to the last element of the table
+ *
+ * @param table The FlatTable object
+ * @return Reverse iterator to the last element
+ *
+ * @warning Iterators are invalidated by the next insert or erase
+ */
+Iter rbegin_flat_table(FlatTable *table);
+
+/**
+ * @brief Returns an iterator to the reverse end of the table
+ *
+ * @param table The FlatTable object
+ * @return Sentinel iterator representing the reverse end of the table
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter rend_flat_table(FlatTable *table);
+#endif
+
+/**
+ * @brief Checks if the table has no pairs
+ *
+ * @param table The FlatTable object
+ * @return @c true if the table is empty, @c false otherwise
+ */
+bool empty_flat_table(FlatTable *table);
+
+/**
+ * @brief Returns the number of pairs in the table
+ *
+ * @param table The FlatTable object
+ * @return Number of elements in the table
+ */
+size_t size_flat_table(FlatTable *table);
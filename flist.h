@@ -11,6 +11,16 @@ ALLOC FList *create_forward_list(size_t size);
 ALLOC FList *create_forward_list_capacity(size_t size, size_t init);
 void         destroy_forward_list(FList **flist);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC FList *create_forward_list_with_allocator(size_t    size,
+                                                size_t    init,
+                                                Allocator allocator);
+#endif
+
+#ifdef CHEAP_NODE_POOL_AVAILABLE
+ALLOC FList *create_forward_list_with_pool(size_t size, NodePool *pool);
+#endif
+
 void   push_front_forward_list(FList *flist, const void *value);
 
 void *front_forward_list(const FList *flist);
@@ -18,6 +28,10 @@ void *front_forward_list(const FList *flist);
 void   pop_front_forward_list(FList *flist);
 void   clear_forward_list(FList *flist);
 
+void   reserve_forward_list(FList *flist, size_t amount);
+void   shrink_to_fit_forward_list(FList *flist);
+void   compact_forward_list(FList *flist);
+
 #ifdef CHEAP_ITERATOR_AVAILABLE
 Iter insert_after_forward_list(FList *flist, const void *value, Iter pos);
 Iter erase_after_forward_list(FList *flist, Iter pos);
@@ -18,6 +18,20 @@ ALLOC HashSet *create_hash_set(size_t key_size, KComp kc);
 ALLOC HashSet *create_hash_set_ext(size_t key_size, KComp kc, HashFnc hash);
 void           destroy_hash_set(HashSet **set);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC HashSet *create_hash_set_with_allocator(size_t    key_size,
+                                              KComp     kc,
+                                              HashFnc   hash,
+                                              Allocator allocator);
+#endif
+
+#ifdef CHEAP_NODE_POOL_AVAILABLE
+ALLOC HashSet *create_hash_set_with_pool(size_t    key_size,
+                                         KComp     kc,
+                                         HashFnc   hash,
+                                         NodePool *pool);
+#endif
+
 void insert_hash_set(HashSet *set, const void *key);
 
 size_t      count_hash_set(HashSet *set, const void *key);
@@ -36,6 +36,22 @@ ALLOC HashTable *create_hash_table_ext(size_t  key_size,
                                        HashFnc hash);
 void             destroy_hash_table(HashTable **table);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC HashTable *create_hash_table_with_allocator(size_t    key_size,
+                                                  size_t    value_size,
+                                                  KComp     kc,
+                                                  HashFnc   hash,
+                                                  Allocator allocator);
+#endif
+
+#ifdef CHEAP_NODE_POOL_AVAILABLE
+ALLOC HashTable *create_hash_table_with_pool(size_t    key_size,
+                                             size_t    value_size,
+                                             KComp     kc,
+                                             HashFnc   hash,
+                                             NodePool *pool);
+#endif
+
 void insert_hash_table(HashTable *table, const void *key, const void *value);
 
 size_t count_hash_table(HashTable *table, const void *key);
@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef CHEAP_HEAP_HOOKS_AVAILABLE
+#define CHEAP_HEAP_HOOKS_AVAILABLE
+#endif
+
+#include <stddef.h>
+
+// Where the library spends its heap. Container structs are counted apart from
+// the buffers, nodes and buckets they hold, and allocators count the memory
+// they take from the heap rather than what they hand out.
+typedef enum HeapSubsystem
+{
+	// the container structs themselves
+	HEAP_CONTAINER,
+	// buffers of vectors, arrays, stacks, priority queues and flat containers
+	HEAP_ARRAY,
+	// blocks and control arrays of deques and queues
+	HEAP_DEQUE,
+	// node pages of lists, trees and hash containers, and node pools
+	HEAP_NODES,
+	// tree snapshots
+	HEAP_TREE,
+	// buckets of hash sets and hash tables
+	HEAP_HASH,
+	// leaves of art tables
+	HEAP_ART,
+	HEAP_STRING,
+	// arenas, bump, pool, slab and large page allocators
+	HEAP_ALLOCATOR,
+	// every subsystem together
+	HEAP_TOTAL
+} HeapSubsystem;
+
+// The functions behind every heap allocation the library makes. All but
+// usable_size must be set. usable_size reports the size of a block and is what
+// the byte counters are kept with, so they stay at zero without it.
+typedef struct HeapHooks
+{
+	void *(*malloc)(size_t size);
+	void *(*calloc)(size_t nmemb, size_t size);
+	void *(*realloc)(void *ptr, size_t size);
+	void *(*aligned_alloc)(size_t align, size_t size);
+	void (*free)(void *ptr);
+	size_t (*usable_size)(void *ptr);
+} HeapHooks;
+
+typedef struct HeapStats
+{
+	// bytes held now and the most held at once, as usable_size reports them
+	size_t live;
+	size_t peak;
+	// calls to malloc, calloc and aligned_alloc
+	size_t allocs;
+	size_t reallocs;
+	size_t frees;
+} HeapStats;
+
+// Replaces the standard library, which is used until then. Must be called
+// before the library first touches the heap, as memory cannot be freed by a
+// different allocator than the one it came from.
+void set_heap_hooks(const HeapHooks *hooks);
+
+// Counters are kept from the first allocation and are safe to read while other
+// threads allocate, though the fields are not read together.
+HeapStats heap_stats(HeapSubsystem subsystem);
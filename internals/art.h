@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../range.h"
+#include "nalloc.h"
+#include "pair.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define ART_PREFIX_MAX 10
+
+enum ArtKind
+{
+	ART_NODE4,
+	ART_NODE16,
+	ART_NODE48,
+	ART_NODE256,
+	ART_KINDS
+};
+
+// Every inner node begins with this header. The compressed path below a node
+// may be longer than ART_PREFIX_MAX, in which case only its first bytes are
+// stored and the rest are read from a leaf underneath.
+struct ArtNode
+{
+	uint8_t       kind;
+	uint16_t      nchildren;
+	uint32_t      prefix_len;
+	unsigned char prefix[ART_PREFIX_MAX];
+};
+
+// Leaves are chained in key order, so iteration never walks the inner nodes.
+// The key is stored directly after the leaf and the value after the key at
+// node_field_offset(k_len, v_size). Each leaf is preceded by the PairKV that
+// table iterators hand out, so every pair has storage of its own.
+struct ArtLeaf
+{
+	struct ArtLeaf *prev;
+	struct ArtLeaf *next;
+	size_t          k_len;
+};
+
+// Keys are null-terminated strings when k_size is zero, otherwise unsigned
+// integers of k_size bytes read most significant byte first. Either way no key
+// is a proper prefix of another, so every key ends in its own leaf.
+struct ArtTree
+{
+	struct ArtNode  *root;
+	struct ArtLeaf  *min;
+	struct ArtLeaf  *max;
+	size_t           nmemb;
+	size_t           k_size;
+	size_t           v_size;
+	struct NodeAlloc nodes[ART_KINDS];
+	struct NodeAlloc leaves;
+	Allocator        allocator;
+};
+
+struct ArtTree create_art(size_t k_size, size_t v_size, Allocator allocator);
+
+void destroy_art(struct ArtTree *tree);
+
+void art_insert(struct ArtTree *tree, const void *key, const void *value);
+
+void art_insert_range(struct ArtTree *tree, Range range);
+
+void *art_search(const struct ArtTree *tree, const void *key);
+
+void art_erase(struct ArtTree *tree, const void *key);
+
+void art_clear(struct ArtTree *tree);
+
+Range art_prefix(IteratorType          type,
+                 const struct ArtTree *tree,
+                 const void           *prefix,
+                 size_t                length);
+
+Iter begin_art(IteratorType type, const struct ArtTree *tree);
+
+Iter end_art(IteratorType type, const struct ArtTree *tree);
+
+Iter rbegin_art(IteratorType type, const struct ArtTree *tree);
+
+Iter rend_art(IteratorType type, const struct ArtTree *tree);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../allocator.h"
+#include "heap.h"
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -11,11 +13,43 @@
 
 #define ALLOC __attribute__((warn_unused_result))
 
-ALLOC void *memory_allocate_container(size_t size);
+#define CACHE_LINE_SIZE 64
 
-void memory_free_buffer(void **buffer);
+ALLOC void *memory_allocate_container(HeapSubsystem subsystem, size_t size);
 
-void memory_free_container_generic(void **container, void *array);
+size_t memory_align_padding(const void *ptr, size_t align);
+
+void memory_free_buffer(HeapSubsystem subsystem, void **buffer);
+
+// Allocations on behalf of a container go through its allocator, a NULL
+// allocator or a zeroed one meaning the heap, where they are counted against
+// subsystem. Memory must be freed under the subsystem it was allocated under.
+ALLOC void *memory_alloc(HeapSubsystem    subsystem,
+                         const Allocator *allocator,
+                         size_t           size);
+
+ALLOC void *memory_calloc(HeapSubsystem    subsystem,
+                          const Allocator *allocator,
+                          size_t           size);
+
+ALLOC void *memory_realloc(HeapSubsystem    subsystem,
+                           const Allocator *allocator,
+                           void            *ptr,
+                           size_t           old_size,
+                           size_t           new_size);
+
+void memory_free(HeapSubsystem    subsystem,
+                 const Allocator *allocator,
+                 void            *ptr);
+
+void memory_release_container(HeapSubsystem    subsystem,
+                              void           **container,
+                              const Allocator *allocator);
+
+// releases a container and the buffer it grew through mpool
+void memory_free_container_generic(void            **container,
+                                   void             *array,
+                                   const Allocator *allocator);
 
 bool generic_empty(size_t nmemb);
 
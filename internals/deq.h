@@ -1,5 +1,6 @@
 #pragma once
 
+#include "../allocator.h"
 #include "../range.h"
 #include <stddef.h>
 
@@ -14,11 +15,14 @@ struct ControlArray
 	struct Block *blocks;
 	size_t        block_count;
 	size_t        capacity;
+	Allocator     allocator;
 };
 
 size_t minimum_array_size(size_t size);
 
-struct ControlArray create_control_array(size_t arr_cap, size_t size);
+struct ControlArray create_control_array(size_t    arr_cap,
+                                         size_t    size,
+                                         Allocator allocator);
 
 void destroy_control_array(struct ControlArray *control, size_t front);
 
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "../allocator.h"
+#include "../range.h"
+#include "pair.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef int (*KComp)(const void *a, const void *b);
+
+// Elements are records of key followed by value, stored in Eytzinger (BFS)
+// order: the children of slot k live at 2k and 2k + 1 (one-based). Inserts
+// are appended to a pending buffer and sort-merged into the layout on the
+// next read. The value sits at node_field_offset(k_size, v_size) as it does in
+// node containers, and records are padded so every one stays aligned.
+//
+// Table iterators hand out the PairKV of their slot from pairs, which holds one
+// per slot. A pair only depends on where its slot is, so the pairs are built by
+// the first table iterator and refreshed only when the array moves or grows.
+struct FlatArray
+{
+	void     *array;
+	size_t    capacity;
+	size_t    nmemb;
+	void     *pending;
+	size_t    p_capacity;
+	size_t    p_nmemb;
+	PairKV   *pairs;
+	size_t    pr_capacity;
+	size_t    pr_nmemb;
+	size_t    k_size;
+	size_t    v_size;
+	size_t    v_offset;
+	size_t    size;
+	KComp     k_comp;
+	Allocator allocator;
+};
+
+struct FlatArray create_flat(size_t    k_size,
+                             size_t    v_size,
+                             KComp     compare,
+                             Allocator allocator);
+
+void destroy_flat(struct FlatArray *flat);
+
+void flat_insert(struct FlatArray *flat, const void *key, const void *value);
+
+void flat_insert_range_set(struct FlatArray *flat, Range range);
+
+void flat_insert_range_table(struct FlatArray *flat, Range range);
+
+void flat_flush(struct FlatArray *flat);
+
+void flat_erase(struct FlatArray *flat, const void *key);
+
+void flat_clear(struct FlatArray *flat);
+
+void *flat_search(struct FlatArray *flat, const void *key);
+
+size_t flat_size(struct FlatArray *flat);
+
+Iter begin_flat(IteratorType type, struct FlatArray *flat);
+
+Iter end_flat(IteratorType type, struct FlatArray *flat);
+
+Iter rbegin_flat(IteratorType type, struct FlatArray *flat);
+
+Iter rend_flat(IteratorType type, struct FlatArray *flat);
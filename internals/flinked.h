@@ -42,4 +42,11 @@ void clear_singly_linked(struct NodeAlloc         *alloc,
                          struct SingleLinkedNode **sentinel,
                          size_t                   *nmemb);
 
+// copies the sentinel and then the nodes into fresh pages in list order and
+// frees the old pages, unless the allocator is shared
+void compact_singly_linked(struct NodeAlloc         *alloc,
+                           size_t                    nmemb,
+                           struct SingleLinkedNode **head,
+                           struct SingleLinkedNode **sentinel);
+
 void *access_singly_linked(struct SingleLinkedNode *node);
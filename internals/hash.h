@@ -25,13 +25,14 @@ void hash_insert(struct Bucket   **buckets,
                  const void       *key,
                  const void       *value);
 
-void hash_erase(struct Bucket **buckets,
-                HashFnc         fnc,
-                size_t          k_size,
-                KComp           k_comp,
-                size_t         *nmemb,
-                size_t         *capacity,
-                const void     *key);
+void hash_erase(struct Bucket   **buckets,
+                struct NodeAlloc *alloc,
+                HashFnc           fnc,
+                size_t            k_size,
+                KComp             k_comp,
+                size_t           *nmemb,
+                size_t           *capacity,
+                const void       *key);
 
 void hash_clear(struct Bucket   **buckets,
                 struct NodeAlloc *alloc,
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "../heap_hooks.h"
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+// Every heap operation of the library goes through these, so that it reaches
+// the installed hooks and is counted against subsystem. They return NULL on
+// failure like the functions they stand in for.
+ALLOC void *heap_malloc(HeapSubsystem subsystem, size_t size);
+
+ALLOC void *heap_calloc(HeapSubsystem subsystem, size_t nmemb, size_t size);
+
+ALLOC void *heap_realloc(HeapSubsystem subsystem, void *ptr, size_t size);
+
+ALLOC void *heap_aligned_alloc(HeapSubsystem subsystem,
+                               size_t        align,
+                               size_t        size);
+
+void heap_free(HeapSubsystem subsystem, void *ptr);
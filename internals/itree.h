@@ -0,0 +1,50 @@
+#pragma once
+
+#include "rbtree.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef CHEAP_INTERVAL_DEFINED
+typedef struct Interval
+{
+	const void *lo;
+	const void *hi;
+	void       *value;
+} Interval;
+#define CHEAP_INTERVAL_DEFINED
+#endif
+
+// Intervals are closed and kept in a red-black tree ordered by their low
+// endpoint. Each node stores the low endpoint, the high endpoint and the
+// greatest high endpoint in its subtree, in that order, followed by the value,
+// and is preceded by an Interval pointing at its own fields. The subtree
+// maximum lets a query skip every subtree that ends before it.
+struct IntervalOrder
+{
+	Comp   compare;
+	size_t e_size;
+};
+
+struct TreeNode *insert_itree(struct NodeAlloc *alloc,
+                              struct TreeNode **head,
+                              const void       *lo,
+                              const void       *hi,
+                              const void       *value,
+                              Comp              compare,
+                              size_t            e_size,
+                              size_t            v_size,
+                              size_t           *nmemb);
+
+bool erase_itree(struct NodeAlloc *alloc,
+                 struct TreeNode **head,
+                 const void       *lo,
+                 const void       *hi,
+                 Comp              compare,
+                 size_t            e_size,
+                 size_t            v_size,
+                 size_t           *nmemb);
+
+// Points cursor at the first interval in head overlapping the cursor's
+// bounds, or at NULL if there is none. A cursor with a NULL lo matches every
+// interval.
+void first_itree(struct TreeNode *head, struct IteratorInterval *cursor);
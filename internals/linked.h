@@ -33,10 +33,12 @@ Iter insert_doubly_linked(struct NodeAlloc         *alloc,
                           Iter                      pos);
 
 void pop_front_doubly_linked(struct NodeAlloc         *alloc,
+                             size_t                   *nmemb,
                              struct DoubleLinkedNode **head,
                              struct DoubleLinkedNode **tail);
 
 void pop_back_doubly_linked(struct NodeAlloc         *alloc,
+                            size_t                   *nmemb,
                             struct DoubleLinkedNode **head,
                             struct DoubleLinkedNode **tail);
 
@@ -51,4 +53,11 @@ void clear_doubly_linked(struct NodeAlloc         *alloc,
                          struct DoubleLinkedNode **tail,
                          size_t                   *nmemb);
 
+// copies the nodes into fresh pages in list order and frees the old pages,
+// unless the allocator is shared
+void compact_doubly_linked(struct NodeAlloc         *alloc,
+                           size_t                    nmemb,
+                           struct DoubleLinkedNode **head,
+                           struct DoubleLinkedNode **tail);
+
 void *access_doubly_linked(struct DoubleLinkedNode *node);
@@ -1,30 +1,36 @@
 #pragma once
 
+#include "../allocator.h"
 #include "../range.h"
 #include <stddef.h>
 
 #define ALLOC __attribute__((warn_unused_result))
 
-ALLOC void *generic_mempool_alloc(size_t nmemb, size_t size);
-
-void generic_mempool_push_back(void      **array,
-                               const void *value,
-                               size_t     *capacity,
-                               size_t     *nmemb,
-                               size_t      size);
-
-void generic_mempool_push_front(void      **array,
-                                const void *value,
-                                size_t     *capacity,
-                                size_t     *nmemb,
-                                size_t      size);
-
-void generic_mempool_insert(void      **array,
-                            const void *value,
-                            size_t      index,
-                            size_t     *capacity,
-                            size_t     *nmemb,
-                            size_t      size);
+ALLOC void *generic_mempool_alloc(const Allocator *allocator,
+                                  size_t           nmemb,
+                                  size_t           size);
+
+void generic_mempool_push_back(const Allocator *allocator,
+                               void           **array,
+                               const void      *value,
+                               size_t          *capacity,
+                               size_t          *nmemb,
+                               size_t           size);
+
+void generic_mempool_push_front(const Allocator *allocator,
+                                void           **array,
+                                const void      *value,
+                                size_t          *capacity,
+                                size_t          *nmemb,
+                                size_t           size);
+
+void generic_mempool_insert(const Allocator *allocator,
+                            void           **array,
+                            const void      *value,
+                            size_t           index,
+                            size_t          *capacity,
+                            size_t          *nmemb,
+                            size_t           size);
 
 void generic_mempool_set(void       *array,
                          const void *value,
@@ -32,12 +38,13 @@ void generic_mempool_set(void       *array,
                          size_t      nmemb,
                          size_t      size);
 
-void generic_mempool_range_insert(void  **array,
-                                  size_t  index,
-                                  size_t *capacity,
-                                  size_t *nmemb,
-                                  size_t  size,
-                                  Range   range);
+void generic_mempool_range_insert(const Allocator *allocator,
+                                  void           **array,
+                                  size_t           index,
+                                  size_t          *capacity,
+                                  size_t          *nmemb,
+                                  size_t           size,
+                                  Range            range);
 
 void generic_mempool_pop_back(size_t *nmemb);
 
@@ -59,12 +66,14 @@ void *generic_mempool_random_access(void  *array,
                                     size_t nmemb,
                                     size_t size);
 
-void generic_mempool_reserve(void  **array,
-                             size_t *capacity,
-                             size_t  size,
-                             size_t  new_cap);
-
-void generic_mempool_shrink_to_fit(void  **array,
-                                   size_t *capacity,
-                                   size_t  nmemb,
-                                   size_t  size);
+void generic_mempool_reserve(const Allocator *allocator,
+                             void           **array,
+                             size_t          *capacity,
+                             size_t           size,
+                             size_t           new_cap);
+
+void generic_mempool_shrink_to_fit(const Allocator *allocator,
+                                   void           **array,
+                                   size_t          *capacity,
+                                   size_t           nmemb,
+                                   size_t           size);
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "../allocator.h"
+#include "../node_pool.h"
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 
 #define ALLOC __attribute__((warn_unused_result))
@@ -8,22 +12,100 @@
 
 struct NodeBlock;
 struct NodePage;
+struct NodeEpoch;
 
+// Epochs defer the release of nodes that readers on other threads may still
+// reach. A retired node is queued on the newest open epoch and freed once that
+// epoch and every older one have been closed. Only the owning thread opens
+// epochs, retires nodes and collects; readers only close their epoch.
+// Pages, epochs and the shared allocator itself come from allocator.
+//
+// A page that empties is kept as the spare rather than freed, so a container
+// that moves back and forth across a page boundary does not allocate and free
+// a page on every crossing.
 struct NodeAlloc
 {
 	struct NodeBlock *blocks;
 	struct NodePage  *pages;
+	struct NodePage  *spare;
+	size_t            refs;
+	struct NodeEpoch *epochs;
+	atomic_size_t     closed;
+	Allocator         allocator;
 };
 
-ALLOC struct NodeAlloc create_node_allocator(size_t node_size,
-                                             size_t nmemb,
-                                             size_t t1_size,
-                                             size_t t2_size);
+// The alignment a field of size bytes can need, which is the largest power of
+// two that divides its size, as the size of every type is a multiple of its
+// alignment. Node layouts are derived from their sizes this way, so that keys
+// and values of any type are aligned without being asked for their alignment.
+size_t node_field_align(size_t size);
+
+// offset rounded up to the alignment of a field of size bytes placed there
+size_t node_field_offset(size_t offset, size_t size);
+
+// Slots hold a node_size header, a t1_size field and then a t2_size field at
+// node_field_offset(t1_size, t2_size). The pages place the slots so that the
+// first field after the header is aligned for both.
+ALLOC struct NodeAlloc create_node_allocator(size_t    node_size,
+                                             size_t    nmemb,
+                                             size_t    t1_size,
+                                             size_t    t2_size,
+                                             Allocator allocator);
 
 void destroy_node_allocator(struct NodeAlloc *alloc);
 
+ALLOC struct NodeAlloc *create_shared_node_allocator(size_t    node_size,
+                                                     size_t    nmemb,
+                                                     size_t    t1_size,
+                                                     size_t    t2_size,
+                                                     Allocator allocator);
+
+ALLOC struct NodeAlloc *acquire_node_allocator(struct NodeAlloc *alloc);
+
+void release_node_allocator(struct NodeAlloc **alloc);
+
+bool shared_node_allocator(const struct NodeAlloc *alloc);
+
+// the shared allocator of the pool for nodes of this layout, acquired for the
+// caller and created on first use
+ALLOC struct NodeAlloc *pool_node_allocator(NodePool *pool,
+                                            size_t    node_size,
+                                            size_t    t1_size,
+                                            size_t    t2_size);
+
+void merge_node_allocator(struct NodeAlloc *dest, struct NodeAlloc *src);
+
+// the node_size the allocator was created with
+size_t node_header_size(const struct NodeAlloc *alloc);
+
 ALLOC void *alloc_node(struct NodeAlloc *alloc);
 
 void free_node(struct NodeAlloc *alloc, void *ptr);
 
 void clear_nodes(struct NodeAlloc *alloc);
+
+// room for nmemb more nodes than the free list holds, without allocating
+void reserve_nodes(struct NodeAlloc *alloc, size_t nmemb);
+
+// releases the spare page
+void shrink_nodes(struct NodeAlloc *alloc);
+
+// Compaction moves every page and the free list aside, so that the nodes
+// allocated next are laid out in order from fresh pages sized for nmemb. The
+// container copies its nodes across, fixes its links and then releases the
+// old pages, which stay readable until then. The allocator must not be shared.
+ALLOC struct NodePage *detach_node_pages(struct NodeAlloc *alloc, size_t nmemb);
+
+void release_node_pages(struct NodeAlloc *alloc, struct NodePage *pages);
+
+ALLOC void *clone_node(struct NodeAlloc *alloc, const void *ptr);
+
+ALLOC struct NodeEpoch *open_node_epoch(struct NodeAlloc *alloc);
+
+void close_node_epoch(struct NodeEpoch *epoch);
+
+bool live_node_epochs(const struct NodeAlloc *alloc);
+
+void retire_node(struct NodeAlloc *alloc, void *ptr);
+
+void collect_node_epochs(struct NodeAlloc *alloc);
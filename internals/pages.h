@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Maps *size bytes of anonymous memory with the LargePageFlags in flags and
+// rounds *size up to the length actually mapped. Huge pages come from the
+// reserved hugetlb pool when it has them, and are otherwise requested from
+// transparent huge pages on a huge-page aligned range.
+ALLOC void *map_pages(size_t *size, unsigned flags);
+
+// size is the length map_pages() or remap_pages() reported
+void unmap_pages(void *ptr, size_t size);
+
+// Resizes a mapping, moving it without copying where the system allows, and
+// pre-faults any new tail when the flags ask for it.
+ALLOC void *remap_pages(void    *ptr,
+                        size_t   old_size,
+                        size_t  *new_size,
+                        unsigned flags);
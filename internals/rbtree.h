@@ -3,6 +3,8 @@
 #include "../range.h"
 #include "nalloc.h"
 #include "pair.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 typedef int (*Comp)(const void *a, const void *b);
 
@@ -12,15 +14,45 @@ enum Colour
 	BLACK
 };
 
+// The colour is packed into the low bit of the parent pointer and the frozen
+// mark of snapshotted trees into the next. The key is stored directly after the
+// node and the value directly after the key, so neither needs a pointer of its
+// own.
+//
+// Trees whose iterators hand out a view of their nodes, like the PairKV of a
+// table, keep the view in front of each node instead of assembling one per
+// call, so every view has storage of its own. The node header of the allocator
+// covers the view and the node, and the PairKV, when there is room for one, is
+// filled in as each node is created. A set node thus spends 24 bytes on its
+// header and a table node 40, where both spent 48 when every node held a
+// PairKV and a colour word.
 struct TreeNode
 {
-	PairKV           pair;
-	enum Colour      colour;
-	struct TreeNode *parent;
+	uintptr_t        parent;
 	struct TreeNode *left;
 	struct TreeNode *right;
 };
 
+// A read-only version of a tree. Its nodes are shared with the live tree, which
+// copies a frozen node before changing it and retires the original until the
+// epoch of every snapshot that can reach it is closed.
+struct TreeSnapshot
+{
+	struct TreeNode  *head;
+	Comp              compare;
+	struct NodeEpoch *epoch;
+	Allocator         allocator;
+};
+
+// The first and last nodes of a tree, remembered between hinted inserts so that
+// appends at either end need no search. Any other change to the tree must reset
+// them to NULL, which means unknown.
+struct TreeEdges
+{
+	struct TreeNode *min;
+	struct TreeNode *max;
+};
+
 void insert_rbtree(struct NodeAlloc *alloc,
                    struct TreeNode **head,
                    const void       *key,
@@ -30,6 +62,26 @@ void insert_rbtree(struct NodeAlloc *alloc,
                    size_t            v_size,
                    size_t           *nmemb);
 
+struct TreeNode *insert_hint_rbtree(struct NodeAlloc *alloc,
+                                    struct TreeNode **head,
+                                    struct TreeNode  *hint,
+                                    struct TreeEdges *edges,
+                                    const void       *key,
+                                    const void       *value,
+                                    Comp              compare,
+                                    size_t            k_size,
+                                    size_t            v_size,
+                                    size_t           *nmemb);
+
+struct TreeNode *insert_multi_rbtree(struct NodeAlloc *alloc,
+                                     struct TreeNode **head,
+                                     const void       *key,
+                                     const void       *value,
+                                     Comp              compare,
+                                     size_t            k_size,
+                                     size_t            v_size,
+                                     size_t           *nmemb);
+
 void insert_range_rbtree_set(struct NodeAlloc *alloc,
                              struct TreeNode **head,
                              Range             range,
@@ -49,14 +101,124 @@ void delete_rbtree(struct NodeAlloc *alloc,
                    struct TreeNode **head,
                    const void       *key,
                    Comp              compare,
+                   size_t            k_size,
+                   size_t            v_size,
                    size_t           *nmemb);
 
+void delete_first_rbtree(struct NodeAlloc *alloc,
+                         struct TreeNode **head,
+                         const void       *key,
+                         Comp              compare,
+                         size_t            k_size,
+                         size_t            v_size,
+                         size_t           *nmemb);
+
+// Removes node itself rather than a node found by key. Its key and value may be
+// replaced by those of its predecessor, which is unlinked instead. Returns the
+// lowest node whose subtree changed, so augmented trees know where to repair.
+struct TreeNode *delete_node_rbtree(struct NodeAlloc *alloc,
+                                    struct TreeNode **head,
+                                    struct TreeNode  *node,
+                                    size_t            k_size,
+                                    size_t            v_size,
+                                    size_t           *nmemb);
+
+size_t delete_equal_rbtree(struct NodeAlloc *alloc,
+                           struct TreeNode **head,
+                           const void       *key,
+                           Comp              compare,
+                           size_t           *nmemb);
+
 void clear_rbtree(struct NodeAlloc *alloc,
                   struct TreeNode **head,
                   size_t           *nmemb);
 
+// Copies the nodes into fresh pages in key order and frees the old pages.
+// Does nothing while the allocator is shared or a snapshot is alive.
+void compact_rbtree(struct NodeAlloc *alloc,
+                    struct TreeNode **head,
+                    size_t            nmemb);
+
+// Cuts the tree in O(log n) but sizes the halves by walking the smaller one,
+// so the whole split costs O(log n + min(k, n - k)).
+void split_rbtree(struct TreeNode **head,
+                  struct TreeNode **right,
+                  const void       *key,
+                  Comp              compare,
+                  size_t           *nmemb,
+                  size_t           *r_nmemb);
+
+bool disjoint_rbtree(struct TreeNode *a, struct TreeNode *b, Comp compare);
+
+void join_rbtree(struct NodeAlloc *alloc,
+                 struct TreeNode **head,
+                 struct TreeNode  *other,
+                 Comp              compare,
+                 size_t           *nmemb,
+                 size_t            o_nmemb);
+
+void merge_rbtree(struct NodeAlloc *alloc,
+                  struct TreeNode **head,
+                  struct TreeNode  *other,
+                  Comp              compare,
+                  size_t            k_size,
+                  size_t            v_size,
+                  size_t           *nmemb);
+
+void erase_range_rbtree(struct NodeAlloc *alloc,
+                        struct TreeNode **head,
+                        const void       *lo,
+                        const void       *hi,
+                        Comp              compare,
+                        size_t            k_size,
+                        size_t            v_size,
+                        size_t           *nmemb);
+
+ALLOC struct TreeSnapshot *snapshot_rbtree(struct NodeAlloc *alloc,
+                                           struct TreeNode  *head,
+                                           Comp              compare);
+
+void release_rbtree_snapshot(struct TreeSnapshot **snapshot);
+
 void *rbt_search_k(struct TreeNode *head, const void *key, Comp compare);
-void *rbt_search_v(struct TreeNode *head, const void *key, Comp compare);
+void *rbt_search_v(struct TreeNode *head,
+                   const void      *key,
+                   Comp             compare,
+                   size_t           k_size,
+                   size_t           v_size);
+
+void rbt_search_many_k(struct TreeNode *head,
+                       const void      *keys,
+                       size_t           n,
+                       Comp             compare,
+                       size_t           k_size,
+                       void           **out);
+void rbt_search_many_v(struct TreeNode *head,
+                       const void      *keys,
+                       size_t           n,
+                       Comp             compare,
+                       size_t           k_size,
+                       size_t           v_size,
+                       void           **out);
+
+// like rbt_search_k and rbt_search_v, but find the first of equal keys
+void *rbt_first_k(struct TreeNode *head, const void *key, Comp compare);
+void *rbt_first_v(struct TreeNode *head,
+                  const void      *key,
+                  Comp             compare,
+                  size_t           k_size,
+                  size_t           v_size);
+
+struct TreeNode *rbt_lower_bound(struct TreeNode *head,
+                                 const void      *key,
+                                 Comp             compare);
+struct TreeNode *rbt_upper_bound(struct TreeNode *head,
+                                 const void      *key,
+                                 Comp             compare);
+
+size_t rbt_count(struct TreeNode *head, const void *key, Comp compare);
+
+struct TreeNode *rbt_parent(const struct TreeNode *node);
 
 struct TreeNode *rbt_min(struct TreeNode *head);
 struct TreeNode *rbt_max(struct TreeNode *head);
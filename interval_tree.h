@@ -0,0 +1,222 @@
+/**
+ * @file interval_tree.h
+ * @brief Interval tree implementation for C
+ *
+ * This header defines an @c IntervalTree which stores closed intervals with an
+ * associated value and finds the intervals overlapping a point or a range. The
+ * endpoint comparison function is provided by the user and the tree supports
+ * standard operations such as @c insert @c erase and @c clear .
+ *
+ * @author Riain Ó Tuathail
+ * @date 2026-10-19
+ * @version 0.1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+#ifndef CHEAP_INTERVAL_DEFINED
+typedef struct Interval
+{
+	const void *lo;
+	const void *hi;
+	void       *value;
+} Interval;
+#define CHEAP_INTERVAL_DEFINED
+#endif
+
+/**
+ * @brief An associative container of closed intervals [lo, hi] and their values
+ *
+ * Intervals are sorted by their low endpoint using the @p compare function
+ * pointer provided during initialisation, and equal intervals may be inserted
+ * more than once. Every node also records the greatest high endpoint below it,
+ * so overlap queries skip the subtrees that end too early. Insert and erase
+ * have logarithmic complexity. The tree is implemented as an augmented
+ * red-black tree.
+ *
+ * Iterating the tree or a query range yields @c Interval objects.
+ *
+ * @warning The IntervalTree object must be constructed and destroyed by the
+ * provided functions
+ * @note The IntervalTree object is a pointer to an incomplete type and should
+ * not be dereferenced
+ */
+typedef struct IntervalTree IntervalTree;
+
+/**
+ * @brief A comparison function for ordering endpoints
+ *
+ * @param a The first endpoint
+ * @param b The second endpoint
+ *
+ * @return An integer less than, equal to, or greater than zero depending on the
+ * comparison.
+ */
+typedef int (*KComp)(const void *a, const void *b);
+
+/**
+ * @brief Create an IntervalTree object
+ *
+ * @param e_size The size of the endpoint type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing endpoints
+ * @return IntervalTree object specialised for the given endpoints and values
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass tree to destroy_interval_tree() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p e_size and @p v_size
+ */
+ALLOC IntervalTree *create_interval_tree(size_t e_size,
+                                         size_t v_size,
+                                         KComp  compare);
+
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create an IntervalTree object whose memory comes from @p allocator
+ *
+ * @param e_size The size of the endpoint type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing endpoints
+ * @param allocator The source of every allocation the tree makes
+ * @return IntervalTree object specialised for the given endpoints and values
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass tree to destroy_interval_tree() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p e_size and @p v_size
+ * @note The tree keeps a copy of @p allocator, whose context must
+ * outlive the tree
+ */
+ALLOC IntervalTree *create_interval_tree_with_allocator(size_t    e_size,
+                                                        size_t    v_size,
+                                                        KComp     compare,
+                                                        Allocator allocator);
+#endif
+
+/**
+ * @brief Destroy an IntervalTree object
+ *
+ * @param tree A pointer to an IntervalTree object
+ * @return Nothing
+ *
+ * @note The IntervalTree object is set to NULL upon successful execution
+ */
+void destroy_interval_tree(IntervalTree **tree);
+
+/**
+ * @brief Insert the interval [@p lo, @p hi] with @p value into the tree
+ *
+ * @param tree The IntervalTree object
+ * @param lo The low endpoint
+ * @param hi The high endpoint, not less than @p lo
+ * @param value The value to insert
+ * @return Nothing
+ *
+ * @warning Ensure @p lo, @p hi and @p value are of the correct specialised
+ * types
+ */
+void insert_interval(IntervalTree *tree,
+                     const void   *lo,
+                     const void   *hi,
+                     const void   *value);
+
+/**
+ * @brief Erases one interval equal to [@p lo, @p hi] from the tree
+ *
+ * @param tree The IntervalTree object
+ * @param lo The low endpoint
+ * @param hi The high endpoint
+ * @return @c true if an interval was erased, @c false otherwise
+ *
+ * @note If the interval was inserted more than once the earliest is erased
+ */
+bool erase_interval(IntervalTree *tree, const void *lo, const void *hi);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Returns the range of intervals overlapping [@p lo, @p hi]
+ *
+ * @param tree The IntervalTree object
+ * @param lo The low endpoint of the query
+ * @param hi The high endpoint of the query
+ * @return Forward range over the overlapping intervals ordered by low endpoint
+ *
+ * @warning The range is invalidated by the next insert or erase on @p tree
+ * @warning The range reads @p lo and @p hi as it advances, so both must
+ * outlive it
+ * @note Each range keeps its own place, so any number of queries may be
+ * walked at once
+ * @note The walk enters only subtrees that reach the query and takes each
+ * edge at most once each way, so visiting all k overlaps costs O(log n + k)
+ * when they lie together in low endpoint order. Overlaps spread among many
+ * intervals that end before the query cost up to O(k log(n / k)), since the
+ * walk also passes through their ancestors
+ */
+Range overlaps_interval(const IntervalTree *tree,
+                        const void         *lo,
+                        const void         *hi);
+
+/**
+ * @brief Returns the range of intervals containing @p point
+ *
+ * @param tree The IntervalTree object
+ * @param point The point to query
+ * @return Forward range over the containing intervals ordered by low endpoint
+ *
+ * @warning The range is invalidated by the next insert or erase on @p tree
+ * @warning The range reads @p point as it advances, so @p point must outlive
+ * the range
+ * @note Equivalent to overlaps_interval() with @p point as both endpoints
+ */
+Range stab_interval(const IntervalTree *tree, const void *point);
+#endif
+
+/**
+ * @brief Erases all intervals from the tree
+ *
+ * @param tree The IntervalTree object
+ * @return Nothing
+ */
+void clear_interval_tree(IntervalTree *tree);
+
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Returns an iterator to the interval with the lowest low endpoint
+ *
+ * @param tree The IntervalTree object
+ * @return Iterator to the first interval
+ *
+ * @note Only forward iteration is supported
+ */
+Iter begin_interval_tree(const IntervalTree *tree);
+
+/**
+ * @brief Returns an iterator to the end of the tree
+ *
+ * @param tree The IntervalTree object
+ * @return Sentinel iterator representing the end of the tree
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter end_interval_tree(const IntervalTree *tree);
+#endif
+
+/**
+ * @brief Checks if the tree has no intervals
+ *
+ * @param tree The IntervalTree object
+ * @return @c true if the tree is empty, @c false otherwise
+ */
+bool empty_interval_tree(const IntervalTree *tree);
+
+/**
+ * @brief Returns the number of intervals in the tree
+ *
+ * @param tree The IntervalTree object
+ * @return Number of intervals in the tree
+ */
+size_t size_interval_tree(const IntervalTree *tree);
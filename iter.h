@@ -20,9 +20,16 @@ typedef enum IteratorType
 	// balanced
 	ITERATOR_SET,
 	ITERATOR_TABLE,
+	ITERATOR_TABLE_SNAPSHOT,
+	ITERATOR_INTERVAL,
 	// hashed
 	ITERATOR_HASH_SET,
 	ITERATOR_HASH_TABLE,
+	// flat
+	ITERATOR_FLAT_SET,
+	ITERATOR_FLAT_TABLE,
+	// radix
+	ITERATOR_ART_TABLE,
 	// deque
 	ITERATOR_DEQUE,
 	// reverse iterators
@@ -35,9 +42,15 @@ typedef enum IteratorType
 	// balanced
 	ITERATOR_SET_REVERSE,
 	ITERATOR_TABLE_REVERSE,
+	ITERATOR_TABLE_SNAPSHOT_REVERSE,
 	// hashed
 	ITERATOR_HASH_SET_REVERSE,
 	ITERATOR_HASH_TABLE_REVERSE,
+	// flat
+	ITERATOR_FLAT_SET_REVERSE,
+	ITERATOR_FLAT_TABLE_REVERSE,
+	// radix
+	ITERATOR_ART_TABLE_REVERSE,
 	// deque
 	ITERATOR_DEQUE_REVERSE
 } IteratorType;
@@ -45,8 +58,12 @@ typedef enum IteratorType
 struct DoubleLinkedNode;
 struct SingleLinkedNode;
 struct TreeNode;
+struct TreeSnapshot;
+struct IntervalOrder;
 struct Bucket;
 struct ControlArray;
+struct FlatArray;
+struct ArtLeaf;
 typedef struct DoubleEndedQueue DoubleEndedQueue, Deque;
 
 // array, vector
@@ -70,12 +87,37 @@ struct IteratorBalancedTree
 {
 	struct TreeNode *node;
 };
+// table snapshot
+struct IteratorTreeSnapshot
+{
+	const struct TreeSnapshot *snapshot;
+	struct TreeNode           *node;
+};
+// interval tree
+struct IteratorInterval
+{
+	const struct IntervalOrder *order;
+	const void                 *lo;
+	const void                 *hi;
+	struct TreeNode            *node;
+};
 // hash set, hash table
 struct IteratorHashBuckets
 {
 	struct Bucket *bucket;
 	struct Bucket *end;
 };
+// flat set, flat table
+struct IteratorFlat
+{
+	struct FlatArray *flat;
+	size_t            index;
+};
+// art table
+struct IteratorArt
+{
+	struct ArtLeaf *leaf;
+};
 // deque
 struct IteratorDeque
 {
@@ -89,7 +131,11 @@ union IteratorData
 	struct IteratorLinkedList      linked;
 	struct IteratorForwardList     flinked;
 	struct IteratorBalancedTree    balanced;
+	struct IteratorTreeSnapshot    snapshot;
+	struct IteratorInterval        interval;
 	struct IteratorHashBuckets     hashed;
+	struct IteratorFlat            flat;
+	struct IteratorArt             art;
 	struct IteratorDeque           deque;
 };
 
@@ -0,0 +1,22 @@
+#pragma once
+
+#ifndef CHEAP_LARGE_PAGE_AVAILABLE
+#define CHEAP_LARGE_PAGE_AVAILABLE
+#endif
+
+#include "allocator.h"
+
+typedef enum LargePageFlags
+{
+	// back the memory with 2 MiB pages, from the reserved hugetlb pool when it
+	// has them and from transparent huge pages otherwise
+	LARGE_PAGES_HUGE = 1 << 0,
+	// fault the memory in when it is mapped rather than on first touch
+	LARGE_PAGES_POPULATE = 1 << 1
+} LargePageFlags;
+
+// Backs a container with memory mapped straight from the system. Requests of
+// at least half a huge page get a mapping of their own, which grows and
+// shrinks in place or by remapping rather than by copying. Smaller requests
+// go to malloc. The allocator holds no state and needs no teardown.
+Allocator large_page_allocator(unsigned flags);
@@ -11,6 +11,16 @@ ALLOC List *create_list(size_t size);
 ALLOC List *create_list_capacity(size_t size, size_t init);
 void        destroy_list(List **list);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC List *create_list_with_allocator(size_t    size,
+                                       size_t    init,
+                                       Allocator allocator);
+#endif
+
+#ifdef CHEAP_NODE_POOL_AVAILABLE
+ALLOC List *create_list_with_pool(size_t size, NodePool *pool);
+#endif
+
 void push_back_list(List *list, const void *value);
 void push_front_list(List *list, const void *value);
 
@@ -21,6 +31,10 @@ void pop_front_list(List *list);
 void pop_back_list(List *list);
 void clear_list(List *list);
 
+void reserve_list(List *list, size_t amount);
+void shrink_to_fit_list(List *list);
+void compact_list(List *list);
+
 #ifdef CHEAP_ITERATOR_AVAILABLE
 Iter insert_list(List *list, const void *value, Iter pos);
 Iter erase_list(List *list, Iter index);
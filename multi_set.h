@@ -0,0 +1,246 @@
+/**
+ * @file multi_set.h
+ * @brief Multiset implementation for C
+ *
+ * This header defines a sorted associative @c MultiSet
+ * which stores keys that need not be unique. The sort comparison
+ * function is provided by the user and the multiset supports
+ * standard operations such as @c insert @c erase @c find and @c clear .
+ *
+ * @author Riain Ó Tuathail
+ * @date 2026-10-19
+ * @version 0.1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+/**
+ * @brief A sorted associative container that stores keys which may repeat
+ *
+ * Keys are sorted using the @p compare function pointer provided during
+ * initialisation. Equivalent keys are kept in the order they were inserted.
+ * Find, erase, and insert operations have logarithmic complexity. The
+ * multiset is implemented as a red-black tree.
+ *
+ * @warning The MultiSet object must be constructed and destroyed by the
+ * provided functions
+ * @note The MultiSet object is a pointer to an incomplete type and should not
+ * be dereferenced
+ */
+typedef struct MultiSet MultiSet;
+
+/**
+ * @brief A comparison function for sorting keys
+ *
+ * @param a The first key
+ * @param b The second key
+ *
+ * @return An integer less than, equal to, or greater than zero depending on the
+ * comparison.
+ */
+typedef int (*KComp)(const void *, const void *);
+
+/**
+ * @brief Create a MultiSet object
+ *
+ * @param size The size of the key type
+ * @param compare A function pointer for comparing keys
+ * @return MultiSet object specialised for the given key type
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass set to destroy_multi_set() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ */
+ALLOC MultiSet *create_multi_set(size_t size, KComp compare);
+
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a MultiSet object whose memory comes from @p allocator
+ *
+ * @param size The size of the key type
+ * @param compare A function pointer for comparing keys
+ * @param allocator The source of every allocation the set makes
+ * @return MultiSet object specialised for the given key type
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass set to destroy_multi_set() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The set keeps a copy of @p allocator, whose context must
+ * outlive the set
+ */
+ALLOC MultiSet *create_multi_set_with_allocator(size_t    size,
+                                                KComp     compare,
+                                                Allocator allocator);
+#endif
+
+/**
+ * @brief Destroy a MultiSet object
+ *
+ * @param set A pointer to a MultiSet object
+ * @return Nothing
+ *
+ * @note The MultiSet object is set to NULL upon successful execution
+ */
+void destroy_multi_set(MultiSet **set);
+
+/**
+ * @brief Insert a @p key into the multiset
+ *
+ * @param set The MultiSet object
+ * @param key The key to insert
+ * @return Nothing
+ *
+ * @warning Ensure @p key is of the correct specialised type
+ * @note The key is placed after any equivalent keys already in the multiset
+ */
+void insert_multi_set(MultiSet *set, const void *key);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Inserts copies of @p range elements into the multiset
+ *
+ * @param set The MultiSet object
+ * @param range The range to insert
+ * @return Nothing
+ */
+void insert_range_multi_set(MultiSet *set, Range range);
+#endif
+
+/**
+ * @brief Count the number of keys in the multiset equivalent to @p key
+ *
+ * @param set The MultiSet object
+ * @param key Key to count
+ * @return The count of equivalent keys in the multiset
+ *
+ * @note Has complexity logarithmic in the size of the multiset plus linear in
+ * the count
+ */
+size_t count_multi_set(const MultiSet *set, const void *key);
+
+/**
+ * @brief Finds the first inserted key equivalent to @p key
+ *
+ * @param set The MultiSet object
+ * @param key Key to find
+ * @return Pointer to the key if found, @c NULL otherwise
+ *
+ * @note The result is of @c void* type and must be cast to the correct type
+ */
+void *find_multi_set(const MultiSet *set, const void *key);
+
+/**
+ * @brief Check if there is a key equivalent to @p key in the multiset
+ *
+ * @param set The MultiSet object
+ * @param key Key to check
+ * @return @c true if found, @c false otherwise
+ */
+bool contains_multi_set(const MultiSet *set, const void *key);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Returns the range of keys equivalent to @p key
+ *
+ * @param set The MultiSet object
+ * @param key Key to find
+ * @return Range over the equivalent keys in insertion order, empty if none
+ * are found
+ *
+ * @warning The range is invalidated by the next insert or erase
+ */
+Range equal_range_multi_set(const MultiSet *set, const void *key);
+#endif
+
+/**
+ * @brief Erases the first inserted key equivalent to @p key
+ *
+ * @param set The MultiSet object
+ * @param key Key to erase
+ * @return Nothing
+ *
+ * @note If no equivalent key is found the function does nothing
+ */
+void erase_one_multi_set(MultiSet *set, const void *key);
+
+/**
+ * @brief Erases every key equivalent to @p key
+ *
+ * @param set The MultiSet object
+ * @param key Key to erase
+ * @return The number of keys erased
+ *
+ * @note The keys are cut out of the tree in O(log n) and then freed
+ */
+size_t erase_all_multi_set(MultiSet *set, const void *key);
+
+/**
+ * @brief Erases all keys from the multiset
+ *
+ * @param set The MultiSet object
+ * @return Nothing
+ */
+void clear_multi_set(MultiSet *set);
+
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Returns an iterator to the first element of the multiset
+ *
+ * @param set The MultiSet object
+ * @return Iterator to the first element
+ *
+ * @warning Calling on an empty multiset is undefined behaviour
+ */
+Iter begin_multi_set(const MultiSet *set);
+
+/**
+ * @brief Returns an iterator to the end of the multiset
+ *
+ * @param set The MultiSet object
+ * @return Sentinel iterator representing the end of the multiset
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter end_multi_set(const MultiSet *set);
+
+/**
+ * @brief Returns a reverse iterator to the last element of the multiset
+ *
+ * @param set The MultiSet object
+ * @return Reverse iterator to the last element
+ *
+ * @warning Calling on an empty multiset is undefined behaviour
+ */
+Iter rbegin_multi_set(const MultiSet *set);
+
+/**
+ * @brief Returns a reverse iterator to the reverse end of the multiset
+ *
+ * @param set The MultiSet object
+ * @return Sentinel iterator representing the reverse end of the multiset
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter rend_multi_set(const MultiSet *set);
+#endif
+
+/**
+ * @brief Checks if the multiset has no keys
+ *
+ * @param set The MultiSet object
+ * @return @c true if the multiset is empty, @c false otherwise
+ */
+bool empty_multi_set(const MultiSet *set);
+
+/**
+ * @brief Returns the number of keys in the multiset
+ *
+ * @param set The MultiSet object
+ * @return Number of keys in the multiset, counting each duplicate
+ */
+size_t size_multi_set(const MultiSet *set);
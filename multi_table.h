@@ -0,0 +1,266 @@
+/**
+ * @file multi_table.h
+ * @brief Multitable implementation for C
+ *
+ * This header defines a sorted key-value pair @c MultiTable
+ * which stores pairs sorted by keys that need not be unique. The sort
+ * comparison function is provided by the user and the table supports
+ * standard operations such as @c insert @c erase @c find and @c clear .
+ *
+ * @author Riain Ó Tuathail
+ * @date 2026-10-19
+ * @version 0.1.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+#ifndef CHEAP_KEY_VALUE_PAIR_DEFINED
+typedef struct PairKV
+{
+	const void *key;
+	void       *value;
+} PairKV;
+#define CHEAP_KEY_VALUE_PAIR_DEFINED
+#endif
+
+/**
+ * @brief A sorted associative container that stores key-value pairs whose keys
+ * may repeat
+ *
+ * Keys are sorted using the @p compare function pointer provided during
+ * initialisation. Pairs with equivalent keys are kept in the order they were
+ * inserted. Find, erase, and insert operations have logarithmic complexity.
+ * The table is implemented as a red-black tree.
+ *
+ * @warning The MultiTable object must be constructed and destroyed by the
+ * provided functions
+ * @note The MultiTable object is a pointer to an incomplete type and should
+ * not be dereferenced
+ */
+typedef struct MultiTable MultiTable;
+
+/**
+ * @brief A comparison function for sorting keys
+ *
+ * @param a The first key
+ * @param b The second key
+ *
+ * @return An integer less than, equal to, or greater than zero depending on the
+ * comparison.
+ */
+typedef int (*KComp)(const void *a, const void *b);
+
+/**
+ * @brief Create a MultiTable object
+ *
+ * @param k_size The size of the key type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing keys
+ * @return MultiTable object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_multi_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ */
+ALLOC MultiTable *create_multi_table(size_t k_size,
+                                     size_t v_size,
+                                     KComp  compare);
+
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a MultiTable object whose memory comes from @p allocator
+ *
+ * @param k_size The size of the key type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing keys
+ * @param allocator The source of every allocation the table makes
+ * @return MultiTable object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_multi_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ * @note The table keeps a copy of @p allocator, whose context must
+ * outlive the table
+ */
+ALLOC MultiTable *create_multi_table_with_allocator(size_t    k_size,
+                                                    size_t    v_size,
+                                                    KComp     compare,
+                                                    Allocator allocator);
+#endif
+
+/**
+ * @brief Destroy a MultiTable object
+ *
+ * @param table A pointer to a MultiTable object
+ * @return Nothing
+ *
+ * @note The MultiTable object is set to NULL upon successful execution
+ */
+void destroy_multi_table(MultiTable **table);
+
+/**
+ * @brief Insert a @p key @p value pair into the table
+ *
+ * @param table The MultiTable object
+ * @param key The key to insert
+ * @param value The value to insert
+ * @return Nothing
+ *
+ * @warning Ensure @p key and @p value are of the correct specialised types
+ * @note The pair is placed after any pairs with equivalent keys already in the
+ * table
+ */
+void insert_multi_table(MultiTable *table, const void *key, const void *value);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Inserts copies of @p range key-value pairs into the table
+ *
+ * @param table The MultiTable object
+ * @param range The range to insert
+ * @return Nothing
+ *
+ * @warning The range must iterate over @p PairKV types
+ */
+void insert_range_multi_table(MultiTable *table, Range range);
+#endif
+
+/**
+ * @brief Count the number of pairs in the table with key equivalent to @p key
+ *
+ * @param table The MultiTable object
+ * @param key Key from which to count the resulting stored elements
+ * @return The count of pairs with equivalent keys in the table
+ *
+ * @note Has complexity logarithmic in the size of the table plus linear in the
+ * count
+ */
+size_t count_multi_table(const MultiTable *table, const void *key);
+
+/**
+ * @brief Finds the @c value of the first inserted pair with key equivalent to
+ * @p key
+ *
+ * @param table The MultiTable object
+ * @param key Key from which to derive the @c value
+ * @return Pointer to the @c value if found, @c NULL otherwise
+ *
+ * @note The result is of @c void* type and must be cast to the correct type
+ */
+void *find_multi_table(const MultiTable *table, const void *key);
+
+/**
+ * @brief Check if there is a pair with key equivalent to @p key in the table
+ *
+ * @param table The MultiTable object
+ * @param key Key from which to find the @c value
+ * @return @c true if found, @c false otherwise
+ */
+bool contains_multi_table(const MultiTable *table, const void *key);
+
+#ifdef CHEAP_RANGE_AVAILABLE
+/**
+ * @brief Returns the range of pairs with key equivalent to @p key
+ *
+ * @param table The MultiTable object
+ * @param key Key to find
+ * @return Range over the matching pairs in insertion order, empty if none are
+ * found
+ *
+ * @warning The range is invalidated by the next insert or erase
+ */
+Range equal_range_multi_table(const MultiTable *table, const void *key);
+#endif
+
+/**
+ * @brief Erases the first inserted pair with key equivalent to @p key
+ *
+ * @param table The MultiTable object
+ * @param key The key to erase the equivalent pair
+ * @return Nothing
+ *
+ * @note If no pair is found the function does nothing
+ */
+void erase_one_multi_table(MultiTable *table, const void *key);
+
+/**
+ * @brief Erases every pair with key equivalent to @p key
+ *
+ * @param table The MultiTable object
+ * @param key The key to erase the equivalent pairs
+ * @return The number of pairs erased
+ *
+ * @note The pairs are cut out of the tree in O(log n) and then freed
+ */
+size_t erase_all_multi_table(MultiTable *table, const void *key);
+
+/**
+ * @brief Erases all pairs from the table
+ *
+ * @param table The MultiTable object
+ * @return Nothing
+ */
+void clear_multi_table(MultiTable *table);
+
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Returns an iterator to the first element of the table
+ *
+ * @param table The MultiTable object
+ * @return Iterator to the first element
+ *
+ * @warning Calling on an empty table is undefined behaviour
+ */
+Iter begin_multi_table(const MultiTable *table);
+
+/**
+ * @brief Returns an iterator to the end of the table
+ *
+ * @param table The MultiTable object
+ * @return Sentinel iterator representing the end of the table
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter end_multi_table(const MultiTable *table);
+
+/**
+ * @brief Returns a reverse iterator to the last element of the table
+ *
+ * @param table The MultiTable object
+ * @return Reverse iterator to the last element
+ *
+ * @warning Calling on an empty table is undefined behaviour
+ */
+Iter rbegin_multi_table(const MultiTable *table);
+
+/**
+ * @brief Returns an iterator to the reverse end of the table
+ *
+ * @param table The MultiTable object
+ * @return Sentinel iterator representing the reverse end of the table
+ *
+ * @note End is a sentinel value and should not be dereferenced
+ */
+Iter rend_multi_table(const MultiTable *table);
+#endif
+
+/**
+ * @brief Checks if the table has no pairs
+ *
+ * @param table The MultiTable object
+ * @return @c true if the table is empty, @c false otherwise
+ */
+bool empty_multi_table(const MultiTable *table);
+
+/**
+ * @brief Returns the number of pairs in the table
+ *
+ * @param table The MultiTable object
+ * @return Number of pairs in the table, counting each duplicate key
+ */
+size_t size_multi_table(const MultiTable *table);
@@ -0,0 +1,21 @@
+#pragma once
+
+#ifndef CHEAP_NODE_POOL_AVAILABLE
+#define CHEAP_NODE_POOL_AVAILABLE
+#endif
+
+#include "allocator.h"
+
+#define ALLOC __attribute__((warn_unused_result))
+
+typedef struct NodePool NodePool;
+
+// Node storage shared between many node-based containers. A List, FList, Set,
+// Table, HashSet or HashTable created with a pool takes its nodes from pages
+// shared with every other container of the pool whose nodes have the same
+// layout, so thousands of small containers pack densely instead of each holding
+// a page of its own. Containers keep the pages they use alive, so the pool may
+// be destroyed before them. Not safe to share between threads.
+ALLOC NodePool *create_node_pool(void);
+ALLOC NodePool *create_node_pool_with_allocator(Allocator allocator);
+void            destroy_node_pool(NodePool **pool);
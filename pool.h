@@ -6,11 +6,15 @@
 
 typedef struct PoolAlloc PoolAlloc;
 
+// nmemb sizes the first chunk, later chunks are chained as the pool fills up
 ALLOC PoolAlloc *create_pool_allocator(size_t nmemb, size_t size);
 void             destroy_pool_allocator(PoolAlloc **pool);
 
 ALLOC void *alloc_pool_allocator(PoolAlloc *pool);
 ALLOC void *calloc_pool_allocator(PoolAlloc *pool);
 
+void alloc_many_pool_allocator(PoolAlloc *pool, size_t n, void **out);
+
 void free_pool_allocator(PoolAlloc *pool, void *ptr);
+void free_many_pool_allocator(PoolAlloc *pool, size_t n, void **ptrs);
 void clear_pool_allocator(PoolAlloc *pool);
@@ -12,6 +12,12 @@ typedef int (*CompareFunc)(const void *, const void *);
 ALLOC PQueue *create_pqueue(size_t size, CompareFunc comparator);
 void          destroy_pqueue(PQueue **pqueue);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+ALLOC PQueue *create_pqueue_with_allocator(size_t      size,
+                                           CompareFunc comparator,
+                                           Allocator   allocator);
+#endif
+
 void push_pqueue(PQueue *pqueue, const void *value);
 
 #ifdef CHEAP_RANGE_AVAILABLE
@@ -48,6 +48,23 @@ typedef struct Queue Queue;
  */
 ALLOC Queue *create_queue(size_t size);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a Queue object whose memory comes from @p allocator
+ *
+ * @param size The size of the type the queue is specialised to contain
+ * @param allocator The source of every allocation the queue makes
+ * @return Queue object specialised to hold values of size @p size
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass queue to destroy_queue() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The queue keeps a copy of @p allocator, whose context must
+ * outlive the queue
+ */
+ALLOC Queue *create_queue_with_allocator(size_t size, Allocator allocator);
+#endif
+
 /**
  * @brief Destroy a Queue object
  *
@@ -57,6 +57,45 @@ typedef int (*KComp)(const void *, const void *);
  */
 ALLOC Set *create_set(size_t size, KComp compare);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a Set object whose memory comes from @p allocator
+ *
+ * @param size The size of the key type
+ * @param compare A function pointer for comparing keys
+ * @param allocator The source of every allocation the set makes
+ * @return Set object specialised for the given key type
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass set to destroy_set() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The set keeps a copy of @p allocator, whose context must
+ * outlive the set
+ */
+ALLOC Set *create_set_with_allocator(size_t    size,
+                                     KComp     compare,
+                                     Allocator allocator);
+#endif
+
+#ifdef CHEAP_NODE_POOL_AVAILABLE
+/**
+ * @brief Create a Set object whose nodes come from @p pool
+ *
+ * @param size The size of the key type
+ * @param compare A function pointer for comparing keys
+ * @param pool The node pool shared with other containers
+ * @return Set object specialised for the given key type
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass set to destroy_set() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The set shares node pages with every container of @p pool whose nodes
+ * are the same size, and may outlive the pool
+ * @note compact_set() does nothing for a pooled set
+ */
+ALLOC Set *create_set_with_pool(size_t size, KComp compare, NodePool *pool);
+#endif
+
 /**
  * @brief Destroy a Set object
  *
@@ -78,6 +117,25 @@ void destroy_set(Set **set);
  */
 void insert_set(Set *set, const void *key);
 
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Insert a @p key into the set, searching next to @p hint first
+ *
+ * @param set The Set object
+ * @param hint Iterator to an element next to where @p key belongs, or
+ * end_set() for a key beyond either end of the set
+ * @param key The key to insert
+ * @return Iterator to the element equivalent to @p key
+ *
+ * @warning Ensure @p key is of the correct specialised type
+ * @note If @p key does not belong next to @p hint the set is searched as by
+ * insert_set()
+ * @note Consecutive hinted inserts remember the first and last elements, so
+ * ascending keys passed with end_set() are appended without a search
+ */
+Iter insert_hint_set(Set *set, Iter hint, const void *key);
+#endif
+
 #ifdef CHEAP_RANGE_AVAILABLE
 /**
  * @brief Inserts unique copies of @p range elements into the set
@@ -120,6 +178,20 @@ void *find_set(const Set *set, const void *key);
  */
 bool contains_set(const Set *set, const void *key);
 
+/**
+ * @brief Check for each of @p n keys whether it is in the set
+ *
+ * @param set The Set object
+ * @param keys Array of @p n keys to check
+ * @param n Number of keys in @p keys
+ * @param out Array of @p n results, @c true where the key was found
+ * @return Nothing
+ *
+ * @note Several searches are advanced together so that their cache misses
+ * overlap, which is faster than @p n calls to contains_set() on large sets
+ */
+void contains_many_set(const Set *set, const void *keys, size_t n, bool *out);
+
 /**
  * @brief Erases the @p key from the set
  *
@@ -139,6 +211,65 @@ void erase_set(Set *set, const void *key);
  */
 void clear_set(Set *set);
 
+/**
+ * @brief Moves the nodes of the set into fresh memory in key order
+ *
+ * @param set The Set object
+ * @return Nothing
+ *
+ * @note After many inserts and erases the nodes are scattered across memory,
+ * compacting makes in-order traversal sequential again without a rebuild
+ * @note Does nothing while @p set shares its node allocator with another set
+ * after a split or a join
+ * @warning Invalidates every iterator to @p set
+ */
+void compact_set(Set *set);
+
+/**
+ * @brief Erases every key in the half-open interval [@p lo, @p hi)
+ *
+ * @param set The Set object
+ * @param lo The smallest key to erase
+ * @param hi The first key past the range to keep
+ * @return Nothing
+ *
+ * @note The range is cut out with two splits and one join, so the cost is
+ * O(log n) plus the cost of releasing the erased nodes
+ */
+void erase_range_set(Set *set, const void *lo, const void *hi);
+
+/**
+ * @brief Moves the keys of the set into two new sets, divided at @p key
+ *
+ * @param set The Set object
+ * @param key The key at which to split
+ * @param left Receives a new Set with every key less than @p key
+ * @param right Receives a new Set with every key not less than @p key
+ * @return Nothing
+ *
+ * @warning Must pass @p left and @p right to destroy_set() or memory will be
+ * leaked
+ * @note Costs O(log n + min(k, n - k)), where k keys go to @p left. The tree
+ * is cut in O(log n), but sizing the halves walks the smaller one
+ * @note @p set is left empty. All three sets share one node allocator, which
+ * is released when the last of them is destroyed
+ */
+void split_set(Set *set, const void *key, Set **left, Set **right);
+
+/**
+ * @brief Moves every key of @p other into the set
+ *
+ * @param set The Set object
+ * @param other The Set object to move from
+ * @return Nothing
+ *
+ * @note If every key of one set is less than every key of the other the trees
+ * are joined in O(log n), otherwise the keys of @p other are inserted one by
+ * one
+ * @note @p other is left empty
+ */
+void join_set(Set *set, Set *other);
+
 #ifdef CHEAP_ITERATOR_AVAILABLE
 /**
  * @brief Returns an iterator to the first element of the set
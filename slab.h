@@ -0,0 +1,31 @@
+#pragma once
+
+#include "allocator.h"
+#include <stddef.h>
+
+#define ALLOC __attribute__((warn_unused_result))
+
+typedef struct SlabAlloc SlabAlloc;
+
+// A general-purpose allocator for small objects. Requests are rounded up to
+// one of 32 size classes, from 16 bytes to 8 KiB, and every class carves its
+// blocks from 64 KiB slabs. Each slab starts with a header, so a block is
+// freed without its size. Larger requests get a region of their own. Not safe
+// to share between threads.
+ALLOC SlabAlloc *create_slab_allocator(void);
+void             destroy_slab_allocator(SlabAlloc **slab);
+
+// allocations are aligned for any standard type (max_align_t)
+ALLOC void *alloc_slab_allocator(SlabAlloc *slab, size_t size);
+ALLOC void *calloc_slab_allocator(SlabAlloc *slab, size_t size);
+
+// stays in place while size still rounds to the same class
+ALLOC void *realloc_slab_allocator(SlabAlloc *slab, void *ptr, size_t size);
+
+void free_slab_allocator(SlabAlloc *slab, void *ptr);
+
+// the usable size of ptr, at least what was asked for
+size_t size_slab_allocator(const void *ptr);
+
+// Backs a container with the slab allocator, which must outlive it.
+Allocator slab_allocator(SlabAlloc *slab);
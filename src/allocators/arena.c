@@ -1,7 +1,14 @@
+#define _DEFAULT_SOURCE
 #include "../../arena.h"
 #include "../../internals/base.h"
 #include "../../internals/cassert.h"
+#include "../../internals/pages.h"
 #include <memory.h>
+#include <sys/mman.h>
+#include <threads.h>
+
+#define COMMIT_SIZE       (64 * 1024)
+#define THREAD_ARENA_SIZE (64 * 1024)
 
 struct Page
 {
@@ -11,107 +18,557 @@ struct Page
 	size_t       offset;
 };
 
+// Allocations too large for the current page get a page of their own on the
+// large list, so the current page keeps serving small requests. Pages released
+// by a clear or a reset are kept on the spare list, up to the retention
+// budget, and reused before any new page is allocated.
+//
+// A virtual arena instead reserves one address range up front and describes it
+// with the embedded page. Memory is committed in COMMIT_SIZE steps as the
+// offset grows, so the arena never chains pages or calls malloc, and a clear
+// hands the committed tail beyond the budget back to the system.
+//
+// A mapped arena maps its pages with the LargePageFlags in pages rather than
+// taking them from malloc, and every page is sized to the whole mapping.
 typedef struct Arena
 {
 	struct Page *curr;
+	struct Page *large;
+	struct Page *spare;
+	size_t       retained;
+	size_t       budget;
+	size_t       committed;
+	unsigned     pages;
+	bool         mapped;
+	bool         reserved;
+	struct Page  range;
 } Arena;
 
-ALLOC static struct Page *construct_page(struct Page *prev,
+ALLOC static struct Page *construct_page(const Arena *arena,
+                                         struct Page *prev,
                                          const size_t growth_policy,
                                          const size_t size)
 {
-	const size_t n_size = growth_policy * size;
+	size_t n_size = sizeof(struct Page) + growth_policy * size;
+	void  *memory = NULL;
 
-	void *memory = malloc(sizeof(struct Page) + n_size);
+	if (arena->mapped)
+	{
+		memory = map_pages(&n_size, arena->pages);
+	}
+	else
+	{
+		memory = heap_malloc(HEAP_ALLOCATOR, n_size);
 
-	CHEAP_ASSERT(memory, "Arena unable to acquire memory.");
+		CHEAP_ASSERT(memory, "Arena unable to acquire memory.");
+	}
 
 	struct Page *page = memory;
 
 	page->prev   = prev;
 	page->base   = memory + sizeof(struct Page);
-	page->size   = n_size;
+	page->size   = n_size - sizeof(struct Page);
 	page->offset = 0;
 
 	return page;
 }
 
-ALLOC static struct Page *arena_destroy_page(struct Page *page)
+static void free_page(const Arena *arena, struct Page *page)
+{
+	if (arena->mapped)
+	{
+		unmap_pages(page, sizeof(struct Page) + page->size);
+	}
+	else
+	{
+		heap_free(HEAP_ALLOCATOR, page);
+	}
+}
+
+ALLOC static struct Page *arena_destroy_page(const Arena *arena,
+                                             struct Page *page)
+{
+	struct Page *prev = page->prev;
+
+	free_page(arena, page);
+
+	return prev;
+}
+
+static void arena_destroy_pages(const Arena *arena, struct Page **page)
+{
+	while (*page)
+	{
+		*page = arena_destroy_page(arena, *page);
+	}
+}
+
+ALLOC static struct Page *arena_release_page(Arena *arena, struct Page *page)
 {
 	struct Page *prev = page->prev;
 
-	free(page);
+	if (arena->retained + page->size <= arena->budget)
+	{
+		page->prev   = arena->spare;
+		arena->spare = page;
+
+		arena->retained += page->size;
+	}
+	else
+	{
+		free_page(arena, page);
+	}
 
 	return prev;
 }
 
-static void arena_destroy_pages(struct Page **page)
+// reuses the first spare page that fits before allocating a new one
+ALLOC static struct Page *arena_acquire_page(Arena       *arena,
+                                             struct Page *prev,
+                                             const size_t required,
+                                             const size_t preferred)
+{
+	for (struct Page **link = &arena->spare; *link; link = &(*link)->prev)
+	{
+		struct Page *page = *link;
+
+		if (page->size >= required)
+		{
+			*link = page->prev;
+
+			arena->retained -= page->size;
+
+			page->prev   = prev;
+			page->offset = 0;
+
+			return page;
+		}
+	}
+
+	return construct_page(arena, prev, 1, preferred);
+}
+
+static size_t round_commit(const size_t size)
+{
+	return (size + COMMIT_SIZE - 1) & ~(size_t)(COMMIT_SIZE - 1);
+}
+
+// false when the system refuses to back the reserved range
+ALLOC static bool arena_commit(Arena *arena)
+{
+	struct Page *page = arena->curr;
+
+	if (!arena->reserved || page->offset <= arena->committed)
+	{
+		return true;
+	}
+
+	const size_t commit = (round_commit(page->offset) < page->size)
+	                          ? round_commit(page->offset)
+	                          : page->size;
+
+	if (mprotect(page->base + arena->committed,
+	             commit - arena->committed,
+	             PROT_READ | PROT_WRITE) != 0)
+	{
+		return false;
+	}
+
+	arena->committed = commit;
+
+	return true;
+}
+
+static void arena_decommit(Arena *arena)
 {
-	do
+	// the pages stay accessible and read back as zero when touched again
+	const size_t keep = round_commit(arena->budget ? arena->budget : 1);
+
+	if (arena->committed > keep)
 	{
-		*page = arena_destroy_page(*page);
+		madvise(arena->curr->base + keep,
+		        arena->committed - keep,
+		        MADV_DONTNEED);
 	}
-	while (*page);
 }
 
-ALLOC static void *arena_alloc(struct Page **curr, const size_t size)
+ALLOC static void *arena_alloc(Arena       *arena,
+                               const size_t size,
+                               const size_t align)
 {
-	if ((*curr)->size - (*curr)->offset < size)
+	struct Page *page    = arena->curr;
+	size_t       padding = memory_align_padding(page->base + page->offset,
+	                                            align);
+
+	// checked apart so that a huge size cannot wrap the sum
+	if (padding > page->size - page->offset ||
+	    size > page->size - page->offset - padding)
 	{
-		*curr = construct_page(*curr, 2, (*curr)->size);
+		// the reservation is the only page a virtual arena ever has
+		if (arena->reserved)
+		{
+			return NULL;
+		}
+
+		// the new page must fit the request even at its worst alignment
+		const size_t required = size + align - 1;
+
+		if (required > page->size)
+		{
+			page = arena_acquire_page(arena, arena->large, required, required);
+
+			arena->large = page;
+		}
+		else
+		{
+			page = arena_acquire_page(arena,
+			                          arena->curr,
+			                          required,
+			                          2 * arena->curr->size);
+
+			arena->curr = page;
+		}
+
+		padding = memory_align_padding(page->base, align);
 	}
 
-	void *ptr = ((*curr)->base + (*curr)->offset);
+	void        *ptr    = (page->base + page->offset + padding);
+	const size_t offset = page->offset;
+
+	page->offset += padding + size;
+
+	if (!arena_commit(arena))
+	{
+		page->offset = offset;
 
-	(*curr)->offset += size;
+		return NULL;
+	}
 
 	return ptr;
 }
 
-ALLOC static void *arena_c_alloc(struct Page **curr, const size_t size)
+ALLOC static void *arena_c_alloc(Arena       *arena,
+                                 const size_t size,
+                                 const size_t align)
+{
+	void *ptr = arena_alloc(arena, size, align);
+
+	return (ptr) ? memset(ptr, 0, size) : NULL;
+}
+
+ALLOC static void *arena_realloc(Arena       *arena,
+                                 void        *ptr,
+                                 const size_t old_size,
+                                 const size_t new_size)
+{
+	struct Page *page = arena->curr;
+
+	// only the latest allocation on the current page can move its end
+	if (ptr && ptr + old_size == page->base + page->offset &&
+	    new_size <= page->size - (size_t)(ptr - page->base))
+	{
+		const size_t offset = page->offset;
+
+		page->offset = (size_t)(ptr - page->base) + new_size;
+
+		if (!arena_commit(arena))
+		{
+			page->offset = offset;
+
+			return NULL;
+		}
+
+		return ptr;
+	}
+
+	void *dest = arena_alloc(arena, new_size, _Alignof(max_align_t));
+
+	if (ptr && dest)
+	{
+		memcpy(dest, ptr, (old_size < new_size) ? old_size : new_size);
+	}
+
+	return dest;
+}
+
+static struct Page *largest_page(struct Page *page, struct Page *largest)
 {
-	void *ptr = arena_alloc(curr, size);
+	for (; page; page = page->prev)
+	{
+		if (page->size > largest->size)
+		{
+			largest = page;
+		}
+	}
+
+	return largest;
+}
+
+static void arena_clear(Arena *arena)
+{
+	// the largest page stays current so the next cycle fits in it sooner
+	struct Page *keep = largest_page(arena->large,
+	                                 largest_page(arena->curr, arena->curr));
+
+	for (struct Page *page = arena->curr; page;)
+	{
+		page = (page == keep) ? page->prev : arena_release_page(arena, page);
+	}
+
+	for (struct Page *page = arena->large; page;)
+	{
+		page = (page == keep) ? page->prev : arena_release_page(arena, page);
+	}
 
-	return memset(ptr, 0, size);
+	keep->prev   = NULL;
+	keep->offset = 0;
+
+	arena->curr  = keep;
+	arena->large = NULL;
+
+	if (arena->reserved)
+	{
+		arena_decommit(arena);
+	}
 }
 
-static void arena_clear(struct Page **curr)
+static void arena_reset(Arena *arena, const ArenaMark mark)
 {
-	while ((*curr)->prev)
+	// pages newer than the mark are released, newest first
+	while (arena->curr != mark.page)
+	{
+		CHEAP_ASSERT(arena->curr->prev,
+		             "Arena mark does not belong to this arena.");
+
+		arena->curr = arena_release_page(arena, arena->curr);
+	}
+
+	while (arena->large != mark.large)
 	{
-		(*curr) = arena_destroy_page(*curr);
+		CHEAP_ASSERT(arena->large,
+		             "Arena mark does not belong to this arena.");
+
+		arena->large = arena_release_page(arena, arena->large);
 	}
 
-	(*curr)->offset = 0;
+	CHEAP_ASSERT(mark.offset <= arena->curr->offset,
+	             "Arena mark has already been reset past.");
+
+	arena->curr->offset = mark.offset;
 }
 
 Arena *create_arena(const size_t size)
 {
-	Arena *arena = memory_allocate_container(sizeof(Arena));
+	Arena *arena = memory_allocate_container(HEAP_ALLOCATOR, sizeof(Arena));
+
+	arena->curr = construct_page(arena, NULL, 1, size);
+
+	return arena;
+}
+
+Arena *create_large_page_arena(const size_t size, const unsigned flags)
+{
+	Arena *arena = memory_allocate_container(HEAP_ALLOCATOR, sizeof(Arena));
+
+	arena->pages  = flags;
+	arena->mapped = true;
+	arena->curr   = construct_page(arena, NULL, 1, size);
+
+	return arena;
+}
+
+Arena *create_virtual_arena(const size_t reserve)
+{
+	Arena *arena = memory_allocate_container(HEAP_ALLOCATOR, sizeof(Arena));
+
+	const size_t size = round_commit(reserve);
+
+	void *base = mmap(NULL,
+	                  size,
+	                  PROT_NONE,
+	                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+	                  -1,
+	                  0);
 
-	arena->curr = construct_page(NULL, 1, size);
+	CHEAP_ASSERT(base != MAP_FAILED, "Arena unable to reserve memory.");
+
+	arena->range = (struct Page){ .prev   = NULL,
+		                          .base   = base,
+		                          .size   = size,
+		                          .offset = 0 };
+
+	arena->curr     = &arena->range;
+	arena->reserved = true;
 
 	return arena;
 }
 
 void destroy_arena(Arena **arena)
 {
-	arena_destroy_pages(&(*arena)->curr);
+	if ((*arena)->reserved)
+	{
+		munmap((*arena)->range.base, (*arena)->range.size);
+
+		(*arena)->curr = NULL;
+	}
+
+	arena_destroy_pages(*arena, &(*arena)->curr);
+	arena_destroy_pages(*arena, &(*arena)->large);
+	arena_destroy_pages(*arena, &(*arena)->spare);
 
-	memory_free_buffer((void **)arena);
+	memory_free_buffer(HEAP_ALLOCATOR, (void **)arena);
 }
 
 void *alloc_arena(Arena *arena, const size_t size)
 {
-	return arena_alloc(&arena->curr, size);
+	return arena_alloc(arena, size, _Alignof(max_align_t));
 }
 
 void *calloc_arena(Arena *arena, const size_t size)
 {
-	return arena_c_alloc(&arena->curr, size);
+	return arena_c_alloc(arena, size, _Alignof(max_align_t));
+}
+
+void *realloc_arena(Arena       *arena,
+                    void        *ptr,
+                    const size_t old_size,
+                    const size_t new_size)
+{
+	return arena_realloc(arena, ptr, old_size, new_size);
+}
+
+void *alloc_arena_aligned(Arena *arena, const size_t size, const size_t align)
+{
+	return arena_alloc(arena, size, align);
+}
+
+void *calloc_arena_aligned(Arena *arena, const size_t size, const size_t align)
+{
+	return arena_c_alloc(arena, size, align);
+}
+
+void *alloc_arena_cache_line(Arena *arena, const size_t size)
+{
+	return arena_alloc(arena, size, CACHE_LINE_SIZE);
 }
 
 void clear_arena(Arena *arena)
 {
-	arena_clear(&arena->curr);
+	arena_clear(arena);
+}
+
+void retain_arena(Arena *arena, const size_t budget)
+{
+	arena->budget = budget;
+
+	// drop spare pages that no longer fit in the budget
+	struct Page *spare = arena->spare;
+
+	arena->spare    = NULL;
+	arena->retained = 0;
+
+	while (spare)
+	{
+		spare = arena_release_page(arena, spare);
+	}
+}
+
+static void *allocator_alloc(void *arena, const size_t size)
+{
+	return arena_alloc(arena, size, _Alignof(max_align_t));
+}
+
+static void *allocator_realloc(void        *arena,
+                               void        *ptr,
+                               const size_t old_size,
+                               const size_t new_size)
+{
+	return arena_realloc(arena, ptr, old_size, new_size);
+}
+
+// memory handed to an arena is only given back by a clear or a reset
+static void allocator_free(void *arena, void *ptr)
+{
+	(void)arena;
+	(void)ptr;
+}
+
+Allocator arena_allocator(Arena *arena)
+{
+	return (Allocator){ .alloc   = allocator_alloc,
+		                .realloc = allocator_realloc,
+		                .free    = allocator_free,
+		                .ctx     = arena };
+}
+
+// The thread-specific key only exists to destroy each arena when its thread
+// exits; lookups go through the thread-local pointer.
+static tss_t               thread_arenas;
+static bool                thread_arenas_created;
+static once_flag           thread_arenas_once = ONCE_FLAG_INIT;
+static _Thread_local Arena *thread_local_arena;
+
+static void destroy_thread_arena(void *arena)
+{
+	destroy_arena((Arena **)&arena);
+}
+
+static void create_thread_arenas(void)
+{
+	thread_arenas_created = tss_create(&thread_arenas, destroy_thread_arena) ==
+	                        thrd_success;
+}
+
+Arena *thread_arena(void)
+{
+	if (!thread_local_arena)
+	{
+		call_once(&thread_arenas_once, create_thread_arenas);
+
+		// without the key an arena could not be destroyed with its thread
+		if (!thread_arenas_created)
+		{
+			return NULL;
+		}
+
+		thread_local_arena = create_arena(THREAD_ARENA_SIZE);
+
+		tss_set(thread_arenas, thread_local_arena);
+	}
+
+	return thread_local_arena;
+}
+
+void release_thread_arena(void)
+{
+	if (thread_local_arena)
+	{
+		tss_set(thread_arenas, NULL);
+
+		destroy_arena(&thread_local_arena);
+	}
+}
+
+ArenaMark mark_arena(const Arena *arena)
+{
+	ArenaMark mark = { .page   = arena->curr,
+		               .large  = arena->large,
+		               .offset = arena->curr->offset };
+	return mark;
+}
+
+void reset_arena(Arena *arena, const ArenaMark mark)
+{
+	arena_reset(arena, mark);
+}
+
+ArenaScratch begin_scratch_arena(Arena *arena)
+{
+	ArenaScratch scratch = { .arena = arena, .mark = mark_arena(arena) };
+	return scratch;
+}
+
+void end_scratch_arena(const ArenaScratch scratch)
+{
+	arena_reset(scratch.arena, scratch.mark);
 }
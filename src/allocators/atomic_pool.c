@@ -0,0 +1,461 @@
+#include "../../atomic_pool.h"
+#include "../../internals/base.h"
+#include "../../internals/cassert.h"
+#include <assert.h>
+#include <memory.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define MAGAZINE_CAPACITY 32
+#define MAX_CHUNK_SHIFT   16
+
+// Stack heads pack a 48-bit block address with a 16-bit tag that changes on
+// every push and pop. A thread that read the head before a block was popped
+// and pushed back in between then fails its exchange rather than installing a
+// stale successor (the ABA problem).
+#define TAG_SHIFT 48
+#define PTR_MASK  ((UINT64_C(1) << TAG_SHIFT) - 1)
+
+static_assert(sizeof(uintptr_t) == sizeof(uint64_t),
+              "Tagged stack heads need 64-bit pointers.");
+
+struct FreeBlock
+{
+	_Atomic(struct FreeBlock *) prev;
+	_Atomic(struct FreeBlock *) batch;
+};
+
+struct Chunk
+{
+	struct Chunk *prev;
+	size_t        nmemb;
+};
+
+// Full batches of MAGAZINE_CAPACITY blocks are chained through their first
+// block on a stack of their own, so a magazine refills or flushes with a
+// single exchange.
+struct AtomicPoolAlloc
+{
+	_Atomic(uint64_t)       blocks;
+	_Atomic(uint64_t)       batches;
+	_Atomic(struct Chunk *) chunks;
+	atomic_size_t           grown;
+	size_t                  nmemb;
+	size_t                  size;
+};
+
+struct Batch
+{
+	struct FreeBlock *head;
+	size_t            count;
+};
+
+// the spare batch is always either empty or full
+struct PoolMagazine
+{
+	AtomicPoolAlloc *pool;
+	struct Batch     loaded;
+	struct Batch     spare;
+};
+
+static size_t slot_size(const size_t size)
+{
+	const size_t align = _Alignof(struct FreeBlock);
+	const size_t n     = (size > sizeof(struct FreeBlock))
+	                         ? size
+	                         : sizeof(struct FreeBlock);
+
+	return (n + align - 1) & ~(align - 1);
+}
+
+static struct FreeBlock *untag(const uint64_t head)
+{
+	return (struct FreeBlock *)(uintptr_t)(head & PTR_MASK);
+}
+
+static uint64_t retag(const struct FreeBlock *block, const uint64_t head)
+{
+	return (uintptr_t)block | (((head >> TAG_SHIFT) + 1) << TAG_SHIFT);
+}
+
+static _Atomic(struct FreeBlock *) *block_link(struct FreeBlock *block,
+                                               const bool        batch)
+{
+	return (batch) ? &block->batch : &block->prev;
+}
+
+static struct FreeBlock *next_block(struct FreeBlock *block)
+{
+	return atomic_load_explicit(&block->prev, memory_order_relaxed);
+}
+
+static void push_chain(_Atomic(uint64_t) *stack,
+                       struct FreeBlock  *first,
+                       struct FreeBlock  *last,
+                       const bool         batch)
+{
+	CHEAP_ASSERT(!((uintptr_t)first >> TAG_SHIFT),
+	             "Atomic pool block address does not fit in 48 bits.");
+
+	uint64_t head = atomic_load_explicit(stack, memory_order_relaxed);
+
+	do
+	{
+		atomic_store_explicit(block_link(last, batch),
+		                      untag(head),
+		                      memory_order_relaxed);
+	}
+	while (!atomic_compare_exchange_weak_explicit(stack,
+	                                              &head,
+	                                              retag(first, head),
+	                                              memory_order_release,
+	                                              memory_order_relaxed));
+}
+
+// Chunks are never released while the pool lives, so reading the link of a
+// block another thread has just taken is safe; the tag rejects the result.
+static struct FreeBlock *pop(_Atomic(uint64_t) *stack, const bool batch)
+{
+	uint64_t          head = atomic_load_explicit(stack, memory_order_acquire);
+	struct FreeBlock *top  = NULL;
+	struct FreeBlock *next = NULL;
+
+	do
+	{
+		top = untag(head);
+
+		if (!top)
+		{
+			return NULL;
+		}
+
+		next = atomic_load_explicit(block_link(top, batch),
+		                            memory_order_relaxed);
+	}
+	while (!atomic_compare_exchange_weak_explicit(stack,
+	                                              &head,
+	                                              retag(next, head),
+	                                              memory_order_acquire,
+	                                              memory_order_acquire));
+
+	return top;
+}
+
+static struct FreeBlock *link_blocks(void        *base,
+                                     const size_t nmemb,
+                                     const size_t size)
+{
+	struct FreeBlock *block = base;
+
+	for (size_t i = 1; i < nmemb; i++)
+	{
+		struct FreeBlock *next = base + i * size;
+
+		atomic_store_explicit(&block->prev, next, memory_order_relaxed);
+
+		block = next;
+	}
+
+	atomic_store_explicit(&block->prev, NULL, memory_order_relaxed);
+
+	return block;
+}
+
+static struct FreeBlock *last_block(struct FreeBlock *block)
+{
+	while (next_block(block))
+	{
+		block = next_block(block);
+	}
+
+	return block;
+}
+
+// Several threads may find the pool empty at once and each add a chunk, which
+// only makes the pool grow a little sooner than it would have.
+static void pool_grow(AtomicPoolAlloc *pool)
+{
+	const size_t grown = atomic_fetch_add_explicit(&pool->grown,
+	                                               1,
+	                                               memory_order_relaxed);
+	const size_t shift = (grown < MAX_CHUNK_SHIFT) ? grown : MAX_CHUNK_SHIFT;
+	const size_t nmemb = pool->nmemb << shift;
+	const size_t size  = pool->size;
+
+	struct Chunk *chunk = heap_malloc(HEAP_ALLOCATOR,
+	                                  sizeof(struct Chunk) + nmemb * size);
+
+	CHEAP_ASSERT(chunk, "Atomic pool allocator unable to acquire memory.");
+
+	chunk->nmemb = nmemb;
+	chunk->prev  = atomic_load_explicit(&pool->chunks, memory_order_relaxed);
+
+	while (!atomic_compare_exchange_weak_explicit(&pool->chunks,
+	                                              &chunk->prev,
+	                                              chunk,
+	                                              memory_order_relaxed,
+	                                              memory_order_relaxed))
+	{
+	}
+
+	// carve the chunk into full batches and publish them with one push, then
+	// hand any remainder to the block stack
+	void        *base    = chunk + 1;
+	const size_t batches = nmemb / MAGAZINE_CAPACITY;
+	const size_t stride  = MAGAZINE_CAPACITY * size;
+
+	for (size_t i = 0; i < batches; i++)
+	{
+		struct FreeBlock *first = base + i * stride;
+		struct FreeBlock *next  = (i + 1 < batches) ? base + (i + 1) * stride
+		                                            : NULL;
+
+		link_blocks(first, MAGAZINE_CAPACITY, size);
+		atomic_store_explicit(&first->batch, next, memory_order_relaxed);
+	}
+
+	if (batches)
+	{
+		push_chain(&pool->batches,
+		           base,
+		           base + (batches - 1) * stride,
+		           true);
+	}
+
+	if (nmemb % MAGAZINE_CAPACITY)
+	{
+		void             *rest = base + batches * stride;
+		struct FreeBlock *last = link_blocks(rest,
+		                                     nmemb % MAGAZINE_CAPACITY,
+		                                     size);
+
+		push_chain(&pool->blocks, rest, last, false);
+	}
+}
+
+ALLOC static void *pool_alloc(AtomicPoolAlloc *pool)
+{
+	for (;;)
+	{
+		struct FreeBlock *block = pop(&pool->blocks, false);
+
+		if (block)
+		{
+			return block;
+		}
+
+		block = pop(&pool->batches, true);
+
+		if (block)
+		{
+			// keep the first block and pass the rest to the block stack
+			struct FreeBlock *next = next_block(block);
+
+			if (next)
+			{
+				push_chain(&pool->blocks, next, last_block(next), false);
+			}
+
+			return block;
+		}
+
+		pool_grow(pool);
+	}
+}
+
+static void pool_free(AtomicPoolAlloc *pool, void *ptr)
+{
+	push_chain(&pool->blocks, ptr, ptr, false);
+}
+
+static void batch_push(struct Batch *batch, struct FreeBlock *block)
+{
+	atomic_store_explicit(&block->prev, batch->head, memory_order_relaxed);
+
+	batch->head = block;
+	batch->count++;
+}
+
+static struct FreeBlock *batch_pop(struct Batch *batch)
+{
+	struct FreeBlock *block = batch->head;
+
+	batch->head = next_block(block);
+	batch->count--;
+
+	return block;
+}
+
+static void magazine_refill(PoolMagazine *magazine)
+{
+	AtomicPoolAlloc *pool = magazine->pool;
+
+	for (;;)
+	{
+		struct FreeBlock *head = pop(&pool->batches, true);
+
+		if (head)
+		{
+			magazine->loaded = (struct Batch){ .head  = head,
+			                                   .count = MAGAZINE_CAPACITY };
+			return;
+		}
+
+		// without a full batch, gather what single blocks there are
+		while (magazine->loaded.count < MAGAZINE_CAPACITY)
+		{
+			struct FreeBlock *block = pop(&pool->blocks, false);
+
+			if (!block)
+			{
+				break;
+			}
+
+			batch_push(&magazine->loaded, block);
+		}
+
+		if (magazine->loaded.count)
+		{
+			return;
+		}
+
+		pool_grow(pool);
+	}
+}
+
+static void magazine_flush(PoolMagazine *magazine, struct Batch *batch)
+{
+	AtomicPoolAlloc *pool = magazine->pool;
+
+	if (batch->count == MAGAZINE_CAPACITY)
+	{
+		push_chain(&pool->batches, batch->head, batch->head, true);
+	}
+	else if (batch->count)
+	{
+		push_chain(&pool->blocks, batch->head, last_block(batch->head), false);
+	}
+
+	*batch = (struct Batch){ .head = NULL, .count = 0 };
+}
+
+ALLOC static void *magazine_alloc(PoolMagazine *magazine)
+{
+	if (!magazine->loaded.count)
+	{
+		if (magazine->spare.count)
+		{
+			struct Batch loaded = magazine->loaded;
+
+			magazine->loaded = magazine->spare;
+			magazine->spare  = loaded;
+		}
+		else
+		{
+			magazine_refill(magazine);
+		}
+	}
+
+	return batch_pop(&magazine->loaded);
+}
+
+static void magazine_free(PoolMagazine *magazine, void *ptr)
+{
+	// a full spare is only handed back once the loaded batch fills again, so
+	// alternating allocs and frees stay local
+	if (magazine->loaded.count == MAGAZINE_CAPACITY)
+	{
+		magazine_flush(magazine, &magazine->spare);
+
+		magazine->spare  = magazine->loaded;
+		magazine->loaded = (struct Batch){ .head = NULL, .count = 0 };
+	}
+
+	batch_push(&magazine->loaded, ptr);
+}
+
+AtomicPoolAlloc *create_atomic_pool_allocator(const size_t nmemb,
+                                              const size_t size)
+{
+	AtomicPoolAlloc *pool = memory_allocate_container(HEAP_ALLOCATOR,
+	                                                  sizeof(AtomicPoolAlloc));
+
+	atomic_init(&pool->blocks, 0);
+	atomic_init(&pool->batches, 0);
+	atomic_init(&pool->chunks, NULL);
+	atomic_init(&pool->grown, 0);
+
+	pool->nmemb = (nmemb) ? nmemb : 1;
+	pool->size  = slot_size(size);
+
+	pool_grow(pool);
+
+	return pool;
+}
+
+void destroy_atomic_pool_allocator(AtomicPoolAlloc **pool)
+{
+	struct Chunk *chunk = atomic_load_explicit(&(*pool)->chunks,
+	                                           memory_order_acquire);
+
+	while (chunk)
+	{
+		struct Chunk *prev = chunk->prev;
+
+		heap_free(HEAP_ALLOCATOR, chunk);
+
+		chunk = prev;
+	}
+
+	memory_free_buffer(HEAP_ALLOCATOR, (void **)pool);
+}
+
+void *alloc_atomic_pool_allocator(AtomicPoolAlloc *pool)
+{
+	return pool_alloc(pool);
+}
+
+void *calloc_atomic_pool_allocator(AtomicPoolAlloc *pool)
+{
+	void *ptr = pool_alloc(pool);
+	return memset(ptr, 0, pool->size);
+}
+
+void free_atomic_pool_allocator(AtomicPoolAlloc *pool, void *ptr)
+{
+	pool_free(pool, ptr);
+}
+
+PoolMagazine *create_pool_magazine(AtomicPoolAlloc *pool)
+{
+	PoolMagazine *magazine = memory_allocate_container(HEAP_ALLOCATOR,
+	                                                   sizeof(PoolMagazine));
+
+	magazine->pool = pool;
+
+	return magazine;
+}
+
+void destroy_pool_magazine(PoolMagazine **magazine)
+{
+	magazine_flush(*magazine, &(*magazine)->loaded);
+	magazine_flush(*magazine, &(*magazine)->spare);
+
+	memory_free_buffer(HEAP_ALLOCATOR, (void **)magazine);
+}
+
+void *alloc_pool_magazine(PoolMagazine *magazine)
+{
+	return magazine_alloc(magazine);
+}
+
+void *calloc_pool_magazine(PoolMagazine *magazine)
+{
+	void *ptr = magazine_alloc(magazine);
+	return memset(ptr, 0, magazine->pool->size);
+}
+
+void free_pool_magazine(PoolMagazine *magazine, void *ptr)
+{
+	magazine_free(magazine, ptr);
+}
@@ -1,59 +1,135 @@
 #include "../../bump.h"
 #include "../../internals/base.h"
-#include "../../internals/cassert.h"
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <string.h>
 
+// The offset is atomic so the same region can also be shared between threads.
+// Single-threaded calls read and write it with relaxed loads and stores, which
+// compile to plain moves.
 typedef struct BumpAlloc
 {
-	void  *ptr;
-	size_t offset;
-	size_t size;
+	void         *ptr;
+	atomic_size_t offset;
+	size_t        size;
 } BumpAlloc;
 
 BumpAlloc *create_bump_allocator(const size_t size)
 {
-	BumpAlloc *b_alloc = memory_allocate_container(sizeof(BumpAlloc));
+	BumpAlloc *b_alloc = memory_allocate_container(HEAP_ALLOCATOR,
+	                                               sizeof(BumpAlloc));
 
-	b_alloc->ptr  = malloc(size);
+	b_alloc->ptr  = heap_malloc(HEAP_ALLOCATOR, size);
 	b_alloc->size = size;
 
+	atomic_init(&b_alloc->offset, 0);
+
 	return b_alloc;
 }
 
 void destroy_bump_allocator(BumpAlloc **bump)
 {
-	memory_free_container_generic((void **)bump, (*bump)->ptr);
+	heap_free(HEAP_ALLOCATOR, (*bump)->ptr);
+	memory_free_buffer(HEAP_ALLOCATOR, (void **)bump);
 }
 
-void *bump_alloc(BumpAlloc *bump, const size_t size)
+// compared by subtraction so nothing wraps, as the offset never exceeds size
+static bool bump_fits(const BumpAlloc *bump,
+                      const size_t     offset,
+                      const size_t     padding,
+                      const size_t     size)
+{
+	return padding <= bump->size - offset &&
+	       size <= bump->size - offset - padding;
+}
+
+void *bump_alloc_aligned(BumpAlloc   *bump,
+                         const size_t size,
+                         const size_t align)
 {
-	CHEAP_ASSERT(bump->offset + size <= bump->size,
-	             "Bump allocator has insufficient memory.");
+	const size_t offset  = atomic_load_explicit(&bump->offset,
+	                                            memory_order_relaxed);
+	const size_t padding = memory_align_padding(bump->ptr + offset, align);
+
+	if (!bump_fits(bump, offset, padding, size))
+	{
+		return NULL;
+	}
 
-	void *ptr = (bump->ptr + bump->offset);
+	atomic_store_explicit(&bump->offset,
+	                      offset + padding + size,
+	                      memory_order_relaxed);
 
-	bump->offset += size;
+	return (bump->ptr + offset + padding);
+}
 
-	return ptr;
+void *bump_alloc(BumpAlloc *bump, const size_t size)
+{
+	return bump_alloc_aligned(bump, size, _Alignof(max_align_t));
 }
 
 void *bump_calloc(BumpAlloc *bump, const size_t size)
 {
 	void *ptr = bump_alloc(bump, size);
 
-	return memset(ptr, 0, size);
+	return (ptr) ? memset(ptr, 0, size) : NULL;
+}
+
+void *bump_alloc_cache_line(BumpAlloc *bump, const size_t size)
+{
+	return bump_alloc_aligned(bump, size, CACHE_LINE_SIZE);
+}
+
+void *bump_alloc_atomic_aligned(BumpAlloc   *bump,
+                                const size_t size,
+                                const size_t align)
+{
+	size_t offset  = atomic_load_explicit(&bump->offset, memory_order_relaxed);
+	size_t padding = 0;
+
+	// A compare-exchange rather than a fetch-add, so the padding is computed
+	// from the offset actually claimed and a full region is never overshot.
+	do
+	{
+		padding = memory_align_padding(bump->ptr + offset, align);
+
+		if (!bump_fits(bump, offset, padding, size))
+		{
+			return NULL;
+		}
+	}
+	while (!atomic_compare_exchange_weak_explicit(&bump->offset,
+	                                              &offset,
+	                                              offset + padding + size,
+	                                              memory_order_relaxed,
+	                                              memory_order_relaxed));
+
+	return (bump->ptr + offset + padding);
+}
+
+void *bump_alloc_atomic(BumpAlloc *bump, const size_t size)
+{
+	return bump_alloc_atomic_aligned(bump, size, _Alignof(max_align_t));
 }
 
 void *bump_salloc(BumpAlloc *bump, const char *string)
 {
 	size_t len = strlen(string);
 
-	void *ptr = bump_calloc(bump, len + 1);
+	// characters need no alignment, so strings pack tightly
+	void *ptr = bump_alloc_aligned(bump, len + 1, 1);
+
+	if (!ptr)
+	{
+		return NULL;
+	}
+
+	memset(ptr, 0, len + 1);
 
 	return strncpy(ptr, string, len);
 }
 
 void bump_clear(BumpAlloc *bump)
 {
-	bump->offset = 0;
+	atomic_store_explicit(&bump->offset, 0, memory_order_relaxed);
 }
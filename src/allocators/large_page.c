@@ -0,0 +1,120 @@
+#include "../../large_page.h"
+#include "../../internals/base.h"
+#include "../../internals/cassert.h"
+#include "../../internals/pages.h"
+#include <memory.h>
+#include <stdint.h>
+
+#define MAP_THRESHOLD (HUGE_PAGE_SIZE / 2)
+
+// Every allocation starts with the length of its mapping, or zero when it
+// came from malloc, so a free knows which to hand it back to.
+struct Region
+{
+	_Alignas(max_align_t) size_t mapped;
+};
+
+static unsigned region_flags(const void *ctx)
+{
+	return (unsigned)(uintptr_t)ctx;
+}
+
+static struct Region *region_of(void *ptr)
+{
+	return (struct Region *)ptr - 1;
+}
+
+ALLOC static void *large_alloc(void *ctx, const size_t size)
+{
+	size_t         length = sizeof(struct Region) + size;
+	struct Region *region = NULL;
+
+	if (length < MAP_THRESHOLD)
+	{
+		region = heap_malloc(HEAP_ALLOCATOR, length);
+
+		CHEAP_ASSERT(region, "Large page allocator unable to acquire memory.");
+
+		region->mapped = 0;
+	}
+	else
+	{
+		region         = map_pages(&length, region_flags(ctx));
+		region->mapped = length;
+	}
+
+	return region + 1;
+}
+
+static void large_free(void *ctx, void *ptr)
+{
+	(void)ctx;
+
+	struct Region *region = region_of(ptr);
+
+	if (region->mapped)
+	{
+		unmap_pages(region, region->mapped);
+	}
+	else
+	{
+		heap_free(HEAP_ALLOCATOR, region);
+	}
+}
+
+ALLOC static void *large_realloc(void        *ctx,
+                                 void        *ptr,
+                                 const size_t old_size,
+                                 const size_t new_size)
+{
+	if (!ptr)
+	{
+		return large_alloc(ctx, new_size);
+	}
+
+	struct Region *region = region_of(ptr);
+	size_t         length = sizeof(struct Region) + new_size;
+
+	if (region->mapped)
+	{
+		// a mapping keeps its length until it shrinks below half
+		if (length <= region->mapped && length > region->mapped / 2)
+		{
+			return ptr;
+		}
+
+		region = remap_pages(region,
+		                     region->mapped,
+		                     &length,
+		                     region_flags(ctx));
+
+		region->mapped = length;
+
+		return region + 1;
+	}
+
+	if (length < MAP_THRESHOLD)
+	{
+		region = heap_realloc(HEAP_ALLOCATOR, region, length);
+
+		CHEAP_ASSERT(region, "Large page allocator unable to acquire memory.");
+
+		return region + 1;
+	}
+
+	void *dest = large_alloc(ctx, new_size);
+
+	memcpy(dest, ptr, (old_size < new_size) ? old_size : new_size);
+
+	heap_free(HEAP_ALLOCATOR, region);
+
+	return dest;
+}
+
+Allocator large_page_allocator(const unsigned flags)
+{
+	return (Allocator){ .alloc   = large_alloc,
+		                .realloc = large_realloc,
+		                .free    = large_free,
+		                .ctx     = (void *)(uintptr_t)flags };
+}
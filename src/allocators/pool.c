@@ -8,9 +8,16 @@ struct FreeBlock
 	struct FreeBlock *prev;
 };
 
+struct Chunk
+{
+	struct Chunk *prev;
+	size_t        nmemb;
+};
+
 struct PoolAlloc
 {
 	struct FreeBlock *blocks;
+	struct Chunk     *chunks;
 	void             *ptr;
 	size_t            offset;
 	size_t            nmemb;
@@ -22,6 +29,52 @@ static size_t min_size(const size_t size)
 	return (size > sizeof(struct FreeBlock)) ? size : sizeof(struct FreeBlock);
 }
 
+static void *chunk_base(const struct Chunk *chunk)
+{
+	return (void *)(chunk + 1);
+}
+
+static void pool_chain_chunk(PoolAlloc *pool, const size_t nmemb)
+{
+	const size_t  size  = sizeof(struct Chunk) + nmemb * pool->size;
+	struct Chunk *chunk = heap_malloc(HEAP_ALLOCATOR, size);
+
+	CHEAP_ASSERT(chunk, "Pool allocator unable to acquire memory.");
+
+	chunk->prev  = pool->chunks;
+	chunk->nmemb = nmemb;
+
+	pool->chunks = chunk;
+	pool->ptr    = chunk_base(chunk);
+	pool->offset = 0;
+	pool->nmemb  = nmemb;
+}
+
+static void destroy_chunks(struct Chunk *chunk)
+{
+	while (chunk)
+	{
+		struct Chunk *prev = chunk->prev;
+
+		heap_free(HEAP_ALLOCATOR, chunk);
+
+		chunk = prev;
+	}
+}
+
+// chunks grow geometrically, and at least to hold what is being asked for
+static void pool_grow(PoolAlloc *pool, const size_t required)
+{
+	size_t nmemb = SEQUENTIAL_GROWTH * pool->nmemb;
+
+	if (nmemb < required)
+	{
+		nmemb = required;
+	}
+
+	pool_chain_chunk(pool, nmemb);
+}
+
 ALLOC static void *pool_alloc(PoolAlloc *pool)
 {
 	void *ptr = NULL;
@@ -31,14 +84,17 @@ ALLOC static void *pool_alloc(PoolAlloc *pool)
 		ptr          = pool->blocks;
 		pool->blocks = pool->blocks->prev;
 	}
-	else if (pool->offset < pool->nmemb)
+	else
 	{
+		if (pool->offset == pool->nmemb)
+		{
+			pool_grow(pool, 1);
+		}
+
 		ptr = pool->ptr + pool->offset * pool->size;
 		pool->offset++;
 	}
 
-	CHEAP_ASSERT(ptr, "Pool allocator could not allocate memory.");
-
 	return ptr;
 }
 
@@ -48,9 +104,32 @@ ALLOC static void *pool_c_alloc(PoolAlloc *pool)
 	return memset(ptr, 0, pool->size);
 }
 
+static void pool_alloc_many(PoolAlloc *pool, const size_t n, void **out)
+{
+	size_t i = 0;
+
+	for (; i < n && pool->blocks; i++)
+	{
+		out[i]       = pool->blocks;
+		pool->blocks = pool->blocks->prev;
+	}
+
+	// whatever the free list could not cover is carved from one chunk
+	if (pool->nmemb - pool->offset < n - i)
+	{
+		pool_grow(pool, n - i);
+	}
+
+	for (; i < n; i++)
+	{
+		out[i] = pool->ptr + pool->offset * pool->size;
+		pool->offset++;
+	}
+}
+
 static void pool_free(PoolAlloc *pool, void *ptr)
 {
-	if (ptr == pool->ptr + (pool->offset - 1) * pool->size)
+	if (pool->offset && ptr == pool->ptr + (pool->offset - 1) * pool->size)
 	{
 		pool->offset--;
 	}
@@ -62,33 +141,46 @@ static void pool_free(PoolAlloc *pool, void *ptr)
 	}
 }
 
-static void pool_clear(PoolAlloc *pool)
+static void pool_free_many(PoolAlloc *pool, const size_t n, void **ptrs)
 {
-	pool->blocks = NULL;
-	pool->offset = 0;
+	// the blocks are linked so the next batch allocation returns them in order
+	for (size_t i = n; i > 0; i--)
+	{
+		struct FreeBlock *block = ptrs[i - 1];
+		block->prev             = pool->blocks;
+		pool->blocks            = block;
+	}
 }
 
-PoolAlloc *create_pool_allocator(size_t nmemb, size_t size)
+static void pool_clear(PoolAlloc *pool)
 {
-	const size_t n_size = min_size(size);
+	// keep the newest chunk, it is the largest and covers the last peak best
+	destroy_chunks(pool->chunks->prev);
 
-	void *memory = memory_allocate_container(sizeof(struct PoolAlloc) +
-	                                         n_size * nmemb);
+	pool->chunks->prev = NULL;
+	pool->blocks       = NULL;
+	pool->offset       = 0;
+}
 
-	PoolAlloc *pool = memory;
+PoolAlloc *create_pool_allocator(size_t nmemb, size_t size)
+{
+	PoolAlloc *pool = memory_allocate_container(HEAP_ALLOCATOR,
+	                                            sizeof(struct PoolAlloc));
 
 	pool->blocks = NULL;
-	pool->ptr    = memory + sizeof(struct PoolAlloc);
-	pool->offset = 0;
-	pool->nmemb  = nmemb;
-	pool->size   = n_size;
+	pool->chunks = NULL;
+	pool->size   = min_size(size);
+
+	pool_chain_chunk(pool, (nmemb) ? nmemb : 1);
 
 	return pool;
 }
 
 void destroy_pool_allocator(PoolAlloc **pool)
 {
-	memory_free_buffer((void **)pool);
+	destroy_chunks((*pool)->chunks);
+
+	memory_free_buffer(HEAP_ALLOCATOR, (void **)pool);
 }
 
 ALLOC void *alloc_pool_allocator(PoolAlloc *pool)
@@ -101,11 +193,21 @@ ALLOC void *calloc_pool_allocator(PoolAlloc *pool)
 	return pool_c_alloc(pool);
 }
 
+void alloc_many_pool_allocator(PoolAlloc *pool, size_t n, void **out)
+{
+	pool_alloc_many(pool, n, out);
+}
+
 void free_pool_allocator(PoolAlloc *pool, void *ptr)
 {
 	pool_free(pool, ptr);
 }
 
+void free_many_pool_allocator(PoolAlloc *pool, size_t n, void **ptrs)
+{
+	pool_free_many(pool, n, ptrs);
+}
+
 void clear_pool_allocator(PoolAlloc *pool)
 {
 	pool_clear(pool);
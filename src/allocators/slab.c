@@ -0,0 +1,376 @@
+#include "../../slab.h"
+#include "../../internals/base.h"
+#include "../../internals/cassert.h"
+#include <memory.h>
+#include <stdint.h>
+
+#define SLAB_SIZE   (64 * 1024)
+#define SPARE_SLABS 4
+
+// 16-byte steps up to 128, then four classes per doubling up to 8 KiB, so no
+// class wastes more than a fifth of a block to rounding
+#define SMALL_STEP     16
+#define SMALL_CLASSES  8
+#define GROUP_CLASSES  4
+#define CLASS_COUNT    32
+#define MAX_CLASS_SIZE 8192
+#define LARGE_CLASS    CLASS_COUNT
+
+struct FreeBlock
+{
+	struct FreeBlock *prev;
+};
+
+// Slabs and large regions are aligned to SLAB_SIZE and start with this header,
+// so masking the address of a block finds it.
+struct Slab
+{
+	struct Slab      *prev;
+	struct Slab      *next;
+	SlabAlloc        *owner;
+	struct FreeBlock *blocks;
+	size_t            cursor;
+	size_t            nmemb;
+	size_t            used;
+	size_t            size;
+	size_t            class;
+};
+
+#define HEADER_SIZE                                                            \
+	((sizeof(struct Slab) + CACHE_LINE_SIZE - 1) &                             \
+	 ~(size_t)(CACHE_LINE_SIZE - 1))
+
+// a slab is on the partial list of its class while it has room, and on the
+// full list otherwise
+struct SizeClass
+{
+	struct Slab *partial;
+	struct Slab *full;
+};
+
+struct SlabAlloc
+{
+	struct SizeClass classes[CLASS_COUNT];
+	struct Slab     *large;
+	struct Slab     *spare;
+	size_t           spares;
+};
+
+static size_t size_class(const size_t size)
+{
+	if (size <= SMALL_CLASSES * SMALL_STEP)
+	{
+		return (size) ? (size - 1) / SMALL_STEP : 0;
+	}
+
+	const size_t lg = sizeof(unsigned long) * 8 - 1 -
+	                  __builtin_clzl(size - 1);
+
+	return SMALL_CLASSES + (lg - 7) * GROUP_CLASSES +
+	       ((size - 1) >> (lg - 2)) - GROUP_CLASSES;
+}
+
+static size_t class_size(const size_t class)
+{
+	if (class < SMALL_CLASSES)
+	{
+		return (class + 1) * SMALL_STEP;
+	}
+
+	const size_t lg   = (class - SMALL_CLASSES) / GROUP_CLASSES + 7;
+	const size_t step = (class - SMALL_CLASSES) % GROUP_CLASSES + 1;
+
+	return ((size_t)1 << lg) + step * ((size_t)1 << (lg - 2));
+}
+
+static struct Slab *slab_of(const void *ptr)
+{
+	return (struct Slab *)((uintptr_t)ptr & ~(uintptr_t)(SLAB_SIZE - 1));
+}
+
+static void *slab_base(struct Slab *slab)
+{
+	return (void *)slab + HEADER_SIZE;
+}
+
+static void list_push(struct Slab **list, struct Slab *slab)
+{
+	slab->prev = NULL;
+	slab->next = *list;
+
+	if (*list)
+	{
+		(*list)->prev = slab;
+	}
+
+	*list = slab;
+}
+
+static void list_remove(struct Slab **list, struct Slab *slab)
+{
+	if (slab->prev)
+	{
+		slab->prev->next = slab->next;
+	}
+	else
+	{
+		*list = slab->next;
+	}
+
+	if (slab->next)
+	{
+		slab->next->prev = slab->prev;
+	}
+}
+
+static void destroy_list(struct Slab *slab)
+{
+	while (slab)
+	{
+		struct Slab *next = slab->next;
+
+		heap_free(HEAP_ALLOCATOR, slab);
+
+		slab = next;
+	}
+}
+
+ALLOC static struct Slab *map_region(const size_t size)
+{
+	struct Slab *slab = heap_aligned_alloc(HEAP_ALLOCATOR, SLAB_SIZE, size);
+
+	CHEAP_ASSERT(slab, "Slab allocator unable to acquire memory.");
+
+	return slab;
+}
+
+ALLOC static struct Slab *slab_acquire(SlabAlloc *slab, const size_t class)
+{
+	struct Slab *page = slab->spare;
+
+	if (page)
+	{
+		list_remove(&slab->spare, page);
+		slab->spares--;
+	}
+	else
+	{
+		page = map_region(SLAB_SIZE);
+	}
+
+	const size_t size = class_size(class);
+
+	*page = (struct Slab){ .owner  = slab,
+		                   .blocks = NULL,
+		                   .cursor = 0,
+		                   .nmemb  = (SLAB_SIZE - HEADER_SIZE) / size,
+		                   .used   = 0,
+		                   .size   = size,
+		                   .class  = class };
+
+	list_push(&slab->classes[class].partial, page);
+
+	return page;
+}
+
+// a few empty slabs are kept so that churn around a slab boundary does not
+// map and unmap on every cycle
+static void slab_release(SlabAlloc *slab, struct Slab *page)
+{
+	list_remove(&slab->classes[page->class].partial, page);
+
+	if (slab->spares < SPARE_SLABS)
+	{
+		list_push(&slab->spare, page);
+		slab->spares++;
+	}
+	else
+	{
+		heap_free(HEAP_ALLOCATOR, page);
+	}
+}
+
+ALLOC static void *large_alloc(SlabAlloc *slab, const size_t size)
+{
+	const size_t total = (HEADER_SIZE + size + SLAB_SIZE - 1) &
+	                     ~(size_t)(SLAB_SIZE - 1);
+
+	struct Slab *region = map_region(total);
+
+	*region = (struct Slab){ .owner = slab,
+		                     .size  = total - HEADER_SIZE,
+		                     .class = LARGE_CLASS };
+
+	list_push(&slab->large, region);
+
+	return slab_base(region);
+}
+
+ALLOC static void *slab_alloc(SlabAlloc *slab, const size_t size)
+{
+	if (size > MAX_CLASS_SIZE)
+	{
+		return large_alloc(slab, size);
+	}
+
+	const size_t      class = size_class(size);
+	struct SizeClass *sc    = &slab->classes[class];
+	struct Slab      *page  = (sc->partial) ? sc->partial
+	                                        : slab_acquire(slab, class);
+	void             *ptr   = NULL;
+
+	if (page->blocks)
+	{
+		ptr          = page->blocks;
+		page->blocks = page->blocks->prev;
+	}
+	else
+	{
+		ptr = slab_base(page) + page->cursor * page->size;
+		page->cursor++;
+	}
+
+	if (++page->used == page->nmemb)
+	{
+		list_remove(&sc->partial, page);
+		list_push(&sc->full, page);
+	}
+
+	return ptr;
+}
+
+static void slab_free(SlabAlloc *slab, void *ptr)
+{
+	struct Slab *page = slab_of(ptr);
+
+	CHEAP_ASSERT(page->owner == slab, "Pointer not owned by slab allocator.");
+
+	if (page->class == LARGE_CLASS)
+	{
+		list_remove(&slab->large, page);
+		heap_free(HEAP_ALLOCATOR, page);
+
+		return;
+	}
+
+	struct SizeClass *sc = &slab->classes[page->class];
+
+	if (page->used == page->nmemb)
+	{
+		list_remove(&sc->full, page);
+		list_push(&sc->partial, page);
+	}
+
+	struct FreeBlock *block = ptr;
+
+	block->prev  = page->blocks;
+	page->blocks = block;
+
+	// the last slab with room in a class stays, even when empty
+	if (!--page->used && (page->prev || page->next))
+	{
+		slab_release(slab, page);
+	}
+}
+
+ALLOC static void *slab_realloc(SlabAlloc *slab, void *ptr, const size_t size)
+{
+	if (!ptr)
+	{
+		return slab_alloc(slab, size);
+	}
+
+	const struct Slab *page = slab_of(ptr);
+
+	// shrinking a large region or staying within a class keeps the block
+	if ((page->class == LARGE_CLASS && size > MAX_CLASS_SIZE &&
+	     size <= page->size) ||
+	    (page->class != LARGE_CLASS && size <= page->size &&
+	     size_class(size) == page->class))
+	{
+		return ptr;
+	}
+
+	void *dest = slab_alloc(slab, size);
+
+	memcpy(dest, ptr, (page->size < size) ? page->size : size);
+
+	slab_free(slab, ptr);
+
+	return dest;
+}
+
+SlabAlloc *create_slab_allocator(void)
+{
+	return memory_allocate_container(HEAP_ALLOCATOR, sizeof(SlabAlloc));
+}
+
+void destroy_slab_allocator(SlabAlloc **slab)
+{
+	for (size_t class = 0; class < CLASS_COUNT; class++)
+	{
+		destroy_list((*slab)->classes[class].partial);
+		destroy_list((*slab)->classes[class].full);
+	}
+
+	destroy_list((*slab)->large);
+	destroy_list((*slab)->spare);
+
+	memory_free_buffer(HEAP_ALLOCATOR, (void **)slab);
+}
+
+void *alloc_slab_allocator(SlabAlloc *slab, const size_t size)
+{
+	return slab_alloc(slab, size);
+}
+
+void *calloc_slab_allocator(SlabAlloc *slab, const size_t size)
+{
+	return memset(slab_alloc(slab, size), 0, size);
+}
+
+void *realloc_slab_allocator(SlabAlloc *slab, void *ptr, const size_t size)
+{
+	return slab_realloc(slab, ptr, size);
+}
+
+void free_slab_allocator(SlabAlloc *slab, void *ptr)
+{
+	if (ptr)
+	{
+		slab_free(slab, ptr);
+	}
+}
+
+size_t size_slab_allocator(const void *ptr)
+{
+	return slab_of(ptr)->size;
+}
+
+static void *allocator_alloc(void *slab, const size_t size)
+{
+	return slab_alloc(slab, size);
+}
+
+static void *allocator_realloc(void        *slab,
+                               void        *ptr,
+                               const size_t old_size,
+                               const size_t new_size)
+{
+	(void)old_size;
+
+	return slab_realloc(slab, ptr, new_size);
+}
+
+static void allocator_free(void *slab, void *ptr)
+{
+	slab_free(slab, ptr);
+}
+
+Allocator slab_allocator(SlabAlloc *slab)
+{
+	return (Allocator){ .alloc   = allocator_alloc,
+		                .realloc = allocator_realloc,
+		                .free    = allocator_free,
+		                .ctx     = slab };
+}
@@ -1,3 +1,4 @@
+#include "../../allocator.h"
 #include "../../span.h"
 #include "../../array.h"
 #include "../../internals/base.h"
@@ -6,25 +7,36 @@
 
 typedef struct Array
 {
-	void  *array;
-	size_t nmemb;
-	size_t size;
+	void     *array;
+	size_t    nmemb;
+	size_t    size;
+	Allocator allocator;
 } Array;
 
 Array *create_array(const size_t size, const size_t nmemb)
 {
-	Array *array = memory_allocate_container(sizeof(Array));
+	return create_array_with_allocator(size, nmemb, (Allocator){ 0 });
+}
+
+Array *create_array_with_allocator(const size_t    size,
+                                   const size_t    nmemb,
+                                   const Allocator allocator)
+{
+	Array *array = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(Array));
 
-	array->array = generic_mempool_alloc(nmemb, size);
-	array->nmemb = nmemb;
-	array->size  = size;
+	array->array     = generic_mempool_alloc(&allocator, nmemb, size);
+	array->nmemb     = nmemb;
+	array->size      = size;
+	array->allocator = allocator;
 
 	return array;
 }
 
 void destroy_array(Array **array)
 {
-	memory_free_container_generic((void **)array, (*array)->array);
+	memory_free_container_generic((void **)array,
+	                              (*array)->array,
+	                              &(*array)->allocator);
 }
 
 void set_array(Array *array, const void *value, const size_t index)
@@ -0,0 +1,107 @@
+#include "../../allocator.h"
+#include "../../art_table.h"
+#include "../../internals/art.h"
+#include "../../internals/base.h"
+
+typedef struct ArtTable
+{
+	struct ArtTree tree;
+} ArtTable;
+
+ArtTable *create_art_table(const size_t k_size, const size_t v_size)
+{
+	return create_art_table_with_allocator(k_size, v_size, (Allocator){ 0 });
+}
+
+ArtTable *create_art_table_with_allocator(const size_t    k_size,
+                                          const size_t    v_size,
+                                          const Allocator allocator)
+{
+	ArtTable *table = memory_calloc(HEAP_CONTAINER,
+	                                &allocator,
+	                                sizeof(ArtTable));
+
+	table->tree = create_art(k_size, v_size, allocator);
+
+	return table;
+}
+
+void destroy_art_table(ArtTable **table)
+{
+	destroy_art(&(*table)->tree);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)table,
+	                         &(*table)->tree.allocator);
+}
+
+void insert_art_table(ArtTable *table, const void *key, const void *value)
+{
+	art_insert(&table->tree, key, value);
+}
+
+void insert_range_art_table(ArtTable *table, Range range)
+{
+	art_insert_range(&table->tree, range);
+}
+
+size_t count_art_table(const ArtTable *table, const void *key)
+{
+	return (art_search(&table->tree, key)) ? 1 : 0;
+}
+
+void *find_art_table(const ArtTable *table, const void *key)
+{
+	return art_search(&table->tree, key);
+}
+
+bool contains_art_table(const ArtTable *table, const void *key)
+{
+	return art_search(&table->tree, key) ? true : false;
+}
+
+void erase_art_table(ArtTable *table, const void *key)
+{
+	art_erase(&table->tree, key);
+}
+
+void clear_art_table(ArtTable *table)
+{
+	art_clear(&table->tree);
+}
+
+Range prefix_art_table(const ArtTable *table,
+                       const void     *prefix,
+                       const size_t    length)
+{
+	return art_prefix(ITERATOR_ART_TABLE, &table->tree, prefix, length);
+}
+
+Iter begin_art_table(const ArtTable *table)
+{
+	return begin_art(ITERATOR_ART_TABLE, &table->tree);
+}
+
+Iter end_art_table(const ArtTable *table)
+{
+	return end_art(ITERATOR_ART_TABLE, &table->tree);
+}
+
+Iter rbegin_art_table(const ArtTable *table)
+{
+	return rbegin_art(ITERATOR_ART_TABLE_REVERSE, &table->tree);
+}
+
+Iter rend_art_table(const ArtTable *table)
+{
+	return rend_art(ITERATOR_ART_TABLE_REVERSE, &table->tree);
+}
+
+bool empty_art_table(const ArtTable *table)
+{
+	return generic_empty(table->tree.nmemb);
+}
+
+size_t size_art_table(const ArtTable *table)
+{
+	return generic_size(table->tree.nmemb);
+}
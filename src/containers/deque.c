@@ -1,3 +1,4 @@
+#include "../../allocator.h"
 #include "../../deque.h"
 #include "../../internals/base.h"
 #include "../../internals/deq.h"
@@ -16,13 +17,18 @@ typedef struct DoubleEndedQueue
 
 Deque *create_deque(const size_t size)
 {
-	Deque *deque = memory_allocate_container(sizeof(Deque));
+	return create_deque_with_allocator(size, (Allocator){ 0 });
+}
+
+Deque *create_deque_with_allocator(const size_t size, const Allocator allocator)
+{
+	Deque *deque = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(Deque));
 
 	const size_t array_size = minimum_array_size(size);
 	const size_t capacity   = array_size / size;
 	const size_t init_index = capacity / 2;
 
-	deque->control = create_control_array(capacity, size);
+	deque->control = create_control_array(capacity, size, allocator);
 	deque->arr_cap = capacity;
 	deque->size    = size;
 	deque->front   = init_index;
@@ -34,7 +40,9 @@ Deque *create_deque(const size_t size)
 void destroy_deque(Deque **deque)
 {
 	destroy_control_array(&(*deque)->control, (*deque)->front);
-	memory_free_buffer((void **)deque);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)deque,
+	                         &(*deque)->control.allocator);
 }
 
 void push_front_deque(Deque *deque, const void *value)
@@ -0,0 +1,98 @@
+#include "../../allocator.h"
+#include "../../flat_set.h"
+#include "../../internals/base.h"
+#include "../../internals/flat.h"
+
+typedef struct FlatSet
+{
+	struct FlatArray flat;
+} FlatSet;
+
+FlatSet *create_flat_set(const size_t size, const KComp compare)
+{
+	return create_flat_set_with_allocator(size, compare, (Allocator){ 0 });
+}
+
+FlatSet *create_flat_set_with_allocator(const size_t    size,
+                                        const KComp     compare,
+                                        const Allocator allocator)
+{
+	FlatSet *set = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(FlatSet));
+
+	set->flat = create_flat(size, 0, compare, allocator);
+
+	return set;
+}
+
+void destroy_flat_set(FlatSet **set)
+{
+	destroy_flat(&(*set)->flat);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)set,
+	                         &(*set)->flat.allocator);
+}
+
+void insert_flat_set(FlatSet *set, const void *key)
+{
+	flat_insert(&set->flat, key, NULL);
+}
+
+void insert_range_flat_set(FlatSet *set, Range range)
+{
+	flat_insert_range_set(&set->flat, range);
+}
+
+size_t count_flat_set(FlatSet *set, const void *key)
+{
+	return (flat_search(&set->flat, key)) ? 1 : 0;
+}
+
+void *find_flat_set(FlatSet *set, const void *key)
+{
+	return flat_search(&set->flat, key);
+}
+
+bool contains_flat_set(FlatSet *set, const void *key)
+{
+	return flat_search(&set->flat, key) ? true : false;
+}
+
+void erase_flat_set(FlatSet *set, const void *key)
+{
+	flat_erase(&set->flat, key);
+}
+
+void clear_flat_set(FlatSet *set)
+{
+	flat_clear(&set->flat);
+}
+
+Iter begin_flat_set(FlatSet *set)
+{
+	return begin_flat(ITERATOR_FLAT_SET, &set->flat);
+}
+
+Iter end_flat_set(FlatSet *set)
+{
+	return end_flat(ITERATOR_FLAT_SET, &set->flat);
+}
+
+Iter rbegin_flat_set(FlatSet *set)
+{
+	return rbegin_flat(ITERATOR_FLAT_SET_REVERSE, &set->flat);
+}
+
+Iter rend_flat_set(FlatSet *set)
+{
+	return rend_flat(ITERATOR_FLAT_SET_REVERSE, &set->flat);
+}
+
+bool empty_flat_set(FlatSet *set)
+{
+	return generic_empty(flat_size(&set->flat));
+}
+
+size_t size_flat_set(FlatSet *set)
+{
+	return generic_size(flat_size(&set->flat));
+}
@@ -0,0 +1,108 @@
+#include "../../allocator.h"
+#include "../../flat_table.h"
+#include "../../internals/base.h"
+#include "../../internals/flat.h"
+
+typedef struct FlatTable
+{
+	struct FlatArray flat;
+} FlatTable;
+
+FlatTable *create_flat_table(const size_t k_size,
+                             const size_t v_size,
+                             const KComp  compare)
+{
+	return create_flat_table_with_allocator(k_size,
+	                                        v_size,
+	                                        compare,
+	                                        (Allocator){ 0 });
+}
+
+FlatTable *create_flat_table_with_allocator(const size_t    k_size,
+                                            const size_t    v_size,
+                                            const KComp     compare,
+                                            const Allocator allocator)
+{
+	FlatTable *table = memory_calloc(HEAP_CONTAINER,
+	                                 &allocator,
+	                                 sizeof(FlatTable));
+
+	table->flat = create_flat(k_size, v_size, compare, allocator);
+
+	return table;
+}
+
+void destroy_flat_table(FlatTable **table)
+{
+	destroy_flat(&(*table)->flat);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)table,
+	                         &(*table)->flat.allocator);
+}
+
+void insert_flat_table(FlatTable *table, const void *key, const void *value)
+{
+	flat_insert(&table->flat, key, value);
+}
+
+void insert_range_flat_table(FlatTable *table, Range range)
+{
+	flat_insert_range_table(&table->flat, range);
+}
+
+size_t count_flat_table(FlatTable *table, const void *key)
+{
+	return (flat_search(&table->flat, key)) ? 1 : 0;
+}
+
+void *find_flat_table(FlatTable *table, const void *key)
+{
+	void *key_ptr = flat_search(&table->flat, key);
+
+	return (key_ptr) ? key_ptr + table->flat.v_offset : NULL;
+}
+
+bool contains_flat_table(FlatTable *table, const void *key)
+{
+	return flat_search(&table->flat, key) ? true : false;
+}
+
+void erase_flat_table(FlatTable *table, const void *key)
+{
+	flat_erase(&table->flat, key);
+}
+
+void clear_flat_table(FlatTable *table)
+{
+	flat_clear(&table->flat);
+}
+
+Iter begin_flat_table(FlatTable *table)
+{
+	return begin_flat(ITERATOR_FLAT_TABLE, &table->flat);
+}
+
+Iter end_flat_table(FlatTable *table)
+{
+	return end_flat(ITERATOR_FLAT_TABLE, &table->flat);
+}
+
+Iter rbegin_flat_table(FlatTable *table)
+{
+	return rbegin_flat(ITERATOR_FLAT_TABLE_REVERSE, &table->flat);
+}
+
+Iter rend_flat_table(FlatTable *table)
+{
+	return rend_flat(ITERATOR_FLAT_TABLE_REVERSE, &table->flat);
+}
+
+bool empty_flat_table(FlatTable *table)
+{
+	return generic_empty(flat_size(&table->flat));
+}
+
+size_t size_flat_table(FlatTable *table)
+{
+	return generic_size(flat_size(&table->flat));
+}
@@ -1,16 +1,35 @@
+#include "../../allocator.h"
+#include "../../node_pool.h"
 #include "../../flist.h"
 #include "../../internals/base.h"
 #include "../../internals/flinked.h"
 
 typedef struct ForwardList
 {
-	struct NodeAlloc         alloc;
+	struct NodeAlloc        *alloc;
 	size_t                   nmemb;
 	size_t                   size;
 	struct SingleLinkedNode *before;
 	struct SingleLinkedNode *head;
+	Allocator                allocator;
 } ForwardList, FList;
 
+static FList *construct_forward_list(struct NodeAlloc *alloc, const size_t size)
+{
+	FList *flist = memory_calloc(HEAP_CONTAINER,
+	                             &alloc->allocator,
+	                             sizeof(FList));
+
+	flist->alloc     = alloc;
+	flist->size      = size;
+	flist->nmemb     = 0;
+	flist->head      = NULL;
+	flist->before    = create_sentinel_node(alloc);
+	flist->allocator = alloc->allocator;
+
+	return flist;
+}
+
 FList *create_forward_list(const size_t size)
 {
 	return create_forward_list_capacity(size, NODE_COUNT_DEFAULT);
@@ -18,31 +37,52 @@ FList *create_forward_list(const size_t size)
 
 FList *create_forward_list_capacity(size_t size, size_t init)
 {
-	FList *flist = memory_allocate_container(sizeof(FList));
+	return create_forward_list_with_allocator(size, init, (Allocator){ 0 });
+}
 
-	flist->alloc = create_node_allocator(sizeof(struct SingleLinkedNode),
-	                                     init,
-	                                     size,
-	                                     0);
+FList *create_forward_list_with_allocator(const size_t    size,
+                                          const size_t    init,
+                                          const Allocator allocator)
+{
+	struct NodeAlloc *alloc = create_shared_node_allocator(
+		sizeof(struct SingleLinkedNode),
+		init,
+		size,
+		0,
+		allocator);
+
+	return construct_forward_list(alloc, size);
+}
 
-	flist->size   = size;
-	flist->nmemb  = 0;
-	flist->head   = NULL;
-	flist->before = create_sentinel_node(&flist->alloc);
+FList *create_forward_list_with_pool(const size_t size, NodePool *pool)
+{
+	struct NodeAlloc *alloc = pool_node_allocator(
+		pool,
+		sizeof(struct SingleLinkedNode),
+		size,
+		0);
 
-	return flist;
+	return construct_forward_list(alloc, size);
 }
 
 void destroy_forward_list(FList **flist)
 {
-	destroy_node_allocator(&(*flist)->alloc);
+	clear_singly_linked((*flist)->alloc,
+	                    &(*flist)->head,
+	                    &(*flist)->before,
+	                    &(*flist)->nmemb);
 
-	memory_free_buffer((void **)flist);
+	free_node((*flist)->alloc, (*flist)->before);
+	release_node_allocator(&(*flist)->alloc);
+
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)flist,
+	                         &(*flist)->allocator);
 }
 
 void push_front_forward_list(FList *flist, const void *value)
 {
-	push_front_singly_linked(&flist->alloc,
+	push_front_singly_linked(flist->alloc,
 	                         &flist->nmemb,
 	                         flist->size,
 	                         &flist->head,
@@ -57,7 +97,7 @@ void *front_forward_list(const FList *flist)
 
 void pop_front_forward_list(FList *flist)
 {
-	pop_front_singly_linked(&flist->alloc,
+	pop_front_singly_linked(flist->alloc,
 	                        &flist->nmemb,
 	                        &flist->head,
 	                        flist->before);
@@ -65,15 +105,36 @@ void pop_front_forward_list(FList *flist)
 
 void clear_forward_list(FList *flist)
 {
-	clear_singly_linked(&flist->alloc,
+	clear_singly_linked(flist->alloc,
 	                    &flist->head,
 	                    &flist->before,
 	                    &flist->nmemb);
 }
 
+void reserve_forward_list(FList *flist, const size_t amount)
+{
+	if (amount > flist->nmemb)
+	{
+		reserve_nodes(flist->alloc, amount - flist->nmemb);
+	}
+}
+
+void shrink_to_fit_forward_list(FList *flist)
+{
+	shrink_nodes(flist->alloc);
+}
+
+void compact_forward_list(FList *flist)
+{
+	compact_singly_linked(flist->alloc,
+	                      flist->nmemb,
+	                      &flist->head,
+	                      &flist->before);
+}
+
 Iter insert_after_forward_list(FList *flist, const void *value, Iter pos)
 {
-	return insert_singly_linked(&flist->alloc,
+	return insert_singly_linked(flist->alloc,
 	                            &flist->nmemb,
 	                            flist->size,
 	                            &flist->head,
@@ -84,7 +145,7 @@ Iter insert_after_forward_list(FList *flist, const void *value, Iter pos)
 
 Iter erase_after_forward_list(FList *flist, Iter pos)
 {
-	return erase_singly_linked(&flist->alloc,
+	return erase_singly_linked(flist->alloc,
 	                           &flist->nmemb,
 	                           &flist->head,
 	                           flist->before,
@@ -1,18 +1,39 @@
+#include "../../allocator.h"
+#include "../../node_pool.h"
 #include "../../hash_set.h"
 #include "../../internals/base.h"
 #include "../../internals/hash.h"
 
 typedef struct HashSet
 {
-	struct Bucket   *buckets;
-	struct NodeAlloc alloc;
-	HashFnc          hash;
-	size_t           k_size;
-	KComp            k_comp;
-	size_t           nmemb;
-	size_t           capacity;
+	struct Bucket    *buckets;
+	struct NodeAlloc *alloc;
+	HashFnc           hash;
+	size_t            k_size;
+	KComp             k_comp;
+	size_t            nmemb;
+	size_t            capacity;
+	Allocator         allocator;
 } HashSet;
 
+static HashSet *construct_hash_set(struct NodeAlloc *alloc,
+                                   const size_t      key_size,
+                                   const KComp       kc,
+                                   const HashFnc     hash)
+{
+	HashSet *set = memory_calloc(HEAP_CONTAINER,
+	                             &alloc->allocator,
+	                             sizeof(HashSet));
+
+	set->alloc     = alloc;
+	set->hash      = hash;
+	set->k_size    = key_size;
+	set->k_comp    = kc;
+	set->allocator = alloc->allocator;
+
+	return set;
+}
+
 HashSet *create_hash_set(const size_t key_size, const KComp kc)
 {
 	return create_hash_set_ext(key_size, kc, djb2);
@@ -20,26 +41,47 @@ HashSet *create_hash_set(const size_t key_size, const KComp kc)
 
 HashSet *create_hash_set_ext(size_t key_size, KComp kc, HashFnc hash)
 {
-	HashSet *set = memory_allocate_container(sizeof(HashSet));
+	return create_hash_set_with_allocator(key_size, kc, hash, (Allocator){ 0 });
+}
 
-	set->alloc  = create_node_allocator(0, TABLE_MIN, key_size, 0);
-	set->hash   = hash;
-	set->k_size = key_size;
-	set->k_comp = kc;
+HashSet *create_hash_set_with_allocator(const size_t    key_size,
+                                        const KComp     kc,
+                                        const HashFnc   hash,
+                                        const Allocator allocator)
+{
+	struct NodeAlloc *alloc = create_shared_node_allocator(0,
+	                                                       TABLE_MIN,
+	                                                       key_size,
+	                                                       0,
+	                                                       allocator);
 
-	return set;
+	return construct_hash_set(alloc, key_size, kc, hash);
+}
+
+HashSet *create_hash_set_with_pool(const size_t  key_size,
+                                   const KComp   kc,
+                                   const HashFnc hash,
+                                   NodePool     *pool)
+{
+	struct NodeAlloc *alloc = pool_node_allocator(pool, 0, key_size, 0);
+
+	return construct_hash_set(alloc, key_size, kc, hash);
 }
 
 void destroy_hash_set(HashSet **set)
 {
-	destroy_node_allocator(&(*set)->alloc);
-	memory_free_container_generic((void **)set, (*set)->buckets);
+	hash_clear(&(*set)->buckets,
+	           (*set)->alloc,
+	           &(*set)->nmemb,
+	           &(*set)->capacity);
+	release_node_allocator(&(*set)->alloc);
+	memory_release_container(HEAP_CONTAINER, (void **)set, &(*set)->allocator);
 }
 
 void insert_hash_set(HashSet *set, const void *key)
 {
 	hash_insert(&set->buckets,
-	            &set->alloc,
+	            set->alloc,
 	            set->hash,
 	            set->k_size,
 	            0,
@@ -84,6 +126,7 @@ bool contains_hash_set(HashSet *set, const void *key)
 void erase_hash_set(HashSet *set, const void *key)
 {
 	hash_erase(&set->buckets,
+	           set->alloc,
 	           set->hash,
 	           set->k_size,
 	           set->k_comp,
@@ -94,7 +137,7 @@ void erase_hash_set(HashSet *set, const void *key)
 
 void clear_hash_set(HashSet *set)
 {
-	hash_clear(&set->buckets, &set->alloc, &set->nmemb, &set->capacity);
+	hash_clear(&set->buckets, set->alloc, &set->nmemb, &set->capacity);
 }
 
 Iter begin_hash_set(const HashSet *set)
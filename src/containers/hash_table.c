@@ -1,19 +1,42 @@
+#include "../../allocator.h"
+#include "../../node_pool.h"
 #include "../../hash_table.h"
 #include "../../internals/base.h"
 #include "../../internals/hash.h"
 
 typedef struct HashTable
 {
-	struct Bucket   *buckets;
-	struct NodeAlloc alloc;
-	HashFnc          hash;
-	KComp            k_comp;
-	size_t           k_size;
-	size_t           v_size;
-	size_t           nmemb;
-	size_t           capacity;
+	struct Bucket    *buckets;
+	struct NodeAlloc *alloc;
+	HashFnc           hash;
+	KComp             k_comp;
+	size_t            k_size;
+	size_t            v_size;
+	size_t            nmemb;
+	size_t            capacity;
+	Allocator         allocator;
 } HashTable;
 
+static HashTable *construct_hash_table(struct NodeAlloc *alloc,
+                                       const size_t      key_size,
+                                       const size_t      value_size,
+                                       const KComp       kc,
+                                       const HashFnc     hash)
+{
+	HashTable *table = memory_calloc(HEAP_CONTAINER,
+	                                 &alloc->allocator,
+	                                 sizeof(HashTable));
+
+	table->alloc     = alloc;
+	table->hash      = hash;
+	table->k_size    = key_size;
+	table->v_size    = value_size;
+	table->k_comp    = kc;
+	table->allocator = alloc->allocator;
+
+	return table;
+}
+
 HashTable *create_hash_table(const size_t key_size,
                              const size_t value_size,
                              const KComp  kc)
@@ -26,27 +49,58 @@ HashTable *create_hash_table_ext(size_t  key_size,
                                  KComp   kc,
                                  HashFnc hash)
 {
-	HashTable *table = memory_allocate_container(sizeof(HashTable));
+	return create_hash_table_with_allocator(key_size,
+	                                        value_size,
+	                                        kc,
+	                                        hash,
+	                                        (Allocator){ 0 });
+}
 
-	table->alloc  = create_node_allocator(0, TABLE_MIN, key_size, value_size);
-	table->hash   = hash;
-	table->k_size = key_size;
-	table->v_size = value_size;
-	table->k_comp = kc;
+HashTable *create_hash_table_with_allocator(const size_t    key_size,
+                                            const size_t    value_size,
+                                            const KComp     kc,
+                                            const HashFnc   hash,
+                                            const Allocator allocator)
+{
+	struct NodeAlloc *alloc = create_shared_node_allocator(0,
+	                                                       TABLE_MIN,
+	                                                       key_size,
+	                                                       value_size,
+	                                                       allocator);
 
-	return table;
+	return construct_hash_table(alloc, key_size, value_size, kc, hash);
+}
+
+HashTable *create_hash_table_with_pool(const size_t  key_size,
+                                       const size_t  value_size,
+                                       const KComp   kc,
+                                       const HashFnc hash,
+                                       NodePool     *pool)
+{
+	struct NodeAlloc *alloc = pool_node_allocator(pool,
+	                                              0,
+	                                              key_size,
+	                                              value_size);
+
+	return construct_hash_table(alloc, key_size, value_size, kc, hash);
 }
 
 void destroy_hash_table(HashTable **table)
 {
-	destroy_node_allocator(&(*table)->alloc);
-	memory_free_container_generic((void **)table, (*table)->buckets);
+	hash_clear(&(*table)->buckets,
+	           (*table)->alloc,
+	           &(*table)->nmemb,
+	           &(*table)->capacity);
+	release_node_allocator(&(*table)->alloc);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)table,
+	                         &(*table)->allocator);
 }
 
 void insert_hash_table(HashTable *table, const void *key, const void *value)
 {
 	hash_insert(&table->buckets,
-	            &table->alloc,
+	            table->alloc,
 	            table->hash,
 	            table->k_size,
 	            table->v_size,
@@ -91,6 +145,7 @@ bool contains_hash_table(HashTable *table, const void *key)
 void erase_hash_table(HashTable *table, const void *key)
 {
 	hash_erase(&table->buckets,
+	           table->alloc,
 	           table->hash,
 	           table->k_size,
 	           table->k_comp,
@@ -101,7 +156,7 @@ void erase_hash_table(HashTable *table, const void *key)
 
 void clear_hash_table(HashTable *table)
 {
-	hash_clear(&table->buckets, &table->alloc, &table->nmemb, &table->capacity);
+	hash_clear(&table->buckets, table->alloc, &table->nmemb, &table->capacity);
 }
 
 Iter begin_hash_table(const HashTable *table)
@@ -0,0 +1,152 @@
+#include "../../allocator.h"
+#include "../../interval_tree.h"
+#include "../../internals/base.h"
+#include "../../internals/itree.h"
+
+typedef struct IntervalTree
+{
+	struct NodeAlloc    *alloc;
+	size_t               e_size;
+	size_t               v_size;
+	KComp                compare;
+	size_t               nmemb;
+	struct TreeNode     *head;
+	struct IntervalOrder order;
+	Allocator            allocator;
+} IntervalTree;
+
+IntervalTree *create_interval_tree(const size_t e_size,
+                                   const size_t v_size,
+                                   const KComp  compare)
+{
+	return create_interval_tree_with_allocator(e_size,
+	                                           v_size,
+	                                           compare,
+	                                           (Allocator){ 0 });
+}
+
+IntervalTree *create_interval_tree_with_allocator(const size_t    e_size,
+                                                  const size_t    v_size,
+                                                  const KComp     compare,
+                                                  const Allocator allocator)
+{
+	IntervalTree *tree = memory_calloc(HEAP_CONTAINER,
+	                                   &allocator,
+	                                   sizeof(IntervalTree));
+
+	// each node is preceded by the Interval handed out by its iterators
+	tree->alloc     = create_shared_node_allocator(sizeof(Interval) +
+	                                                   sizeof(struct TreeNode),
+	                                               NODE_COUNT_DEFAULT,
+	                                               3 * e_size,
+	                                               v_size,
+	                                               allocator);
+	tree->e_size    = e_size;
+	tree->v_size    = v_size;
+	tree->compare   = compare;
+	tree->nmemb     = 0;
+	tree->head      = NULL;
+	tree->order     = (struct IntervalOrder){ .compare = compare,
+	                                          .e_size  = e_size };
+	tree->allocator = allocator;
+
+	return tree;
+}
+
+void destroy_interval_tree(IntervalTree **tree)
+{
+	clear_rbtree((*tree)->alloc, &(*tree)->head, &(*tree)->nmemb);
+	release_node_allocator(&(*tree)->alloc);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)tree,
+	                         &(*tree)->allocator);
+}
+
+void insert_interval(IntervalTree *tree,
+                     const void   *lo,
+                     const void   *hi,
+                     const void   *value)
+{
+	insert_itree(tree->alloc,
+	             &tree->head,
+	             lo,
+	             hi,
+	             value,
+	             tree->compare,
+	             tree->e_size,
+	             tree->v_size,
+	             &tree->nmemb);
+}
+
+bool erase_interval(IntervalTree *tree, const void *lo, const void *hi)
+{
+	return erase_itree(tree->alloc,
+	                   &tree->head,
+	                   lo,
+	                   hi,
+	                   tree->compare,
+	                   tree->e_size,
+	                   tree->v_size,
+	                   &tree->nmemb);
+}
+
+Range overlaps_interval(const IntervalTree *tree,
+                        const void         *lo,
+                        const void         *hi)
+{
+	Range range = {
+		.begin = { .type          = ITERATOR_INTERVAL,
+		           .data.interval = { .order = &tree->order,
+		                              .lo    = lo,
+		                              .hi    = hi } },
+		.end   = { .type          = ITERATOR_INTERVAL,
+		           .data.interval = { .order = &tree->order,
+		                              .lo    = lo,
+		                              .hi    = hi,
+		                              .node  = NULL } }
+	};
+
+	first_itree(tree->head, &range.begin.data.interval);
+
+	return range;
+}
+
+Range stab_interval(const IntervalTree *tree, const void *point)
+{
+	return overlaps_interval(tree, point, point);
+}
+
+void clear_interval_tree(IntervalTree *tree)
+{
+	clear_rbtree(tree->alloc, &tree->head, &tree->nmemb);
+}
+
+Iter begin_interval_tree(const IntervalTree *tree)
+{
+	struct TreeNode *node = (tree->head) ? rbt_min(tree->head) : NULL;
+	Iter iter = {
+		.type          = ITERATOR_INTERVAL,
+		.data.interval = { .order = &tree->order, .node = node }
+	};
+	return iter;
+}
+
+Iter end_interval_tree(const IntervalTree *tree)
+{
+	struct TreeNode *node = NULL;
+	Iter iter = {
+		.type          = ITERATOR_INTERVAL,
+		.data.interval = { .order = &tree->order, .node = node }
+	};
+	return iter;
+}
+
+bool empty_interval_tree(const IntervalTree *tree)
+{
+	return generic_empty(tree->nmemb);
+}
+
+size_t size_interval_tree(const IntervalTree *tree)
+{
+	return generic_size(tree->nmemb);
+}
@@ -1,16 +1,32 @@
+#include "../../allocator.h"
+#include "../../node_pool.h"
 #include "../../list.h"
 #include "../../internals/base.h"
 #include "../../internals/linked.h"
 
 typedef struct List
 {
-	struct NodeAlloc         alloc;
+	struct NodeAlloc        *alloc;
 	size_t                   nmemb;
 	size_t                   size;
 	struct DoubleLinkedNode *head;
 	struct DoubleLinkedNode *tail;
+	Allocator                allocator;
 } List;
 
+static List *construct_list(struct NodeAlloc *alloc, const size_t size)
+{
+	List *list = memory_calloc(HEAP_CONTAINER, &alloc->allocator, sizeof(List));
+
+	list->alloc     = alloc;
+	list->size      = size;
+	list->head      = NULL;
+	list->tail      = NULL;
+	list->allocator = alloc->allocator;
+
+	return list;
+}
+
 List *create_list(const size_t size)
 {
 	return create_list_capacity(size, NODE_COUNT_DEFAULT);
@@ -18,28 +34,49 @@ List *create_list(const size_t size)
 
 List *create_list_capacity(size_t size, size_t init)
 {
-	List *list = memory_allocate_container(sizeof(List));
+	return create_list_with_allocator(size, init, (Allocator){ 0 });
+}
 
-	list->alloc = create_node_allocator(sizeof(struct DoubleLinkedNode),
-	                                    init,
-	                                    size,
-	                                    0);
-	list->size  = size;
-	list->head  = NULL;
-	list->tail  = NULL;
+List *create_list_with_allocator(const size_t    size,
+                                 const size_t    init,
+                                 const Allocator allocator)
+{
+	struct NodeAlloc *alloc = create_shared_node_allocator(
+		sizeof(struct DoubleLinkedNode),
+		init,
+		size,
+		0,
+		allocator);
 
-	return list;
+	return construct_list(alloc, size);
+}
+
+List *create_list_with_pool(const size_t size, NodePool *pool)
+{
+	struct NodeAlloc *alloc = pool_node_allocator(
+		pool,
+		sizeof(struct DoubleLinkedNode),
+		size,
+		0);
+
+	return construct_list(alloc, size);
 }
 
 void destroy_list(List **list)
 {
-	destroy_node_allocator(&(*list)->alloc);
-	memory_free_buffer((void **)list);
+	clear_doubly_linked((*list)->alloc,
+	                    &(*list)->head,
+	                    &(*list)->tail,
+	                    &(*list)->nmemb);
+	release_node_allocator(&(*list)->alloc);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)list,
+	                         &(*list)->allocator);
 }
 
 void push_back_list(List *list, const void *value)
 {
-	push_back_doubly_linked(&list->alloc,
+	push_back_doubly_linked(list->alloc,
 	                        &list->nmemb,
 	                        list->size,
 	                        &list->head,
@@ -49,7 +86,7 @@ void push_back_list(List *list, const void *value)
 
 void push_front_list(List *list, const void *value)
 {
-	push_front_doubly_linked(&list->alloc,
+	push_front_doubly_linked(list->alloc,
 	                         &list->nmemb,
 	                         list->size,
 	                         &list->head,
@@ -69,22 +106,46 @@ void *back_list(const List *list)
 
 void pop_front_list(List *list)
 {
-	pop_front_doubly_linked(&list->alloc, &list->head, &list->tail);
+	pop_front_doubly_linked(list->alloc,
+	                        &list->nmemb,
+	                        &list->head,
+	                        &list->tail);
 }
 
 void pop_back_list(List *list)
 {
-	pop_back_doubly_linked(&list->alloc, &list->head, &list->tail);
+	pop_back_doubly_linked(list->alloc,
+	                       &list->nmemb,
+	                       &list->head,
+	                       &list->tail);
 }
 
 void clear_list(List *list)
 {
-	clear_doubly_linked(&list->alloc, &list->head, &list->tail, &list->nmemb);
+	clear_doubly_linked(list->alloc, &list->head, &list->tail, &list->nmemb);
+}
+
+void reserve_list(List *list, const size_t amount)
+{
+	if (amount > list->nmemb)
+	{
+		reserve_nodes(list->alloc, amount - list->nmemb);
+	}
+}
+
+void shrink_to_fit_list(List *list)
+{
+	shrink_nodes(list->alloc);
+}
+
+void compact_list(List *list)
+{
+	compact_doubly_linked(list->alloc, list->nmemb, &list->head, &list->tail);
 }
 
 Iter insert_list(List *list, const void *value, Iter pos)
 {
-	return insert_doubly_linked(&list->alloc,
+	return insert_doubly_linked(list->alloc,
 	                            &list->nmemb,
 	                            list->size,
 	                            &list->head,
@@ -95,7 +156,7 @@ Iter insert_list(List *list, const void *value, Iter pos)
 
 Iter erase_list(List *list, Iter index)
 {
-	return erase_doubly_linked(&list->alloc,
+	return erase_doubly_linked(list->alloc,
 	                           &list->nmemb,
 	                           index,
 	                           &list->head,
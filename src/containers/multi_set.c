@@ -0,0 +1,159 @@
+#include "../../allocator.h"
+#include "../../multi_set.h"
+#include "../../internals/base.h"
+#include "../../internals/rbtree.h"
+
+typedef struct MultiSet
+{
+	struct NodeAlloc *alloc;
+	size_t            size;
+	KComp             k_comp;
+	size_t            nmemb;
+	struct TreeNode  *head;
+	Allocator         allocator;
+} MultiSet;
+
+MultiSet *create_multi_set(const size_t size, const KComp compare)
+{
+	return create_multi_set_with_allocator(size, compare, (Allocator){ 0 });
+}
+
+MultiSet *create_multi_set_with_allocator(const size_t    size,
+                                          const KComp     compare,
+                                          const Allocator allocator)
+{
+	MultiSet *set = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(MultiSet));
+
+	set->alloc     = create_shared_node_allocator(sizeof(struct TreeNode),
+	                                              NODE_COUNT_DEFAULT,
+	                                              size,
+	                                              0,
+	                                              allocator);
+	set->size      = size;
+	set->k_comp    = compare;
+	set->nmemb     = 0;
+	set->head      = NULL;
+	set->allocator = allocator;
+
+	return set;
+}
+
+void destroy_multi_set(MultiSet **set)
+{
+	clear_rbtree((*set)->alloc, &(*set)->head, &(*set)->nmemb);
+	release_node_allocator(&(*set)->alloc);
+	memory_release_container(HEAP_CONTAINER, (void **)set, &(*set)->allocator);
+}
+
+void insert_multi_set(MultiSet *set, const void *key)
+{
+	insert_multi_rbtree(set->alloc,
+	                    &set->head,
+	                    key,
+	                    NULL,
+	                    set->k_comp,
+	                    set->size,
+	                    0,
+	                    &set->nmemb);
+}
+
+void insert_range_multi_set(MultiSet *set, Range range)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		insert_multi_set(set, get_range(range));
+	}
+}
+
+size_t count_multi_set(const MultiSet *set, const void *key)
+{
+	return rbt_count(set->head, key, set->k_comp);
+}
+
+void *find_multi_set(const MultiSet *set, const void *key)
+{
+	return rbt_first_k(set->head, key, set->k_comp);
+}
+
+bool contains_multi_set(const MultiSet *set, const void *key)
+{
+	return find_multi_set(set, key) ? true : false;
+}
+
+Range equal_range_multi_set(const MultiSet *set, const void *key)
+{
+	struct TreeNode *lower = rbt_lower_bound(set->head, key, set->k_comp);
+	struct TreeNode *upper = rbt_upper_bound(set->head, key, set->k_comp);
+	Range range = {
+		.begin = { .type = ITERATOR_SET, .data.balanced = { .node = lower } },
+		.end   = { .type = ITERATOR_SET, .data.balanced = { .node = upper } }
+	};
+	return range;
+}
+
+void erase_one_multi_set(MultiSet *set, const void *key)
+{
+	delete_first_rbtree(set->alloc,
+	                    &set->head,
+	                    key,
+	                    set->k_comp,
+	                    set->size,
+	                    0,
+	                    &set->nmemb);
+}
+
+size_t erase_all_multi_set(MultiSet *set, const void *key)
+{
+	return delete_equal_rbtree(set->alloc,
+	                           &set->head,
+	                           key,
+	                           set->k_comp,
+	                           &set->nmemb);
+}
+
+void clear_multi_set(MultiSet *set)
+{
+	clear_rbtree(set->alloc, &set->head, &set->nmemb);
+}
+
+Iter begin_multi_set(const MultiSet *set)
+{
+	struct TreeNode *node = rbt_min(set->head);
+	Iter iter = { .type = ITERATOR_SET, .data.balanced = { .node = node } };
+	return iter;
+}
+
+Iter end_multi_set(const MultiSet *)
+{
+	struct TreeNode *node = NULL;
+	Iter iter = { .type = ITERATOR_SET, .data.balanced = { .node = node } };
+	return iter;
+}
+
+Iter rbegin_multi_set(const MultiSet *set)
+{
+	struct TreeNode *node = rbt_max(set->head);
+	Iter iter = { .type = ITERATOR_SET, .data.balanced = { .node = node } };
+	return iter;
+}
+
+Iter rend_multi_set(const MultiSet *)
+{
+	struct TreeNode *node = NULL;
+	Iter iter = { .type = ITERATOR_SET, .data.balanced = { .node = node } };
+	return iter;
+}
+
+bool empty_multi_set(const MultiSet *set)
+{
+	return generic_empty(set->nmemb);
+}
+
+size_t size_multi_set(const MultiSet *set)
+{
+	return generic_size(set->nmemb);
+}
@@ -0,0 +1,178 @@
+#include "../../allocator.h"
+#include "../../multi_table.h"
+#include "../../internals/base.h"
+#include "../../internals/rbtree.h"
+
+typedef struct MultiTable
+{
+	struct NodeAlloc *alloc;
+	size_t            k_size;
+	size_t            v_size;
+	KComp             k_comp;
+	size_t            nmemb;
+	struct TreeNode  *head;
+	Allocator         allocator;
+} MultiTable;
+
+MultiTable *create_multi_table(const size_t k_size,
+                               const size_t v_size,
+                               const KComp  compare)
+{
+	return create_multi_table_with_allocator(k_size,
+	                                         v_size,
+	                                         compare,
+	                                         (Allocator){ 0 });
+}
+
+MultiTable *create_multi_table_with_allocator(const size_t    k_size,
+                                              const size_t    v_size,
+                                              const KComp     compare,
+                                              const Allocator allocator)
+{
+	MultiTable *table = memory_calloc(HEAP_CONTAINER,
+	                                  &allocator,
+	                                  sizeof(MultiTable));
+
+	table->alloc     = create_shared_node_allocator(sizeof(PairKV) +
+	                                                    sizeof(struct TreeNode),
+	                                                NODE_COUNT_DEFAULT,
+	                                                k_size,
+	                                                v_size,
+	                                                allocator);
+	table->k_size    = k_size;
+	table->v_size    = v_size;
+	table->k_comp    = compare;
+	table->nmemb     = 0;
+	table->head      = NULL;
+	table->allocator = allocator;
+
+	return table;
+}
+
+void destroy_multi_table(MultiTable **table)
+{
+	clear_rbtree((*table)->alloc, &(*table)->head, &(*table)->nmemb);
+	release_node_allocator(&(*table)->alloc);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)table,
+	                         &(*table)->allocator);
+}
+
+void insert_multi_table(MultiTable *table, const void *key, const void *value)
+{
+	insert_multi_rbtree(table->alloc,
+	                    &table->head,
+	                    key,
+	                    value,
+	                    table->k_comp,
+	                    table->k_size,
+	                    table->v_size,
+	                    &table->nmemb);
+}
+
+void insert_range_multi_table(MultiTable *table, Range range)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		PairKV *pair = get_range(range);
+
+		insert_multi_table(table, pair->key, pair->value);
+	}
+}
+
+size_t count_multi_table(const MultiTable *table, const void *key)
+{
+	return rbt_count(table->head, key, table->k_comp);
+}
+
+void *find_multi_table(const MultiTable *table, const void *key)
+{
+	return rbt_first_v(table->head,
+	                   key,
+	                   table->k_comp,
+	                   table->k_size,
+	                   table->v_size);
+}
+
+bool contains_multi_table(const MultiTable *table, const void *key)
+{
+	return rbt_first_k(table->head, key, table->k_comp) ? true : false;
+}
+
+Range equal_range_multi_table(const MultiTable *table, const void *key)
+{
+	struct TreeNode *lower = rbt_lower_bound(table->head, key, table->k_comp);
+	struct TreeNode *upper = rbt_upper_bound(table->head, key, table->k_comp);
+	Range range = {
+		.begin = { .type = ITERATOR_TABLE, .data.balanced = { .node = lower } },
+		.end   = { .type = ITERATOR_TABLE, .data.balanced = { .node = upper } }
+	};
+	return range;
+}
+
+void erase_one_multi_table(MultiTable *table, const void *key)
+{
+	delete_first_rbtree(table->alloc,
+	                    &table->head,
+	                    key,
+	                    table->k_comp,
+	                    table->k_size,
+	                    table->v_size,
+	                    &table->nmemb);
+}
+
+size_t erase_all_multi_table(MultiTable *table, const void *key)
+{
+	return delete_equal_rbtree(table->alloc,
+	                           &table->head,
+	                           key,
+	                           table->k_comp,
+	                           &table->nmemb);
+}
+
+void clear_multi_table(MultiTable *table)
+{
+	clear_rbtree(table->alloc, &table->head, &table->nmemb);
+}
+
+Iter begin_multi_table(const MultiTable *table)
+{
+	struct TreeNode *node = rbt_min(table->head);
+	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
+	return iter;
+}
+
+Iter end_multi_table(const MultiTable *)
+{
+	struct TreeNode *node = NULL;
+	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
+	return iter;
+}
+
+Iter rbegin_multi_table(const MultiTable *table)
+{
+	struct TreeNode *node = rbt_max(table->head);
+	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
+	return iter;
+}
+
+Iter rend_multi_table(const MultiTable *)
+{
+	struct TreeNode *node = NULL;
+	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
+	return iter;
+}
+
+bool empty_multi_table(const MultiTable *table)
+{
+	return generic_empty(table->nmemb);
+}
+
+size_t size_multi_table(const MultiTable *table)
+{
+	return generic_size(table->nmemb);
+}
@@ -1,3 +1,4 @@
+#include "../../allocator.h"
 #include "../../pqueue.h"
 #include "../../internals/base.h"
 #include "../../internals/bheap.h"
@@ -10,26 +11,40 @@ typedef struct PriorityQueue
 	size_t      nmemb;
 	size_t      size;
 	CompareFunc fnc;
+	Allocator   allocator;
 } PriorityQueue;
 
 PriorityQueue *create_pqueue(const size_t size, const CompareFunc comparator)
 {
-	PriorityQueue *pqueue = memory_allocate_container(sizeof(PriorityQueue));
+	return create_pqueue_with_allocator(size, comparator, (Allocator){ 0 });
+}
+
+PriorityQueue *create_pqueue_with_allocator(const size_t      size,
+                                            const CompareFunc comparator,
+                                            const Allocator   allocator)
+{
+	PriorityQueue *pqueue = memory_calloc(HEAP_CONTAINER,
+	                                      &allocator,
+	                                      sizeof(PriorityQueue));
 
-	pqueue->fnc  = comparator;
-	pqueue->size = size;
+	pqueue->fnc       = comparator;
+	pqueue->size      = size;
+	pqueue->allocator = allocator;
 
 	return pqueue;
 }
 
 void destroy_pqueue(PriorityQueue **pqueue)
 {
-	memory_free_container_generic((void **)pqueue, (*pqueue)->array);
+	memory_free_container_generic((void **)pqueue,
+	                              (*pqueue)->array,
+	                              &(*pqueue)->allocator);
 }
 
 void push_pqueue(PriorityQueue *pqueue, const void *value)
 {
-	generic_mempool_push_back(&pqueue->array,
+	generic_mempool_push_back(&pqueue->allocator,
+	                          &pqueue->array,
 	                          value,
 	                          &pqueue->capacity,
 	                          &pqueue->nmemb,
@@ -40,7 +55,8 @@ void push_pqueue(PriorityQueue *pqueue, const void *value)
 
 void push_range_pqueue(PQueue *pqueue, Range range)
 {
-	generic_mempool_range_insert(&pqueue->array,
+	generic_mempool_range_insert(&pqueue->allocator,
+	                             &pqueue->array,
 	                             pqueue->nmemb,
 	                             &pqueue->capacity,
 	                             &pqueue->nmemb,
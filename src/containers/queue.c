@@ -1,3 +1,4 @@
+#include "../../allocator.h"
 #include "../../queue.h"
 #include "../../internals/base.h"
 #include "../../internals/deq.h"
@@ -15,13 +16,18 @@ typedef struct Queue
 
 Queue *create_queue(const size_t size)
 {
-	Queue *queue = memory_allocate_container(sizeof(Queue));
+	return create_queue_with_allocator(size, (Allocator){ 0 });
+}
+
+Queue *create_queue_with_allocator(const size_t size, const Allocator allocator)
+{
+	Queue *queue = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(Queue));
 
 	const size_t array_size = minimum_array_size(size);
 	const size_t capacity   = array_size / size;
 	const size_t init_index = capacity / 2;
 
-	queue->control = create_control_array(capacity, size);
+	queue->control = create_control_array(capacity, size, allocator);
 	queue->arr_cap = capacity;
 	queue->size    = size;
 	queue->front   = init_index;
@@ -33,7 +39,9 @@ Queue *create_queue(const size_t size)
 void destroy_queue(Queue **queue)
 {
 	destroy_control_array(&(*queue)->control, (*queue)->front);
-	memory_free_buffer((void **)queue);
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)queue,
+	                         &(*queue)->control.allocator);
 }
 
 void push_queue(Queue *queue, const void *value)
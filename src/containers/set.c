@@ -1,42 +1,90 @@
+#include "../../allocator.h"
+#include "../../node_pool.h"
 #include "../../set.h"
 #include "../../internals/base.h"
+#include "../../internals/cassert.h"
 #include "../../internals/rbtree.h"
 
+// keys looked up per batched search, bounding the stack buffer of results
+#define BATCH_SIZE 64
+
 typedef struct Set
 {
-	struct NodeAlloc alloc;
-	size_t           size;
-	KComp            k_comp;
-	size_t           nmemb;
-	struct TreeNode *head;
+	struct NodeAlloc *alloc;
+	size_t            size;
+	KComp             k_comp;
+	size_t            nmemb;
+	struct TreeNode  *head;
+	struct TreeEdges  edges;
+	Allocator         allocator;
 } Set;
 
+static Set *construct_set(struct NodeAlloc *alloc,
+                          const size_t      size,
+                          const KComp       compare)
+{
+	Set *set = memory_calloc(HEAP_CONTAINER, &alloc->allocator, sizeof(Set));
+
+	set->alloc     = alloc;
+	set->size      = size;
+	set->k_comp    = compare;
+	set->nmemb     = 0;
+	set->head      = NULL;
+	set->edges     = (struct TreeEdges){ .min = NULL, .max = NULL };
+	set->allocator = alloc->allocator;
+
+	return set;
+}
+
 Set *create_set(const size_t size, const KComp compare)
 {
-	Set *set = memory_allocate_container(sizeof(Set));
+	return create_set_with_allocator(size, compare, (Allocator){ 0 });
+}
+
+Set *create_set_with_allocator(const size_t    size,
+                               const KComp     compare,
+                               const Allocator allocator)
+{
+	struct NodeAlloc *alloc = create_shared_node_allocator(
+		sizeof(struct TreeNode),
+		NODE_COUNT_DEFAULT,
+		size,
+		0,
+		allocator);
 
-	set->alloc = create_node_allocator(sizeof(struct TreeNode),
-	                                   NODE_COUNT_DEFAULT,
-	                                   size,
-	                                   0);
+	return construct_set(alloc, size, compare);
+}
 
-	set->size   = size;
-	set->k_comp = compare;
-	set->nmemb  = 0;
-	set->head   = NULL;
+Set *create_set_with_pool(const size_t size,
+                          const KComp  compare,
+                          NodePool    *pool)
+{
+	struct NodeAlloc *alloc = pool_node_allocator(pool,
+	                                              sizeof(struct TreeNode),
+	                                              size,
+	                                              0);
 
-	return set;
+	return construct_set(alloc, size, compare);
 }
 
 void destroy_set(Set **set)
 {
-	destroy_node_allocator(&(*set)->alloc);
-	memory_free_buffer((void **)set);
+	clear_rbtree((*set)->alloc, &(*set)->head, &(*set)->nmemb);
+	release_node_allocator(&(*set)->alloc);
+	memory_release_container(HEAP_CONTAINER, (void **)set, &(*set)->allocator);
+}
+
+// any change other than a hinted insert may move or free the remembered edges
+static void forget_edges(Set *set)
+{
+	set->edges = (struct TreeEdges){ .min = NULL, .max = NULL };
 }
 
 void insert_set(Set *set, const void *key)
 {
-	insert_rbtree(&set->alloc,
+	forget_edges(set);
+
+	insert_rbtree(set->alloc,
 	              &set->head,
 	              key,
 	              NULL,
@@ -46,9 +94,27 @@ void insert_set(Set *set, const void *key)
 	              &set->nmemb);
 }
 
+Iter insert_hint_set(Set *set, const Iter hint, const void *key)
+{
+	struct TreeNode *node = insert_hint_rbtree(set->alloc,
+	                                           &set->head,
+	                                           hint.data.balanced.node,
+	                                           &set->edges,
+	                                           key,
+	                                           NULL,
+	                                           set->k_comp,
+	                                           set->size,
+	                                           0,
+	                                           &set->nmemb);
+	Iter iter = { .type = ITERATOR_SET, .data.balanced = { .node = node } };
+	return iter;
+}
+
 void insert_range_set(Set *set, Range range)
 {
-	insert_range_rbtree_set(&set->alloc,
+	forget_edges(set);
+
+	insert_range_rbtree_set(set->alloc,
 	                        &set->head,
 	                        range,
 	                        set->k_comp,
@@ -71,14 +137,141 @@ bool contains_set(const Set *set, const void *key)
 	return rbt_search_k(set->head, key, set->k_comp) ? true : false;
 }
 
+void contains_many_set(const Set   *set,
+                       const void  *keys,
+                       const size_t n,
+                       bool        *out)
+{
+	void *found[BATCH_SIZE];
+
+	for (size_t i = 0; i < n; i += BATCH_SIZE)
+	{
+		const size_t count = (n - i < BATCH_SIZE) ? n - i : BATCH_SIZE;
+
+		rbt_search_many_k(set->head,
+		                  keys + i * set->size,
+		                  count,
+		                  set->k_comp,
+		                  set->size,
+		                  found);
+
+		for (size_t j = 0; j < count; j++)
+		{
+			out[i + j] = found[j] ? true : false;
+		}
+	}
+}
+
 void erase_set(Set *set, const void *key)
 {
-	delete_rbtree(&set->alloc, &set->head, key, set->k_comp, &set->nmemb);
+	forget_edges(set);
+
+	delete_rbtree(set->alloc,
+	              &set->head,
+	              key,
+	              set->k_comp,
+	              set->size,
+	              0,
+	              &set->nmemb);
 }
 
 void clear_set(Set *set)
 {
-	clear_rbtree(&set->alloc, &set->head, &set->nmemb);
+	forget_edges(set);
+
+	clear_rbtree(set->alloc, &set->head, &set->nmemb);
+}
+
+void compact_set(Set *set)
+{
+	forget_edges(set);
+
+	compact_rbtree(set->alloc, &set->head, set->nmemb);
+}
+
+void erase_range_set(Set *set, const void *lo, const void *hi)
+{
+	forget_edges(set);
+
+	erase_range_rbtree(set->alloc,
+	                   &set->head,
+	                   lo,
+	                   hi,
+	                   set->k_comp,
+	                   set->size,
+	                   0,
+	                   &set->nmemb);
+}
+
+void split_set(Set *set, const void *key, Set **left, Set **right)
+{
+	*left  = construct_set(acquire_node_allocator(set->alloc),
+	                       set->size,
+	                       set->k_comp);
+	*right = construct_set(acquire_node_allocator(set->alloc),
+	                       set->size,
+	                       set->k_comp);
+
+	forget_edges(set);
+
+	(*left)->head  = set->head;
+	(*left)->nmemb = set->nmemb;
+	set->head      = NULL;
+	set->nmemb     = 0;
+
+	split_rbtree(&(*left)->head,
+	             &(*right)->head,
+	             key,
+	             set->k_comp,
+	             &(*left)->nmemb,
+	             &(*right)->nmemb);
+}
+
+void join_set(Set *set, Set *other)
+{
+	CHEAP_ASSERT(set != other, "Cannot join a set with itself.");
+	CHEAP_ASSERT(set->size == other->size, "Sets must hold the same key type.");
+
+	forget_edges(set);
+	forget_edges(other);
+
+	// nodes can only change tree if this set's allocator can take ownership
+	// of them, otherwise they are copied
+	const bool movable = set->alloc == other->alloc ||
+	                     !shared_node_allocator(other->alloc);
+
+	if (movable && disjoint_rbtree(set->head, other->head, set->k_comp))
+	{
+		if (set->alloc != other->alloc)
+		{
+			merge_node_allocator(set->alloc, other->alloc);
+			release_node_allocator(&other->alloc);
+
+			other->alloc = acquire_node_allocator(set->alloc);
+		}
+
+		join_rbtree(set->alloc,
+		            &set->head,
+		            other->head,
+		            set->k_comp,
+		            &set->nmemb,
+		            other->nmemb);
+
+		other->head  = NULL;
+		other->nmemb = 0;
+	}
+	else
+	{
+		merge_rbtree(set->alloc,
+		             &set->head,
+		             other->head,
+		             set->k_comp,
+		             set->size,
+		             0,
+		             &set->nmemb);
+
+		clear_rbtree(other->alloc, &other->head, &other->nmemb);
+	}
 }
 
 Iter begin_set(const Set *set)
@@ -1,32 +1,43 @@
+#include "../../allocator.h"
 #include "../../stack.h"
 #include "../../internals/base.h"
 #include "../../internals/mpool.h"
 
 typedef struct Stack
 {
-	void  *array;
-	size_t capacity;
-	size_t nmemb;
-	size_t size;
+	void     *array;
+	size_t    capacity;
+	size_t    nmemb;
+	size_t    size;
+	Allocator allocator;
 } Stack;
 
 Stack *create_stack(const size_t size)
 {
-	Stack *stack = memory_allocate_container(sizeof(Stack));
+	return create_stack_with_allocator(size, (Allocator){ 0 });
+}
+
+Stack *create_stack_with_allocator(const size_t size, const Allocator allocator)
+{
+	Stack *stack = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(Stack));
 
-	stack->size = size;
+	stack->size      = size;
+	stack->allocator = allocator;
 
 	return stack;
 }
 
 void destroy_stack(Stack **stack)
 {
-	memory_free_container_generic((void **)stack, (*stack)->array);
+	memory_free_container_generic((void **)stack,
+	                              (*stack)->array,
+	                              &(*stack)->allocator);
 }
 
 void push_stack(Stack *stack, const void *value)
 {
-	generic_mempool_push_back(&stack->array,
+	generic_mempool_push_back(&stack->allocator,
+	                          &stack->array,
 	                          value,
 	                          &stack->capacity,
 	                          &stack->nmemb,
@@ -35,7 +46,8 @@ void push_stack(Stack *stack, const void *value)
 
 void push_range_stack(Stack *stack, Range range)
 {
-	generic_mempool_range_insert(&stack->array,
+	generic_mempool_range_insert(&stack->allocator,
+	                             &stack->array,
 	                             stack->nmemb,
 	                             &stack->capacity,
 	                             &stack->nmemb,
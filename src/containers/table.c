@@ -1,47 +1,144 @@
+#include "../../allocator.h"
+#include "../../node_pool.h"
 #include "../../table.h"
 #include "../../internals/base.h"
+#include "../../internals/cassert.h"
 #include "../../internals/rbtree.h"
 #include "../../iter.h"
 
 typedef struct Table
 {
-	struct NodeAlloc alloc;
-	size_t           k_size;
-	size_t           v_size;
-	KComp            k_comp;
-	size_t           nmemb;
-	struct TreeNode *head;
+	struct NodeAlloc    *alloc;
+	size_t               k_size;
+	size_t               v_size;
+	KComp                k_comp;
+	size_t               nmemb;
+	struct TreeNode     *head;
+	struct TreeSnapshot *snapshot;
+	struct TreeEdges     edges;
+	Allocator            allocator;
 } Table;
 
+// snapshots have no node allocator of their own, so the allocator is separate
+static Table *construct_table(struct NodeAlloc *alloc,
+                              const Allocator   allocator,
+                              const size_t      k_size,
+                              const size_t      v_size,
+                              const KComp       compare)
+{
+	Table *table = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(Table));
+
+	table->alloc     = alloc;
+	table->k_size    = k_size;
+	table->v_size    = v_size;
+	table->k_comp    = compare;
+	table->nmemb     = 0;
+	table->head      = NULL;
+	table->snapshot  = NULL;
+	table->edges     = (struct TreeEdges){ .min = NULL, .max = NULL };
+	table->allocator = allocator;
+
+	return table;
+}
+
 Table *create_table(const size_t k_size,
                     const size_t v_size,
                     const KComp  compare)
 {
-	Table *table = memory_allocate_container(sizeof(Table));
+	return create_table_with_allocator(k_size,
+	                                   v_size,
+	                                   compare,
+	                                   (Allocator){ 0 });
+}
 
-	table->alloc = create_node_allocator(sizeof(struct TreeNode),
-	                                     NODE_COUNT_DEFAULT,
-	                                     k_size,
-	                                     v_size);
+Table *create_table_with_allocator(const size_t    k_size,
+                                   const size_t    v_size,
+                                   const KComp     compare,
+                                   const Allocator allocator)
+{
+	struct NodeAlloc *alloc = create_shared_node_allocator(
+		sizeof(PairKV) + sizeof(struct TreeNode),
+		NODE_COUNT_DEFAULT,
+		k_size,
+		v_size,
+		allocator);
 
-	table->k_size = k_size;
-	table->v_size = v_size;
-	table->k_comp = compare;
-	table->nmemb  = 0;
-	table->head   = NULL;
+	return construct_table(alloc, allocator, k_size, v_size, compare);
+}
 
-	return table;
+Table *create_table_with_pool(const size_t k_size,
+                              const size_t v_size,
+                              const KComp  compare,
+                              NodePool    *pool)
+{
+	struct NodeAlloc *alloc = pool_node_allocator(pool,
+	                                              sizeof(PairKV) +
+	                                                  sizeof(struct TreeNode),
+	                                              k_size,
+	                                              v_size);
+
+	return construct_table(alloc,
+	                       alloc->allocator,
+	                       k_size,
+	                       v_size,
+	                       compare);
 }
 
 void destroy_table(Table **table)
 {
-	destroy_node_allocator(&(*table)->alloc);
-	memory_free_buffer((void **)table);
+	if ((*table)->snapshot)
+	{
+		// only marks the epoch closed, the live table frees what it retired
+		release_rbtree_snapshot(&(*table)->snapshot);
+	}
+	else
+	{
+		clear_rbtree((*table)->alloc, &(*table)->head, &(*table)->nmemb);
+
+		CHEAP_ASSERT(shared_node_allocator((*table)->alloc) ||
+		                 !live_node_epochs((*table)->alloc),
+		             "Snapshots must be destroyed before the table.");
+
+		release_node_allocator(&(*table)->alloc);
+	}
+
+	memory_release_container(HEAP_CONTAINER,
+	                         (void **)table,
+	                         &(*table)->allocator);
+}
+
+Table *snapshot_table(Table *table)
+{
+	CHEAP_ASSERT(!table->snapshot, "Cannot take a snapshot of a snapshot.");
+
+	Table *snapshot = construct_table(NULL,
+	                                  table->allocator,
+	                                  table->k_size,
+	                                  table->v_size,
+	                                  table->k_comp);
+
+	snapshot->nmemb    = table->nmemb;
+	snapshot->head     = table->head;
+	snapshot->snapshot = snapshot_rbtree(table->alloc,
+	                                     table->head,
+	                                     table->k_comp);
+
+	return snapshot;
+}
+
+// any change other than a hinted insert may move or free the remembered edges
+static void forget_edges(Table *table)
+{
+	table->edges = (struct TreeEdges){ .min = NULL, .max = NULL };
 }
 
 void insert_table(Table *table, const void *key, const void *value)
 {
-	insert_rbtree(&table->alloc,
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+
+	insert_rbtree(table->alloc,
 	              &table->head,
 	              key,
 	              value,
@@ -51,9 +148,34 @@ void insert_table(Table *table, const void *key, const void *value)
 	              &table->nmemb);
 }
 
+Iter insert_hint_table(Table      *table,
+                       const Iter  hint,
+                       const void *key,
+                       const void *value)
+{
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	struct TreeNode *node = insert_hint_rbtree(table->alloc,
+	                                           &table->head,
+	                                           hint.data.balanced.node,
+	                                           &table->edges,
+	                                           key,
+	                                           value,
+	                                           table->k_comp,
+	                                           table->k_size,
+	                                           table->v_size,
+	                                           &table->nmemb);
+	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
+	return iter;
+}
+
 void insert_range_table(Table *table, Range range)
 {
-	insert_range_rbtree_table(&table->alloc,
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+
+	insert_range_rbtree_table(table->alloc,
 	                          &table->head,
 	                          range,
 	                          table->k_comp,
@@ -64,43 +186,218 @@ void insert_range_table(Table *table, Range range)
 
 size_t count_table(const Table *table, const void *key)
 {
-	return (rbt_search_v(table->head, key, table->k_comp)) ? 1 : 0;
+	return (rbt_search_k(table->head, key, table->k_comp)) ? 1 : 0;
 }
 
 void *find_table(const Table *table, const void *key)
 {
-	return rbt_search_v(table->head, key, table->k_comp);
+	return rbt_search_v(table->head,
+	                    key,
+	                    table->k_comp,
+	                    table->k_size,
+	                    table->v_size);
 }
 
 bool contains_table(const Table *table, const void *key)
 {
-	return rbt_search_v(table->head, key, table->k_comp) ? true : false;
+	return rbt_search_k(table->head, key, table->k_comp) ? true : false;
+}
+
+void find_many_table(const Table *table,
+                     const void  *keys,
+                     const size_t n,
+                     void       **out)
+{
+	rbt_search_many_v(table->head,
+	                  keys,
+	                  n,
+	                  table->k_comp,
+	                  table->k_size,
+	                  table->v_size,
+	                  out);
 }
 
 void erase_table(Table *table, const void *key)
 {
-	delete_rbtree(&table->alloc,
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+
+	delete_rbtree(table->alloc,
 	              &table->head,
 	              key,
 	              table->k_comp,
+	              table->k_size,
+	              table->v_size,
 	              &table->nmemb);
 }
 
 void clear_table(Table *table)
 {
-	clear_rbtree(&table->alloc, &table->head, &table->nmemb);
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+
+	clear_rbtree(table->alloc, &table->head, &table->nmemb);
+}
+
+void compact_table(Table *table)
+{
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+
+	compact_rbtree(table->alloc, &table->head, table->nmemb);
+}
+
+void erase_range_table(Table *table, const void *lo, const void *hi)
+{
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+
+	erase_range_rbtree(table->alloc,
+	                   &table->head,
+	                   lo,
+	                   hi,
+	                   table->k_comp,
+	                   table->k_size,
+	                   table->v_size,
+	                   &table->nmemb);
+}
+
+void split_table(Table *table, const void *key, Table **left, Table **right)
+{
+	CHEAP_ASSERT(!table->snapshot, "Cannot modify a table snapshot.");
+
+	*left  = construct_table(acquire_node_allocator(table->alloc),
+	                         table->allocator,
+	                         table->k_size,
+	                         table->v_size,
+	                         table->k_comp);
+	*right = construct_table(acquire_node_allocator(table->alloc),
+	                         table->allocator,
+	                         table->k_size,
+	                         table->v_size,
+	                         table->k_comp);
+
+	forget_edges(table);
+
+	collect_node_epochs(table->alloc);
+
+	// snapshots still read the nodes of the table, so the pairs are copied
+	// into nodes no snapshot can reach and the originals retired
+	if (live_node_epochs(table->alloc))
+	{
+		merge_rbtree(table->alloc,
+		             &(*left)->head,
+		             table->head,
+		             table->k_comp,
+		             table->k_size,
+		             table->v_size,
+		             &(*left)->nmemb);
+
+		clear_rbtree(table->alloc, &table->head, &table->nmemb);
+	}
+	else
+	{
+		(*left)->head  = table->head;
+		(*left)->nmemb = table->nmemb;
+		table->head    = NULL;
+		table->nmemb   = 0;
+	}
+
+	split_rbtree(&(*left)->head,
+	             &(*right)->head,
+	             key,
+	             table->k_comp,
+	             &(*left)->nmemb,
+	             &(*right)->nmemb);
+}
+
+void join_table(Table *table, Table *other)
+{
+	CHEAP_ASSERT(table != other, "Cannot join a table with itself.");
+	CHEAP_ASSERT(table->k_size == other->k_size &&
+	                 table->v_size == other->v_size,
+	             "Tables must hold the same key and value types.");
+	CHEAP_ASSERT(!table->snapshot && !other->snapshot,
+	             "Cannot modify a table snapshot.");
+
+	forget_edges(table);
+	forget_edges(other);
+
+	collect_node_epochs(table->alloc);
+	collect_node_epochs(other->alloc);
+
+	// nodes can only change tree if this table's allocator can take
+	// ownership of them and no snapshot reads them, otherwise they are copied
+	const bool movable = (table->alloc == other->alloc ||
+	                      !shared_node_allocator(other->alloc)) &&
+	                     !live_node_epochs(table->alloc) &&
+	                     !live_node_epochs(other->alloc);
+
+	if (movable && disjoint_rbtree(table->head, other->head, table->k_comp))
+	{
+		if (table->alloc != other->alloc)
+		{
+			merge_node_allocator(table->alloc, other->alloc);
+			release_node_allocator(&other->alloc);
+
+			other->alloc = acquire_node_allocator(table->alloc);
+		}
+
+		join_rbtree(table->alloc,
+		            &table->head,
+		            other->head,
+		            table->k_comp,
+		            &table->nmemb,
+		            other->nmemb);
+
+		other->head  = NULL;
+		other->nmemb = 0;
+	}
+	else
+	{
+		merge_rbtree(table->alloc,
+		             &table->head,
+		             other->head,
+		             table->k_comp,
+		             table->k_size,
+		             table->v_size,
+		             &table->nmemb);
+
+		clear_rbtree(other->alloc, &other->head, &other->nmemb);
+	}
+}
+
+static Iter snapshot_iter(const Table *table, struct TreeNode *node)
+{
+	Iter iter = {
+		.type          = ITERATOR_TABLE_SNAPSHOT,
+		.data.snapshot = { .snapshot = table->snapshot, .node = node }
+	};
+	return iter;
 }
 
 Iter begin_table(const Table *table)
 {
 	struct TreeNode *node = rbt_min(table->head);
+	if (table->snapshot)
+	{
+		return snapshot_iter(table, node);
+	}
 	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
 	return iter;
 }
 
-Iter end_table(const Table *)
+Iter end_table(const Table *table)
 {
 	struct TreeNode *node = NULL;
+	if (table->snapshot)
+	{
+		return snapshot_iter(table, node);
+	}
 	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
 	return iter;
 }
@@ -108,13 +405,21 @@ Iter end_table(const Table *)
 Iter rbegin_table(const Table *table)
 {
 	struct TreeNode *node = rbt_max(table->head);
+	if (table->snapshot)
+	{
+		return snapshot_iter(table, node);
+	}
 	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
 	return iter;
 }
 
-Iter rend_table(const Table *)
+Iter rend_table(const Table *table)
 {
 	struct TreeNode *node = NULL;
+	if (table->snapshot)
+	{
+		return snapshot_iter(table, node);
+	}
 	Iter iter = { .type = ITERATOR_TABLE, .data.balanced = { .node = node } };
 	return iter;
 }
@@ -1,3 +1,4 @@
+#include "../../allocator.h"
 #include "../../vector.h"
 #include "../../internals/base.h"
 #include "../../internals/mpool.h"
@@ -5,29 +6,40 @@
 
 typedef struct Vector
 {
-	void  *array;
-	size_t capacity;
-	size_t nmemb;
-	size_t size;
+	void     *array;
+	size_t    capacity;
+	size_t    nmemb;
+	size_t    size;
+	Allocator allocator;
 } Vector;
 
 Vector *create_vector(size_t size)
 {
-	Vector *vector = memory_allocate_container(sizeof(Vector));
+	return create_vector_with_allocator(size, (Allocator){ 0 });
+}
+
+Vector *create_vector_with_allocator(const size_t    size,
+                                     const Allocator allocator)
+{
+	Vector *vector = memory_calloc(HEAP_CONTAINER, &allocator, sizeof(Vector));
 
-	vector->size = size;
+	vector->size      = size;
+	vector->allocator = allocator;
 
 	return vector;
 }
 
 void destroy_vector(Vector **vector)
 {
-	memory_free_container_generic((void **)vector, (*vector)->array);
+	memory_free_container_generic((void **)vector,
+	                              (*vector)->array,
+	                              &(*vector)->allocator);
 }
 
 void push_back_vector(Vector *vector, const void *value)
 {
-	generic_mempool_push_back(&vector->array,
+	generic_mempool_push_back(&vector->allocator,
+	                          &vector->array,
 	                          value,
 	                          &vector->capacity,
 	                          &vector->nmemb,
@@ -36,7 +48,8 @@ void push_back_vector(Vector *vector, const void *value)
 
 void insert_vector(Vector *vector, const void *value, const size_t index)
 {
-	generic_mempool_insert(&vector->array,
+	generic_mempool_insert(&vector->allocator,
+	                       &vector->array,
 	                       value,
 	                       index,
 	                       &vector->capacity,
@@ -46,7 +59,8 @@ void insert_vector(Vector *vector, const void *value, const size_t index)
 
 void push_back_range_vector(Vector *vector, const Range range)
 {
-	generic_mempool_range_insert(&vector->array,
+	generic_mempool_range_insert(&vector->allocator,
+	                             &vector->array,
 	                             vector->nmemb,
 	                             &vector->capacity,
 	                             &vector->nmemb,
@@ -56,7 +70,8 @@ void push_back_range_vector(Vector *vector, const Range range)
 
 void insert_range_vector(Vector *vector, const size_t index, const Range range)
 {
-	generic_mempool_range_insert(&vector->array,
+	generic_mempool_range_insert(&vector->allocator,
+	                             &vector->array,
 	                             index,
 	                             &vector->capacity,
 	                             &vector->nmemb,
@@ -168,7 +183,8 @@ size_t capacity_vector(const Vector *vector)
 
 void reserve_vector(Vector *vector, const size_t amount)
 {
-	generic_mempool_reserve(&vector->array,
+	generic_mempool_reserve(&vector->allocator,
+	                        &vector->array,
 	                        &vector->capacity,
 	                        vector->size,
 	                        amount);
@@ -176,7 +192,8 @@ void reserve_vector(Vector *vector, const size_t amount)
 
 void shrink_to_fit_vector(Vector *vector)
 {
-	generic_mempool_shrink_to_fit(&vector->array,
+	generic_mempool_shrink_to_fit(&vector->allocator,
+	                              &vector->array,
 	                              &vector->capacity,
 	                              vector->nmemb,
 	                              vector->size);
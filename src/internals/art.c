@@ -0,0 +1,1338 @@
+// Adaptive radix tree after Leis, Kemper and Neumann, "The Adaptive Radix Tree:
+// ARTful Indexing for Main-Memory Databases" (ICDE 2013).
+
+#include "../../internals/art.h"
+#include "../../internals/base.h"
+#include "../../internals/cassert.h"
+#include <assert.h>
+#include <malloc.h>
+#include <memory.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define LEAF_TAG ((uintptr_t)1)
+
+// shrink one size class below the point where the smaller node is full, so an
+// insert and an erase at the boundary do not resize back and forth
+#define SHRINK_NODE256 37
+#define SHRINK_NODE48  12
+#define SHRINK_NODE16  3
+
+struct ArtNode4
+{
+	struct ArtNode  node;
+	unsigned char   keys[4];
+	struct ArtNode *children[4];
+};
+
+struct ArtNode16
+{
+	struct ArtNode  node;
+	unsigned char   keys[16];
+	struct ArtNode *children[16];
+};
+
+// index maps a key byte to one more than the slot of its child
+struct ArtNode48
+{
+	struct ArtNode  node;
+	unsigned char   index[256];
+	struct ArtNode *children[48];
+};
+
+struct ArtNode256
+{
+	struct ArtNode  node;
+	struct ArtNode *children[256];
+};
+
+static const size_t node_sizes[ART_KINDS] = { sizeof(struct ArtNode4),
+	                                          sizeof(struct ArtNode16),
+	                                          sizeof(struct ArtNode48),
+	                                          sizeof(struct ArtNode256) };
+
+static size_t min_size(const size_t a, const size_t b)
+{
+	return (a < b) ? a : b;
+}
+
+static bool is_leaf(const struct ArtNode *ref)
+{
+	return (uintptr_t)ref & LEAF_TAG;
+}
+
+static struct ArtLeaf *as_leaf(const struct ArtNode *ref)
+{
+	return (struct ArtLeaf *)((uintptr_t)ref & ~LEAF_TAG);
+}
+
+static struct ArtNode *leaf_ref(const struct ArtLeaf *leaf)
+{
+	return (struct ArtNode *)((uintptr_t)leaf | LEAF_TAG);
+}
+
+// the PairKV handed out by table iterators sits in front of each leaf
+#define LEAF_HEADER (sizeof(PairKV) + sizeof(struct ArtLeaf))
+
+// String leaves are allocated one by one, so each is offset the way node pages
+// place their slots, leaving the first byte after the header aligned for the
+// value. The offset only depends on the value size, so it is found again when
+// the leaf is freed.
+static size_t string_leaf_bias(const struct ArtTree *tree)
+{
+	const size_t align = node_field_align(tree->v_size);
+
+	return (align - LEAF_HEADER % align) % align;
+}
+
+static const unsigned char *leaf_key(const struct ArtLeaf *leaf)
+{
+	return (const unsigned char *)(leaf + 1);
+}
+
+static void *leaf_value(const struct ArtTree *tree, const struct ArtLeaf *leaf)
+{
+	return (void *)(leaf + 1) + node_field_offset(leaf->k_len, tree->v_size);
+}
+
+static size_t key_length(const struct ArtTree *tree, const void *key)
+{
+	return (tree->k_size) ? tree->k_size : strlen(key) + 1;
+}
+
+// integer keys are indexed from the most significant byte, so that byte order
+// and numeric order agree
+static unsigned char key_byte(const struct ArtTree *tree,
+                              const void           *key,
+                              const size_t          depth)
+{
+	const unsigned char *bytes = key;
+
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	if (tree->k_size)
+	{
+		return bytes[tree->k_size - 1 - depth];
+	}
+#else
+	(void)tree;
+#endif
+
+	return bytes[depth];
+}
+
+static bool leaf_matches(const struct ArtLeaf *leaf,
+                         const void           *key,
+                         const size_t          k_len)
+{
+	return leaf->k_len == k_len && memcmp(leaf_key(leaf), key, k_len) == 0;
+}
+
+static struct ArtLeaf *create_leaf(struct ArtTree *tree,
+                                   const void     *key,
+                                   const size_t    k_len,
+                                   const void     *value)
+{
+	void *slot;
+
+	if (tree->k_size)
+	{
+		slot = alloc_node(&tree->leaves);
+	}
+	else
+	{
+		const size_t bias = string_leaf_bias(tree);
+
+		slot = memory_alloc(HEAP_ART,
+		                    &tree->allocator,
+		                    bias + LEAF_HEADER +
+		                        node_field_offset(k_len, tree->v_size) +
+		                        tree->v_size) +
+		       bias;
+	}
+
+	PairKV         *pair = slot;
+	struct ArtLeaf *leaf = (struct ArtLeaf *)(pair + 1);
+
+	leaf->prev  = NULL;
+	leaf->next  = NULL;
+	leaf->k_len = k_len;
+
+	memcpy((void *)leaf_key(leaf), key, k_len);
+
+	if (tree->v_size)
+	{
+		memcpy(leaf_value(tree, leaf), value, tree->v_size);
+	}
+
+	pair->key   = leaf_key(leaf);
+	pair->value = leaf_value(tree, leaf);
+
+	return leaf;
+}
+
+static void destroy_leaf(struct ArtTree *tree, struct ArtLeaf *leaf)
+{
+	void *slot = (PairKV *)leaf - 1;
+
+	if (tree->k_size)
+	{
+		free_node(&tree->leaves, slot);
+	}
+	else
+	{
+		memory_free(HEAP_ART,
+		            &tree->allocator,
+		            slot - string_leaf_bias(tree));
+	}
+}
+
+static void link_after(struct ArtTree *tree,
+                       struct ArtLeaf *leaf,
+                       struct ArtLeaf *prev)
+{
+	leaf->prev = prev;
+	leaf->next = prev->next;
+
+	if (prev->next)
+	{
+		prev->next->prev = leaf;
+	}
+	else
+	{
+		tree->max = leaf;
+	}
+
+	prev->next = leaf;
+}
+
+static void link_before(struct ArtTree *tree,
+                        struct ArtLeaf *leaf,
+                        struct ArtLeaf *next)
+{
+	leaf->next = next;
+	leaf->prev = next->prev;
+
+	if (next->prev)
+	{
+		next->prev->next = leaf;
+	}
+	else
+	{
+		tree->min = leaf;
+	}
+
+	next->prev = leaf;
+}
+
+static void unlink_leaf(struct ArtTree *tree, struct ArtLeaf *leaf)
+{
+	if (leaf->prev)
+	{
+		leaf->prev->next = leaf->next;
+	}
+	else
+	{
+		tree->min = leaf->next;
+	}
+
+	if (leaf->next)
+	{
+		leaf->next->prev = leaf->prev;
+	}
+	else
+	{
+		tree->max = leaf->prev;
+	}
+}
+
+static struct ArtNode *create_inner(struct ArtTree    *tree,
+                                    const enum ArtKind kind)
+{
+	struct ArtNode *node = alloc_node(&tree->nodes[kind]);
+
+	memset(node, 0, node_sizes[kind]);
+
+	node->kind = kind;
+
+	return node;
+}
+
+static void destroy_inner(struct ArtTree *tree, struct ArtNode *node)
+{
+	free_node(&tree->nodes[node->kind], node);
+}
+
+static struct ArtNode *resize_inner(struct ArtTree     *tree,
+                                    const struct ArtNode *node,
+                                    const enum ArtKind  kind)
+{
+	struct ArtNode *resized = create_inner(tree, kind);
+
+	resized->nchildren  = node->nchildren;
+	resized->prefix_len = node->prefix_len;
+
+	memcpy(resized->prefix, node->prefix, ART_PREFIX_MAX);
+
+	return resized;
+}
+
+static struct ArtNode **find_child(struct ArtNode      *node,
+                                   const unsigned char  byte)
+{
+	switch (node->kind)
+	{
+		case ART_NODE4:
+		{
+			struct ArtNode4 *n = (struct ArtNode4 *)node;
+
+			for (size_t i = 0; i < node->nchildren; i++)
+			{
+				if (n->keys[i] == byte)
+				{
+					return &n->children[i];
+				}
+			}
+
+			return NULL;
+		}
+		case ART_NODE16:
+		{
+			struct ArtNode16 *n = (struct ArtNode16 *)node;
+
+#ifdef __SSE2__
+			const __m128i keys  = _mm_loadu_si128((const __m128i *)n->keys);
+			const __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8((char)byte),
+			                                     keys);
+			const unsigned mask = (unsigned)_mm_movemask_epi8(match) &
+			                      ((1u << node->nchildren) - 1);
+
+			return (mask) ? &n->children[__builtin_ctz(mask)] : NULL;
+#else
+			for (size_t i = 0; i < node->nchildren; i++)
+			{
+				if (n->keys[i] == byte)
+				{
+					return &n->children[i];
+				}
+			}
+
+			return NULL;
+#endif
+		}
+		case ART_NODE48:
+		{
+			struct ArtNode48 *n = (struct ArtNode48 *)node;
+
+			return (n->index[byte]) ? &n->children[n->index[byte] - 1] : NULL;
+		}
+		default:
+		{
+			struct ArtNode256 *n = (struct ArtNode256 *)node;
+
+			return (n->children[byte]) ? &n->children[byte] : NULL;
+		}
+	}
+}
+
+// node4 and node16 keep their keys sorted, with the children in the same order
+static unsigned char *sorted_keys(struct ArtNode *node)
+{
+	return (node->kind == ART_NODE4) ? ((struct ArtNode4 *)node)->keys
+	                                 : ((struct ArtNode16 *)node)->keys;
+}
+
+static struct ArtNode **sorted_children(struct ArtNode *node)
+{
+	return (node->kind == ART_NODE4) ? ((struct ArtNode4 *)node)->children
+	                                 : ((struct ArtNode16 *)node)->children;
+}
+
+// the child under the greatest key byte less than byte, or NULL
+static struct ArtNode *lower_child(struct ArtNode      *node,
+                                   const unsigned char  byte)
+{
+	switch (node->kind)
+	{
+		case ART_NODE4:
+		case ART_NODE16:
+		{
+			const unsigned char *keys     = sorted_keys(node);
+			struct ArtNode     **children = sorted_children(node);
+			struct ArtNode      *lower    = NULL;
+
+			for (size_t i = 0; i < node->nchildren && keys[i] < byte; i++)
+			{
+				lower = children[i];
+			}
+
+			return lower;
+		}
+		case ART_NODE48:
+		{
+			struct ArtNode48 *n = (struct ArtNode48 *)node;
+
+			for (size_t i = byte; i-- > 0;)
+			{
+				if (n->index[i])
+				{
+					return n->children[n->index[i] - 1];
+				}
+			}
+
+			return NULL;
+		}
+		default:
+		{
+			struct ArtNode256 *n = (struct ArtNode256 *)node;
+
+			for (size_t i = byte; i-- > 0;)
+			{
+				if (n->children[i])
+				{
+					return n->children[i];
+				}
+			}
+
+			return NULL;
+		}
+	}
+}
+
+// the child under the least key byte greater than byte, or NULL
+static struct ArtNode *higher_child(struct ArtNode      *node,
+                                    const unsigned char  byte)
+{
+	switch (node->kind)
+	{
+		case ART_NODE4:
+		case ART_NODE16:
+		{
+			const unsigned char *keys     = sorted_keys(node);
+			struct ArtNode     **children = sorted_children(node);
+
+			for (size_t i = 0; i < node->nchildren; i++)
+			{
+				if (keys[i] > byte)
+				{
+					return children[i];
+				}
+			}
+
+			return NULL;
+		}
+		case ART_NODE48:
+		{
+			struct ArtNode48 *n = (struct ArtNode48 *)node;
+
+			for (size_t i = byte + 1; i < 256; i++)
+			{
+				if (n->index[i])
+				{
+					return n->children[n->index[i] - 1];
+				}
+			}
+
+			return NULL;
+		}
+		default:
+		{
+			struct ArtNode256 *n = (struct ArtNode256 *)node;
+
+			for (size_t i = byte + 1; i < 256; i++)
+			{
+				if (n->children[i])
+				{
+					return n->children[i];
+				}
+			}
+
+			return NULL;
+		}
+	}
+}
+
+static struct ArtLeaf *minimum(const struct ArtNode *ref)
+{
+	while (!is_leaf(ref))
+	{
+		const unsigned char lowest = 0;
+		struct ArtNode     *node   = (struct ArtNode *)ref;
+		struct ArtNode    **child  = find_child(node, lowest);
+
+		ref = (child) ? *child : higher_child(node, lowest);
+	}
+
+	return as_leaf(ref);
+}
+
+static struct ArtLeaf *maximum(const struct ArtNode *ref)
+{
+	while (!is_leaf(ref))
+	{
+		const unsigned char highest = 255;
+		struct ArtNode     *node    = (struct ArtNode *)ref;
+		struct ArtNode    **child   = find_child(node, highest);
+
+		ref = (child) ? *child : lower_child(node, highest);
+	}
+
+	return as_leaf(ref);
+}
+
+static void add_sorted(unsigned char   *keys,
+                       struct ArtNode **children,
+                       const size_t     nmemb,
+                       const unsigned char byte,
+                       struct ArtNode  *child)
+{
+	size_t i = 0;
+
+	while (i < nmemb && keys[i] < byte)
+	{
+		i++;
+	}
+
+	memmove(keys + i + 1, keys + i, nmemb - i);
+	memmove(children + i + 1, children + i, (nmemb - i) * sizeof(*children));
+
+	keys[i]     = byte;
+	children[i] = child;
+}
+
+static void add_child(struct ArtTree      *tree,
+                      struct ArtNode     **ref,
+                      const unsigned char  byte,
+                      struct ArtNode      *child)
+{
+	struct ArtNode *node = *ref;
+
+	switch (node->kind)
+	{
+		case ART_NODE4:
+		{
+			struct ArtNode4 *n = (struct ArtNode4 *)node;
+
+			if (node->nchildren < 4)
+			{
+				add_sorted(n->keys, n->children, node->nchildren, byte, child);
+				break;
+			}
+
+			struct ArtNode16 *grown = (struct ArtNode16 *)
+				resize_inner(tree, node, ART_NODE16);
+
+			memcpy(grown->keys, n->keys, sizeof(n->keys));
+			memcpy(grown->children, n->children, sizeof(n->children));
+
+			destroy_inner(tree, node);
+
+			*ref = &grown->node;
+
+			return add_child(tree, ref, byte, child);
+		}
+		case ART_NODE16:
+		{
+			struct ArtNode16 *n = (struct ArtNode16 *)node;
+
+			if (node->nchildren < 16)
+			{
+				add_sorted(n->keys, n->children, node->nchildren, byte, child);
+				break;
+			}
+
+			struct ArtNode48 *grown = (struct ArtNode48 *)
+				resize_inner(tree, node, ART_NODE48);
+
+			for (size_t i = 0; i < 16; i++)
+			{
+				grown->index[n->keys[i]] = i + 1;
+				grown->children[i]       = n->children[i];
+			}
+
+			destroy_inner(tree, node);
+
+			*ref = &grown->node;
+
+			return add_child(tree, ref, byte, child);
+		}
+		case ART_NODE48:
+		{
+			struct ArtNode48 *n = (struct ArtNode48 *)node;
+
+			if (node->nchildren < 48)
+			{
+				size_t slot = 0;
+
+				// erased children leave holes in the slots
+				while (n->children[slot])
+				{
+					slot++;
+				}
+
+				n->index[byte]    = slot + 1;
+				n->children[slot] = child;
+				break;
+			}
+
+			struct ArtNode256 *grown = (struct ArtNode256 *)
+				resize_inner(tree, node, ART_NODE256);
+
+			for (size_t i = 0; i < 256; i++)
+			{
+				if (n->index[i])
+				{
+					grown->children[i] = n->children[n->index[i] - 1];
+				}
+			}
+
+			destroy_inner(tree, node);
+
+			*ref = &grown->node;
+
+			return add_child(tree, ref, byte, child);
+		}
+		default:
+		{
+			((struct ArtNode256 *)node)->children[byte] = child;
+			break;
+		}
+	}
+
+	node->nchildren++;
+}
+
+static void remove_sorted(unsigned char   *keys,
+                          struct ArtNode **children,
+                          const size_t     nmemb,
+                          struct ArtNode **slot)
+{
+	const size_t i = slot - children;
+
+	memmove(keys + i, keys + i + 1, nmemb - i - 1);
+	memmove(children + i,
+	        children + i + 1,
+	        (nmemb - i - 1) * sizeof(*children));
+}
+
+// a node4 left with one child is replaced by it, and the two compressed paths
+// are joined around the key byte between them
+static void collapse_node4(struct ArtTree *tree, struct ArtNode **ref)
+{
+	struct ArtNode4 *n     = (struct ArtNode4 *)*ref;
+	struct ArtNode  *child = n->children[0];
+
+	if (!is_leaf(child))
+	{
+		size_t length = n->node.prefix_len;
+
+		if (length < ART_PREFIX_MAX)
+		{
+			n->node.prefix[length++] = n->keys[0];
+		}
+
+		if (length < ART_PREFIX_MAX)
+		{
+			const size_t count = min_size(child->prefix_len,
+			                              ART_PREFIX_MAX - length);
+
+			memcpy(n->node.prefix + length, child->prefix, count);
+			length += count;
+		}
+
+		memcpy(child->prefix, n->node.prefix, min_size(length, ART_PREFIX_MAX));
+
+		child->prefix_len += n->node.prefix_len + 1;
+	}
+
+	destroy_inner(tree, &n->node);
+
+	*ref = child;
+}
+
+static void remove_child(struct ArtTree       *tree,
+                         struct ArtNode      **ref,
+                         const unsigned char   byte,
+                         struct ArtNode      **slot)
+{
+	struct ArtNode *node = *ref;
+
+	switch (node->kind)
+	{
+		case ART_NODE4:
+		{
+			struct ArtNode4 *n = (struct ArtNode4 *)node;
+
+			remove_sorted(n->keys, n->children, node->nchildren--, slot);
+
+			if (node->nchildren == 1)
+			{
+				collapse_node4(tree, ref);
+			}
+
+			break;
+		}
+		case ART_NODE16:
+		{
+			struct ArtNode16 *n = (struct ArtNode16 *)node;
+
+			remove_sorted(n->keys, n->children, node->nchildren--, slot);
+
+			if (node->nchildren == SHRINK_NODE16)
+			{
+				struct ArtNode4 *shrunk = (struct ArtNode4 *)
+					resize_inner(tree, node, ART_NODE4);
+
+				memcpy(shrunk->keys, n->keys, SHRINK_NODE16);
+				memcpy(shrunk->children,
+				       n->children,
+				       SHRINK_NODE16 * sizeof(*n->children));
+
+				destroy_inner(tree, node);
+
+				*ref = &shrunk->node;
+			}
+
+			break;
+		}
+		case ART_NODE48:
+		{
+			struct ArtNode48 *n = (struct ArtNode48 *)node;
+
+			n->children[n->index[byte] - 1] = NULL;
+			n->index[byte]                  = 0;
+			node->nchildren--;
+
+			if (node->nchildren == SHRINK_NODE48)
+			{
+				struct ArtNode16 *shrunk = (struct ArtNode16 *)
+					resize_inner(tree, node, ART_NODE16);
+				size_t count = 0;
+
+				for (size_t i = 0; i < 256; i++)
+				{
+					if (n->index[i])
+					{
+						shrunk->keys[count]     = i;
+						shrunk->children[count] = n->children[n->index[i] - 1];
+						count++;
+					}
+				}
+
+				destroy_inner(tree, node);
+
+				*ref = &shrunk->node;
+			}
+
+			break;
+		}
+		default:
+		{
+			struct ArtNode256 *n = (struct ArtNode256 *)node;
+
+			n->children[byte] = NULL;
+			node->nchildren--;
+
+			if (node->nchildren == SHRINK_NODE256)
+			{
+				struct ArtNode48 *shrunk = (struct ArtNode48 *)
+					resize_inner(tree, node, ART_NODE48);
+				size_t count = 0;
+
+				for (size_t i = 0; i < 256; i++)
+				{
+					if (n->children[i])
+					{
+						shrunk->index[i]        = count + 1;
+						shrunk->children[count] = n->children[i];
+						count++;
+					}
+				}
+
+				destroy_inner(tree, node);
+
+				*ref = &shrunk->node;
+			}
+
+			break;
+		}
+	}
+}
+
+// Compares only the stored bytes of the compressed path; any bytes beyond them
+// are skipped optimistically and verified against the leaf at the end.
+static size_t check_prefix(const struct ArtTree *tree,
+                           const struct ArtNode *node,
+                           const void           *key,
+                           const size_t          k_len,
+                           const size_t          depth)
+{
+	const size_t max = min_size(min_size(node->prefix_len, ART_PREFIX_MAX),
+	                            k_len - depth);
+	size_t       i   = 0;
+
+	while (i < max && node->prefix[i] == key_byte(tree, key, depth + i))
+	{
+		i++;
+	}
+
+	return i;
+}
+
+// Like check_prefix but exact, reading the bytes past ART_PREFIX_MAX from the
+// smallest leaf below node, which shares the whole path.
+static size_t prefix_mismatch(const struct ArtTree *tree,
+                              const struct ArtNode *node,
+                              const void           *key,
+                              const size_t          k_len,
+                              const size_t          depth)
+{
+	size_t i = check_prefix(tree, node, key, k_len, depth);
+
+	if (i < ART_PREFIX_MAX || node->prefix_len <= ART_PREFIX_MAX)
+	{
+		return i;
+	}
+
+	const struct ArtLeaf *leaf = minimum(node);
+	const size_t          max  = min_size(leaf->k_len, k_len) - depth;
+
+	while (i < max && key_byte(tree, leaf_key(leaf), depth + i) ==
+	                      key_byte(tree, key, depth + i))
+	{
+		i++;
+	}
+
+	return i;
+}
+
+static struct ArtLeaf *split_leaf(struct ArtTree   *tree,
+                                  struct ArtNode  **ref,
+                                  const void       *key,
+                                  const size_t      k_len,
+                                  const size_t      depth,
+                                  const void       *value)
+{
+	struct ArtLeaf *other = as_leaf(*ref);
+	struct ArtLeaf *leaf  = create_leaf(tree, key, k_len, value);
+	struct ArtNode *split = create_inner(tree, ART_NODE4);
+	const size_t    max   = min_size(other->k_len, k_len) - depth;
+	size_t          lcp   = 0;
+
+	while (lcp < max && key_byte(tree, leaf_key(other), depth + lcp) ==
+	                        key_byte(tree, key, depth + lcp))
+	{
+		lcp++;
+	}
+
+	split->prefix_len = lcp;
+
+	for (size_t i = 0; i < min_size(lcp, ART_PREFIX_MAX); i++)
+	{
+		split->prefix[i] = key_byte(tree, key, depth + i);
+	}
+
+	const unsigned char old_byte = key_byte(tree, leaf_key(other), depth + lcp);
+	const unsigned char new_byte = key_byte(tree, key, depth + lcp);
+
+	*ref = split;
+
+	add_child(tree, ref, old_byte, leaf_ref(other));
+	add_child(tree, ref, new_byte, leaf_ref(leaf));
+
+	if (new_byte < old_byte)
+	{
+		link_before(tree, leaf, other);
+	}
+	else
+	{
+		link_after(tree, leaf, other);
+	}
+
+	return leaf;
+}
+
+static struct ArtLeaf *split_prefix(struct ArtTree   *tree,
+                                    struct ArtNode  **ref,
+                                    const void       *key,
+                                    const size_t      k_len,
+                                    const size_t      depth,
+                                    const size_t      diff,
+                                    const void       *value)
+{
+	struct ArtNode *node  = *ref;
+	struct ArtNode *split = create_inner(tree, ART_NODE4);
+	unsigned char   old_byte;
+
+	split->prefix_len = diff;
+
+	memcpy(split->prefix, node->prefix, min_size(diff, ART_PREFIX_MAX));
+
+	if (node->prefix_len <= ART_PREFIX_MAX)
+	{
+		old_byte          = node->prefix[diff];
+		node->prefix_len -= diff + 1;
+
+		memmove(node->prefix,
+		        node->prefix + diff + 1,
+		        min_size(node->prefix_len, ART_PREFIX_MAX));
+	}
+	else
+	{
+		const struct ArtLeaf *min = minimum(node);
+
+		old_byte          = key_byte(tree, leaf_key(min), depth + diff);
+		node->prefix_len -= diff + 1;
+
+		for (size_t i = 0; i < min_size(node->prefix_len, ART_PREFIX_MAX); i++)
+		{
+			node->prefix[i] = key_byte(tree,
+			                           leaf_key(min),
+			                           depth + diff + 1 + i);
+		}
+	}
+
+	struct ArtLeaf     *leaf     = create_leaf(tree, key, k_len, value);
+	const unsigned char new_byte = key_byte(tree, key, depth + diff);
+
+	*ref = split;
+
+	add_child(tree, ref, old_byte, node);
+	add_child(tree, ref, new_byte, leaf_ref(leaf));
+
+	if (new_byte < old_byte)
+	{
+		link_before(tree, leaf, minimum(node));
+	}
+	else
+	{
+		link_after(tree, leaf, maximum(node));
+	}
+
+	return leaf;
+}
+
+static struct ArtLeaf *insert_leaf(struct ArtTree   *tree,
+                                   struct ArtNode  **ref,
+                                   const void       *key,
+                                   const size_t      k_len,
+                                   size_t            depth,
+                                   const void       *value)
+{
+	struct ArtNode *node = *ref;
+
+	if (is_leaf(node))
+	{
+		struct ArtLeaf *leaf = as_leaf(node);
+
+		if (leaf_matches(leaf, key, k_len))
+		{
+			if (tree->v_size)
+			{
+				memcpy(leaf_value(tree, leaf), value, tree->v_size);
+			}
+
+			return NULL;
+		}
+
+		// lazy expansion: a leaf sits directly below the first byte that
+		// tells it apart, and is pushed down only when another key needs it
+		return split_leaf(tree, ref, key, k_len, depth, value);
+	}
+
+	if (node->prefix_len)
+	{
+		const size_t diff = prefix_mismatch(tree, node, key, k_len, depth);
+
+		if (diff < node->prefix_len)
+		{
+			return split_prefix(tree, ref, key, k_len, depth, diff, value);
+		}
+
+		depth += node->prefix_len;
+	}
+
+	const unsigned char byte  = key_byte(tree, key, depth);
+	struct ArtNode    **child = find_child(node, byte);
+
+	if (child)
+	{
+		return insert_leaf(tree, child, key, k_len, depth + 1, value);
+	}
+
+	struct ArtLeaf *leaf  = create_leaf(tree, key, k_len, value);
+	struct ArtNode *lower = lower_child(node, byte);
+
+	// the neighbours of a new child are found among its siblings
+	if (lower)
+	{
+		link_after(tree, leaf, maximum(lower));
+	}
+	else
+	{
+		link_before(tree, leaf, minimum(higher_child(node, byte)));
+	}
+
+	add_child(tree, ref, byte, leaf_ref(leaf));
+
+	return leaf;
+}
+
+static struct ArtLeaf *erase_leaf(struct ArtTree   *tree,
+                                  struct ArtNode  **ref,
+                                  const void       *key,
+                                  const size_t      k_len,
+                                  size_t            depth)
+{
+	struct ArtNode *node = *ref;
+
+	if (is_leaf(node))
+	{
+		struct ArtLeaf *leaf = as_leaf(node);
+
+		if (!leaf_matches(leaf, key, k_len))
+		{
+			return NULL;
+		}
+
+		*ref = NULL;
+
+		return leaf;
+	}
+
+	if (node->prefix_len)
+	{
+		if (check_prefix(tree, node, key, k_len, depth) !=
+		    min_size(node->prefix_len, ART_PREFIX_MAX))
+		{
+			return NULL;
+		}
+
+		depth += node->prefix_len;
+	}
+
+	if (depth >= k_len)
+	{
+		return NULL;
+	}
+
+	const unsigned char byte  = key_byte(tree, key, depth);
+	struct ArtNode    **child = find_child(node, byte);
+
+	if (!child)
+	{
+		return NULL;
+	}
+
+	if (!is_leaf(*child))
+	{
+		return erase_leaf(tree, child, key, k_len, depth + 1);
+	}
+
+	struct ArtLeaf *leaf = as_leaf(*child);
+
+	if (!leaf_matches(leaf, key, k_len))
+	{
+		return NULL;
+	}
+
+	remove_child(tree, ref, byte, child);
+
+	return leaf;
+}
+
+static void destroy_string_leaves(struct ArtTree *tree)
+{
+	if (tree->k_size)
+	{
+		return;
+	}
+
+	for (struct ArtLeaf *leaf = tree->min; leaf;)
+	{
+		struct ArtLeaf *next = leaf->next;
+
+		destroy_leaf(tree, leaf);
+
+		leaf = next;
+	}
+}
+
+static Iter art_iter(const IteratorType type, struct ArtLeaf *leaf)
+{
+	Iter iter = { .type = type, .data.art = { .leaf = leaf } };
+
+	return iter;
+}
+
+struct ArtTree create_art(const size_t    k_size,
+                          const size_t    v_size,
+                          const Allocator allocator)
+{
+	struct ArtTree tree = { .k_size    = k_size,
+		                    .v_size    = v_size,
+		                    .allocator = allocator };
+
+	for (size_t kind = 0; kind < ART_KINDS; kind++)
+	{
+		tree.nodes[kind] = create_node_allocator(node_sizes[kind],
+		                                         NODE_COUNT_DEFAULT,
+		                                         0,
+		                                         0,
+		                                         allocator);
+	}
+
+	// string leaves vary in length and are allocated one by one
+	if (k_size)
+	{
+		tree.leaves = create_node_allocator(LEAF_HEADER,
+		                                    NODE_COUNT_DEFAULT,
+		                                    k_size,
+		                                    v_size,
+		                                    allocator);
+	}
+
+	return tree;
+}
+
+void destroy_art(struct ArtTree *tree)
+{
+	destroy_string_leaves(tree);
+
+	for (size_t kind = 0; kind < ART_KINDS; kind++)
+	{
+		destroy_node_allocator(&tree->nodes[kind]);
+	}
+
+	if (tree->k_size)
+	{
+		destroy_node_allocator(&tree->leaves);
+	}
+}
+
+void art_insert(struct ArtTree *tree, const void *key, const void *value)
+{
+	CHEAP_ASSERT(key, "Key cannot be NULL.");
+
+	const size_t k_len = key_length(tree, key);
+
+	if (!tree->root)
+	{
+		struct ArtLeaf *leaf = create_leaf(tree, key, k_len, value);
+
+		tree->root = leaf_ref(leaf);
+		tree->min  = leaf;
+		tree->max  = leaf;
+		tree->nmemb++;
+	}
+	else if (insert_leaf(tree, &tree->root, key, k_len, 0, value))
+	{
+		tree->nmemb++;
+	}
+}
+
+void art_insert_range(struct ArtTree *tree, Range range)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		PairKV *pair = get_range(range);
+
+		art_insert(tree, pair->key, pair->value);
+	}
+}
+
+void *art_search(const struct ArtTree *tree, const void *key)
+{
+	const size_t    k_len = key_length(tree, key);
+	struct ArtNode *node  = tree->root;
+	size_t          depth = 0;
+
+	while (node && !is_leaf(node))
+	{
+		if (node->prefix_len)
+		{
+			if (check_prefix(tree, node, key, k_len, depth) !=
+			    min_size(node->prefix_len, ART_PREFIX_MAX))
+			{
+				return NULL;
+			}
+
+			depth += node->prefix_len;
+		}
+
+		if (depth >= k_len)
+		{
+			return NULL;
+		}
+
+		struct ArtNode **child = find_child(node,
+		                                    key_byte(tree, key, depth++));
+
+		node = (child) ? *child : NULL;
+	}
+
+	return (node && leaf_matches(as_leaf(node), key, k_len))
+	           ? leaf_value(tree, as_leaf(node))
+	           : NULL;
+}
+
+void art_erase(struct ArtTree *tree, const void *key)
+{
+	if (!tree->root)
+	{
+		return;
+	}
+
+	const size_t    k_len = key_length(tree, key);
+	struct ArtLeaf *leaf  = erase_leaf(tree, &tree->root, key, k_len, 0);
+
+	if (leaf)
+	{
+		unlink_leaf(tree, leaf);
+		destroy_leaf(tree, leaf);
+		tree->nmemb--;
+	}
+}
+
+void art_clear(struct ArtTree *tree)
+{
+	destroy_string_leaves(tree);
+
+	for (size_t kind = 0; kind < ART_KINDS; kind++)
+	{
+		clear_nodes(&tree->nodes[kind]);
+	}
+
+	if (tree->k_size)
+	{
+		clear_nodes(&tree->leaves);
+	}
+
+	tree->root  = NULL;
+	tree->min   = NULL;
+	tree->max   = NULL;
+	tree->nmemb = 0;
+}
+
+Range art_prefix(const IteratorType    type,
+                 const struct ArtTree *tree,
+                 const void           *prefix,
+                 const size_t          length)
+{
+	CHEAP_ASSERT(!tree->k_size || length <= tree->k_size,
+	             "Prefix cannot be longer than the key.");
+
+	Range           none  = { art_iter(type, NULL), art_iter(type, NULL) };
+	struct ArtNode *node  = tree->root;
+	size_t          depth = 0;
+
+	while (node && !is_leaf(node) && depth < length)
+	{
+		const size_t count = min_size(node->prefix_len, length - depth);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const unsigned char byte =
+				(i < ART_PREFIX_MAX)
+					? node->prefix[i]
+					: key_byte(tree, leaf_key(minimum(node)), depth + i);
+
+			if (byte != key_byte(tree, prefix, depth + i))
+			{
+				return none;
+			}
+		}
+
+		depth += node->prefix_len;
+
+		if (depth >= length)
+		{
+			break;
+		}
+
+		struct ArtNode **child = find_child(node,
+		                                    key_byte(tree, prefix, depth++));
+
+		node = (child) ? *child : NULL;
+	}
+
+	if (!node)
+	{
+		return none;
+	}
+
+	if (is_leaf(node))
+	{
+		// the bytes skipped below the parent of a leaf are still unchecked
+		const struct ArtLeaf *leaf = as_leaf(node);
+
+		if (leaf->k_len < length)
+		{
+			return none;
+		}
+
+		for (size_t i = depth; i < length; i++)
+		{
+			if (key_byte(tree, leaf_key(leaf), i) !=
+			    key_byte(tree, prefix, i))
+			{
+				return none;
+			}
+		}
+	}
+
+	struct ArtLeaf *first = minimum(node);
+	struct ArtLeaf *last  = maximum(node);
+
+	if (type > ITERATOR_REVERSE)
+	{
+		Range range = { art_iter(type, last), art_iter(type, first->prev) };
+
+		return range;
+	}
+
+	Range range = { art_iter(type, first), art_iter(type, last->next) };
+
+	return range;
+}
+
+Iter begin_art(const IteratorType type, const struct ArtTree *tree)
+{
+	return art_iter(type, tree->min);
+}
+
+Iter end_art(const IteratorType type, const struct ArtTree *)
+{
+	return art_iter(type, NULL);
+}
+
+Iter rbegin_art(const IteratorType type, const struct ArtTree *tree)
+{
+	return art_iter(type, tree->max);
+}
+
+Iter rend_art(const IteratorType type, const struct ArtTree *)
+{
+	return art_iter(type, NULL);
+}
+
+void next_art(Iter *iter)
+{
+	iter->data.art.leaf = iter->data.art.leaf->next;
+}
+
+void prev_art(Iter *iter)
+{
+	iter->data.art.leaf = iter->data.art.leaf->prev;
+}
+
+void *get_art_table(const Iter iter)
+{
+	return (PairKV *)iter.data.art.leaf - 1;
+}
@@ -1,32 +1,142 @@
 #include "../../internals/base.h"
 #include "../../internals/cassert.h"
+#include <memory.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-void *memory_allocate_container(const size_t size)
+void *memory_allocate_container(const HeapSubsystem subsystem,
+                                const size_t        size)
 {
-	void *ptr = calloc(1, size);
+	void *ptr = heap_calloc(subsystem, 1, size);
 
 	CHEAP_ASSERT(ptr, "Failed to allocate container.");
 
 	return ptr;
 }
 
-void memory_free_buffer(void **buffer)
+size_t memory_align_padding(const void *ptr, const size_t align)
 {
-	if (*buffer)
+	CHEAP_ASSERT(align && !(align & (align - 1)),
+	             "Alignment must be a power of two.");
+
+	return -(uintptr_t)ptr & (align - 1);
+}
+
+void memory_free_buffer(const HeapSubsystem subsystem, void **buffer)
+{
+	heap_free(subsystem, *buffer);
+
+	*buffer = NULL;
+}
+
+static bool custom_allocator(const Allocator *allocator)
+{
+	return allocator && allocator->alloc;
+}
+
+void *memory_alloc(const HeapSubsystem subsystem,
+                   const Allocator    *allocator,
+                   const size_t        size)
+{
+	void *ptr = (custom_allocator(allocator))
+	                ? allocator->alloc(allocator->ctx, size)
+	                : heap_malloc(subsystem, size);
+
+	CHEAP_ASSERT(ptr, "Failed to allocate memory.");
+
+	return ptr;
+}
+
+void *memory_calloc(const HeapSubsystem subsystem,
+                    const Allocator    *allocator,
+                    const size_t        size)
+{
+	if (!custom_allocator(allocator))
 	{
-		free(*buffer);
+		void *ptr = heap_calloc(subsystem, 1, size);
+
+		CHEAP_ASSERT(ptr, "Failed to allocate memory.");
+
+		return ptr;
 	}
 
-	*buffer = NULL;
+	return memset(memory_alloc(subsystem, allocator, size), 0, size);
+}
+
+void *memory_realloc(const HeapSubsystem subsystem,
+                     const Allocator    *allocator,
+                     void               *ptr,
+                     const size_t        old_size,
+                     const size_t        new_size)
+{
+	void *tmp = NULL;
+
+	if (!custom_allocator(allocator))
+	{
+		tmp = heap_realloc(subsystem, ptr, new_size);
+	}
+	else if (allocator->realloc)
+	{
+		tmp = allocator->realloc(allocator->ctx, ptr, old_size, new_size);
+	}
+	else
+	{
+		tmp = memory_alloc(subsystem, allocator, new_size);
+
+		if (ptr)
+		{
+			memcpy(tmp, ptr, (old_size < new_size) ? old_size : new_size);
+
+			allocator->free(allocator->ctx, ptr);
+		}
+	}
+
+	CHEAP_ASSERT(tmp || !new_size, "Failed to reallocate memory.");
+
+	return tmp;
+}
+
+void memory_free(const HeapSubsystem subsystem,
+                 const Allocator    *allocator,
+                 void               *ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	if (custom_allocator(allocator))
+	{
+		allocator->free(allocator->ctx, ptr);
+	}
+	else
+	{
+		heap_free(subsystem, ptr);
+	}
+}
+
+void memory_release_container(const HeapSubsystem subsystem,
+                              void              **container,
+                              const Allocator    *allocator)
+{
+	CHEAP_ASSERT(*container, "Container cannot be NULL.");
+
+	// the allocator usually lives in the container being released
+	const Allocator copy = (allocator) ? *allocator : (Allocator){ 0 };
+
+	memory_free(subsystem, &copy, *container);
+
+	*container = NULL;
 }
 
-void memory_free_container_generic(void **container, void *array)
+void memory_free_container_generic(void            **container,
+                                   void             *array,
+                                   const Allocator *allocator)
 {
 	CHEAP_ASSERT(*container, "Container cannot be NULL.");
 
-	memory_free_buffer(&array);
-	memory_free_buffer(container);
+	memory_free(HEAP_ARRAY, allocator, array);
+	memory_release_container(HEAP_CONTAINER, container, allocator);
 }
 
 bool generic_empty(const size_t nmemb)
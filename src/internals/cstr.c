@@ -1,6 +1,7 @@
 #include "../../cstr.h"
 #include "../../arena.h"
 #include "../../vector.h"
+#include "../../internals/heap.h"
 #include <assert.h>
 #include <ctype.h>
 #include <malloc.h>
@@ -33,13 +34,13 @@ typedef String (*DuplicateNStrategy)(Arena *, ConstString, const uint32_t);
 
 ALLOC static char *stdlib_alloc(String, const uint32_t sz, uint32_t, Arena *)
 {
-	return calloc(sz, sizeof(char));
+	return heap_calloc(HEAP_STRING, sz, sizeof(char));
 }
 
 ALLOC static char *
 stdlib_realloc(String string, const uint32_t sz, uint32_t old, Arena *)
 {
-	char *ptr = realloc(BUFFER(string), sz);
+	char *ptr = heap_realloc(HEAP_STRING, BUFFER(string), sz);
 
 	assert(ptr);
 
@@ -55,11 +56,19 @@ arena_alloc(String, const uint32_t sz, uint32_t, Arena *arena)
 }
 
 ALLOC static char *
-arena_realloc(String string, const uint32_t sz, uint32_t, Arena *arena)
+arena_realloc(String string, const uint32_t sz, uint32_t old, Arena *arena)
 {
-	void *ptr = calloc_arena(arena, sz);
+	// a string that was the last thing allocated grows without a copy
+	char *ptr = realloc_arena(arena,
+	                          BUFFER(string),
+	                          NON_STRING_SIZE + old,
+	                          sz);
 
-	memcpy(ptr, BUFFER(string), sz);
+	// an exhausted virtual arena leaves the string as it was
+	if (ptr)
+	{
+		memset(ptr + old + METADATA_SIZE, 0, sz - old - METADATA_SIZE);
+	}
 
 	return ptr;
 }
@@ -119,6 +128,11 @@ ALLOC static String generic_allocation(String             string,
 {
 	char *buff = strategy(string, NON_STRING_SIZE + sz, old, arena);
 
+	if (!buff)
+	{
+		return NULL;
+	}
+
 	write_buffer(buff, sz);
 
 	return STRING(buff);
@@ -156,6 +170,11 @@ ALLOC static String generic_write(String         string,
                                   void          *data,
                                   WriteStrategy  strategy)
 {
+	if (!string)
+	{
+		return NULL;
+	}
+
 	string = strategy(string, src, len, data);
 
 	return clean_up(string, len);
@@ -177,7 +196,7 @@ ALLOC static String string_construct_empty(AllocationStrategy strategy,
                                            Arena             *arena)
 {
 	String string = generic_allocation(NULL, 0, 0, strategy, arena);
-	return clean_up(string, 0);
+	return (string) ? clean_up(string, 0) : NULL;
 }
 
 static long get_stream_buffer_size(FILE *stream)
@@ -211,6 +230,11 @@ ALLOC static String string_concatenate(restrict String    dest,
 	{
 		const uint32_t sz = max(len + n, buffsz * 2);
 		dest = generic_allocation(dest, sz, buffsz, strategy, arena);
+
+		if (!dest)
+		{
+			return NULL;
+		}
 	}
 
 	const uint32_t new_len = n + len;
@@ -257,6 +281,11 @@ ALLOC static String string_replace(String      str,
 		{
 			const uint32_t sz = max(buffsz + count * diff, buffsz * 2);
 			str = generic_allocation(str, sz, buffsz, strategy, arena);
+
+			if (!str)
+			{
+				return NULL;
+			}
 		}
 
 		substr = str;
@@ -319,7 +348,7 @@ void string_free(String string)
 {
 	char *buff = BUFFER(string);
 
-	free(buff);
+	heap_free(HEAP_STRING, buff);
 }
 
 String string_cat(String restrict dest, ConstString restrict src)
@@ -556,6 +585,19 @@ ALLOC static String arena_generic_string_ndup(Arena         *arena,
 	return arena_string_ndup(arena, string, n);
 }
 
+// an arena that runs out of space fails the whole split
+static bool push_string(Vector *strings, ConstString string)
+{
+	if (!string)
+	{
+		destroy_vector(&strings);
+		return false;
+	}
+
+	push_back_vector(strings, &string);
+	return true;
+}
+
 static Vector *generic_string_split(ConstString        str,
                                     ConstString        delim,
                                     DuplicateStrategy  dup,
@@ -572,7 +614,10 @@ static Vector *generic_string_split(ConstString        str,
 	{
 		const ptrdiff_t len    = sub - cursor;
 		ConstString     string = ndup(arena, cursor, len);
-		push_back_vector(strings, &string);
+		if (!push_string(strings, string))
+		{
+			return NULL;
+		}
 		sub += n;
 		cursor = sub;
 	}
@@ -581,12 +626,18 @@ static Vector *generic_string_split(ConstString        str,
 	{
 		const size_t len   = strlen(cursor);
 		String       final = ndup(arena, cursor, len);
-		push_back_vector(strings, &final);
+		if (!push_string(strings, final))
+		{
+			return NULL;
+		}
 	}
 	else
 	{
 		ConstString string = dup(arena, str);
-		push_back_vector(strings, &string);
+		if (!push_string(strings, string))
+		{
+			return NULL;
+		}
 	}
 
 	return strings;
@@ -609,6 +660,11 @@ ALLOC static String generic_join(Vector            *strings,
 {
 	String string = string_construct_empty(alloc_strat, arena);
 
+	if (!string)
+	{
+		return NULL;
+	}
+
 	const size_t delim_len = strlen(delim);
 
 	const size_t c = size_vector(strings);
@@ -618,7 +674,7 @@ ALLOC static String generic_join(Vector            *strings,
 		uint32_t    n = string_len(s);
 		string        = string_concatenate(string, s, n, realloc_strat, arena);
 
-		if (i < c - 1)
+		if (string && i < c - 1)
 		{
 			string = string_concatenate(string,
 			                            delim,
@@ -626,6 +682,11 @@ ALLOC static String generic_join(Vector            *strings,
 			                            realloc_strat,
 			                            arena);
 		}
+
+		if (!string)
+		{
+			return NULL;
+		}
 	}
 
 	return string;
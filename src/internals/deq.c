@@ -1,5 +1,6 @@
 #include "../../internals/deq.h"
 #include "../../deque.h"
+#include "../../internals/base.h"
 #include "../../iter.h"
 #include <assert.h>
 #include <malloc.h>
@@ -73,9 +74,11 @@ static void resize_from_single(struct ControlArray *control,
 
 	if (control->capacity == 1)
 	{
-		blocks = malloc(sizeof(struct Block) * 2);
+		blocks = memory_alloc(HEAP_DEQUE,
+		                      &control->allocator,
+		                      sizeof(struct Block) * 2);
 		memcpy(blocks + 1 - index, control->blocks, sizeof(struct Block));
-		free(control->blocks);
+		memory_free(HEAP_DEQUE, &control->allocator, control->blocks);
 	}
 	else
 	{
@@ -83,7 +86,10 @@ static void resize_from_single(struct ControlArray *control,
 		blocks[1 - index] = control->blocks[0];
 	}
 
-	struct Block block = { .array = malloc(arr_cap * size), .nmemb = 0 };
+	struct Block block = {
+		.array = memory_alloc(HEAP_DEQUE, &control->allocator, arr_cap * size),
+		.nmemb = 0
+	};
 
 	blocks[index] = block;
 
@@ -112,7 +118,10 @@ static void resize_from_multiple(struct ControlArray *control,
 		const size_t f = f_index;
 		const size_t b = f + (control->block_count) - 1;
 
-		struct Block *blocks = calloc(control->capacity, sizeof(struct Block));
+		struct Block *blocks = memory_calloc(HEAP_DEQUE,
+		                                     &control->allocator,
+		                                     control->capacity *
+		                                         sizeof(struct Block));
 
 		if ((*front) > (*back))
 		{
@@ -135,7 +144,7 @@ static void resize_from_multiple(struct ControlArray *control,
 			       sizeof(struct Block) * control->block_count);
 		}
 
-		free(control->blocks);
+		memory_free(HEAP_DEQUE, &control->allocator, control->blocks);
 
 		control->blocks = blocks;
 
@@ -157,7 +166,9 @@ static void resize_from_multiple(struct ControlArray *control,
 	}
 
 	(*block)->nmemb = 0;
-	(*block)->array = malloc(arr_cap * size);
+	(*block)->array = memory_alloc(HEAP_DEQUE,
+	                               &control->allocator,
+	                               arr_cap * size);
 
 	control->block_count++;
 }
@@ -572,7 +583,7 @@ static void shift_up(struct ControlArray *control,
 
 			if (!block->nmemb)
 			{
-				free(block->array);
+				memory_free(HEAP_DEQUE, &control->allocator, block->array);
 				block->array = NULL;
 
 				control->block_count--;
@@ -630,7 +641,7 @@ static void shift_down(struct ControlArray *control,
 
 			if (!block->nmemb)
 			{
-				free(block->array);
+				memory_free(HEAP_DEQUE, &control->allocator, block->array);
 				block->array = NULL;
 
 				control->block_count--;
@@ -769,14 +780,23 @@ size_t minimum_array_size(const size_t size)
 	                                                : size * MIN_ELEM_COUNT;
 }
 
-struct ControlArray create_control_array(const size_t arr_cap,
-                                         const size_t size)
+struct ControlArray create_control_array(const size_t    arr_cap,
+                                         const size_t    size,
+                                         const Allocator allocator)
 {
-	struct ControlArray control = { .blocks      = malloc(sizeof(struct Block)),
-		                            .block_count = 1,
-		                            .capacity    = 1 };
-
-	struct Block block = { .array = malloc(arr_cap * size), .nmemb = 0 };
+	struct ControlArray control = {
+		.blocks      = memory_alloc(HEAP_DEQUE,
+		                            &allocator,
+		                            sizeof(struct Block)),
+		.block_count = 1,
+		.capacity    = 1,
+		.allocator   = allocator
+	};
+
+	struct Block block = { .array = memory_alloc(HEAP_DEQUE,
+	                                             &allocator,
+	                                             arr_cap * size),
+		                   .nmemb = 0 };
 
 	control.blocks[0] = block;
 
@@ -787,18 +807,20 @@ void destroy_control_array(struct ControlArray *control, const size_t front)
 {
 	if (control->block_count == 1)
 	{
-		free(control->blocks[0].array);
+		memory_free(HEAP_DEQUE, &control->allocator, control->blocks[0].array);
 	}
 	else
 	{
 		for (size_t i = front, j = 0; j < control->block_count;
 		     i = (i + 1) % control->capacity, j++)
 		{
-			free(control->blocks[i].array);
+			memory_free(HEAP_DEQUE,
+			            &control->allocator,
+			            control->blocks[i].array);
 		}
 	}
 
-	free(control->blocks);
+	memory_free(HEAP_DEQUE, &control->allocator, control->blocks);
 }
 
 void deque_push_front(struct ControlArray *control,
@@ -1058,7 +1080,7 @@ void deque_pop_front(struct ControlArray *control,
 
 		if (!(front_block->nmemb))
 		{
-			free(front_block->array);
+			memory_free(HEAP_DEQUE, &control->allocator, front_block->array);
 			front_block->array = NULL;
 
 			control->block_count--;
@@ -1102,7 +1124,7 @@ void deque_pop_back(struct ControlArray *control,
 
 		if (!(back_block->nmemb))
 		{
-			free(back_block->array);
+			memory_free(HEAP_DEQUE, &control->allocator, back_block->array);
 			back_block->array = NULL;
 
 			control->block_count--;
@@ -1173,7 +1195,7 @@ void deque_clear(struct ControlArray *control,
 
 			if (block->array)
 			{
-				free(block->array);
+				memory_free(HEAP_DEQUE, &control->allocator, block->array);
 				block->array = NULL;
 			}
 		}
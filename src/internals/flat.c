@@ -0,0 +1,552 @@
+#include "../../internals/flat.h"
+#include "../../internals/base.h"
+#include "../../internals/cassert.h"
+#include "../../internals/mpool.h"
+#include "../../internals/nalloc.h"
+#include <memory.h>
+
+// descend this many levels ahead: the 16 great-great-grandchildren of slot k
+// are contiguous from slot 16k
+#define PREFETCH_SHIFT 4
+
+static void *slot(const struct FlatArray *flat, const size_t k)
+{
+	return flat->array + (k - 1) * flat->size;
+}
+
+static size_t first_eytzinger(const size_t nmemb)
+{
+	size_t k = (nmemb) ? 1 : 0;
+
+	while (k && 2 * k <= nmemb)
+	{
+		k = 2 * k;
+	}
+
+	return k;
+}
+
+static size_t last_eytzinger(const size_t nmemb)
+{
+	size_t k = (nmemb) ? 1 : 0;
+
+	while (k && 2 * k + 1 <= nmemb)
+	{
+		k = 2 * k + 1;
+	}
+
+	return k;
+}
+
+static size_t next_eytzinger(size_t k, const size_t nmemb)
+{
+	if (2 * k + 1 <= nmemb)
+	{
+		k = 2 * k + 1;
+
+		while (2 * k <= nmemb)
+		{
+			k = 2 * k;
+		}
+	}
+	else
+	{
+		// climb past every ancestor of which k is the right child
+		k >>= __builtin_ctzl(~k) + 1;
+	}
+
+	return k;
+}
+
+static size_t prev_eytzinger(size_t k, const size_t nmemb)
+{
+	if (2 * k <= nmemb)
+	{
+		k = 2 * k;
+
+		while (2 * k + 1 <= nmemb)
+		{
+			k = 2 * k + 1;
+		}
+	}
+	else
+	{
+		k >>= __builtin_ctzl(k) + 1;
+	}
+
+	return k;
+}
+
+static size_t search_eytzinger(const struct FlatArray *flat, const void *key)
+{
+	const size_t nmemb = flat->nmemb;
+	size_t       k     = 1;
+
+	while (k <= nmemb)
+	{
+		__builtin_prefetch(flat->array + (k << PREFETCH_SHIFT) * flat->size);
+
+		k = 2 * k + (flat->k_comp(slot(flat, k), key) < 0);
+	}
+
+	// undo the trailing right turns and the final left turn, leaving the
+	// lower bound (or zero if every key is smaller)
+	k >>= __builtin_ctzl(~k) + 1;
+
+	if (k && flat->k_comp(slot(flat, k), key) != 0)
+	{
+		k = 0;
+	}
+
+	return k;
+}
+
+static void to_sorted(const struct FlatArray *flat, void *sorted)
+{
+	const size_t size = flat->size;
+
+	for (size_t k = first_eytzinger(flat->nmemb); k;
+	     k        = next_eytzinger(k, flat->nmemb))
+	{
+		memcpy(sorted, slot(flat, k), size);
+		sorted += size;
+	}
+}
+
+static void from_sorted(struct FlatArray *flat, const void *sorted)
+{
+	const size_t size = flat->size;
+
+	for (size_t k = first_eytzinger(flat->nmemb); k;
+	     k        = next_eytzinger(k, flat->nmemb))
+	{
+		memcpy(slot(flat, k), sorted, size);
+		sorted += size;
+	}
+}
+
+static void merge_runs(const void  *src,
+                       void        *dst,
+                       size_t       lo,
+                       const size_t mid,
+                       const size_t hi,
+                       const size_t size,
+                       const KComp  compare)
+{
+	size_t i = lo;
+	size_t j = mid;
+
+	for (; i < mid && j < hi; lo++)
+	{
+		// take from the right run only when strictly smaller, to stay stable
+		const size_t from = (compare(src + j * size, src + i * size) < 0)
+		                        ? j++
+		                        : i++;
+
+		memcpy(dst + lo * size, src + from * size, size);
+	}
+
+	memcpy(dst + lo * size, src + i * size, (mid - i) * size);
+	lo += mid - i;
+	memcpy(dst + lo * size, src + j * size, (hi - j) * size);
+}
+
+static void stable_sort(const Allocator *allocator,
+                        void            *base,
+                        const size_t     nmemb,
+                        const size_t     size,
+                        const KComp      compare)
+{
+	void *tmp = generic_mempool_alloc(allocator, nmemb, size);
+	void *src = base;
+	void *dst = tmp;
+
+	for (size_t width = 1; width < nmemb; width *= 2)
+	{
+		for (size_t lo = 0; lo < nmemb; lo += 2 * width)
+		{
+			const size_t mid = (lo + width < nmemb) ? lo + width : nmemb;
+			const size_t hi  = (lo + 2 * width < nmemb) ? lo + 2 * width
+			                                            : nmemb;
+
+			merge_runs(src, dst, lo, mid, hi, size, compare);
+		}
+
+		void *swap = src;
+		src        = dst;
+		dst        = swap;
+	}
+
+	if (src != base)
+	{
+		memcpy(base, src, nmemb * size);
+	}
+
+	memory_free(HEAP_ARRAY, allocator, tmp);
+}
+
+static size_t unique_last(void        *base,
+                          const size_t nmemb,
+                          const size_t size,
+                          const KComp  compare)
+{
+	size_t w = 0;
+
+	for (size_t r = 0; r < nmemb; r++)
+	{
+		// of a run of equal keys only the most recently inserted survives
+		if (r + 1 < nmemb &&
+		    compare(base + r * size, base + (r + 1) * size) == 0)
+		{
+			continue;
+		}
+
+		if (w != r)
+		{
+			memcpy(base + w * size, base + r * size, size);
+		}
+
+		w++;
+	}
+
+	return w;
+}
+
+static size_t merge_pending(const struct FlatArray *flat, void *merged)
+{
+	const size_t size    = flat->size;
+	const KComp  compare = flat->k_comp;
+	const void  *pending = flat->pending;
+	size_t       w       = flat->nmemb + flat->p_nmemb;
+	ssize_t      i       = (ssize_t)flat->nmemb - 1;
+	ssize_t      j       = (ssize_t)flat->p_nmemb - 1;
+
+	// merged already holds the stored elements in sorted order at its front,
+	// so merge from the back and let pending elements replace equal keys
+	while (j >= 0)
+	{
+		const void *p      = pending + j * size;
+		const int   result = (i >= 0) ? compare(merged + i * size, p) : -1;
+
+		w--;
+
+		if (result > 0)
+		{
+			memcpy(merged + w * size, merged + i * size, size);
+			i--;
+		}
+		else
+		{
+			memcpy(merged + w * size, p, size);
+			j--;
+			i -= (result == 0);
+		}
+	}
+
+	if (i >= 0 && (size_t)(i + 1) != w)
+	{
+		memmove(merged + (w - i - 1) * size, merged, (i + 1) * size);
+	}
+
+	return w - (i + 1);
+}
+
+struct FlatArray create_flat(const size_t    k_size,
+                             const size_t    v_size,
+                             const KComp     compare,
+                             const Allocator allocator)
+{
+	const size_t v_offset = node_field_offset(k_size, v_size);
+
+	// rounding to each field's alignment in turn rounds to the larger one
+	const size_t size = node_field_offset(node_field_offset(v_offset + v_size,
+	                                                        k_size),
+	                                      v_size);
+
+	struct FlatArray flat = { .k_size    = k_size,
+		                      .v_size    = v_size,
+		                      .v_offset  = v_offset,
+		                      .size      = size,
+		                      .k_comp    = compare,
+		                      .allocator = allocator };
+
+	return flat;
+}
+
+void destroy_flat(struct FlatArray *flat)
+{
+	memory_free(HEAP_ARRAY, &flat->allocator, flat->array);
+	memory_free(HEAP_ARRAY, &flat->allocator, flat->pending);
+	memory_free(HEAP_ARRAY, &flat->allocator, flat->pairs);
+
+	flat->array   = NULL;
+	flat->pending = NULL;
+	flat->pairs   = NULL;
+}
+
+void flat_insert(struct FlatArray *flat, const void *key, const void *value)
+{
+	CHEAP_ASSERT(key, "Key cannot be NULL.");
+
+	if (flat->p_nmemb >= flat->p_capacity)
+	{
+		generic_mempool_reserve(&flat->allocator,
+		                        &flat->pending,
+		                        &flat->p_capacity,
+		                        flat->size,
+		                        (flat->p_capacity) ? flat->p_capacity *
+		                                                 SEQUENTIAL_GROWTH
+		                                           : SEQUENTIAL_INIT);
+	}
+
+	void *record = flat->pending + flat->p_nmemb * flat->size;
+
+	memcpy(record, key, flat->k_size);
+
+	if (flat->v_size)
+	{
+		memcpy(record + flat->v_offset, value, flat->v_size);
+	}
+
+	flat->p_nmemb++;
+}
+
+void flat_insert_range_set(struct FlatArray *flat, Range range)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		flat_insert(flat, get_range(range), NULL);
+	}
+}
+
+void flat_insert_range_table(struct FlatArray *flat, Range range)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		PairKV *pair = get_range(range);
+
+		flat_insert(flat, pair->key, pair->value);
+	}
+}
+
+void flat_flush(struct FlatArray *flat)
+{
+	if (!flat->p_nmemb)
+	{
+		return;
+	}
+
+	const size_t size = flat->size;
+
+	stable_sort(&flat->allocator,
+	            flat->pending,
+	            flat->p_nmemb,
+	            size,
+	            flat->k_comp);
+
+	flat->p_nmemb = unique_last(flat->pending,
+	                            flat->p_nmemb,
+	                            size,
+	                            flat->k_comp);
+
+	void *merged = generic_mempool_alloc(&flat->allocator,
+	                                     flat->nmemb + flat->p_nmemb,
+	                                     size);
+
+	to_sorted(flat, merged);
+
+	const size_t offset = merge_pending(flat, merged);
+	const size_t nmemb  = flat->nmemb + flat->p_nmemb - offset;
+
+	generic_mempool_reserve(&flat->allocator,
+	                        &flat->array,
+	                        &flat->capacity,
+	                        size,
+	                        nmemb);
+
+	flat->nmemb   = nmemb;
+	flat->p_nmemb = 0;
+
+	from_sorted(flat, merged + offset * size);
+
+	memory_free(HEAP_ARRAY, &flat->allocator, merged);
+}
+
+void flat_erase(struct FlatArray *flat, const void *key)
+{
+	flat_flush(flat);
+
+	const size_t k = search_eytzinger(flat, key);
+
+	if (!k)
+	{
+		return;
+	}
+
+	const size_t size   = flat->size;
+	void        *sorted = generic_mempool_alloc(&flat->allocator,
+	                                            flat->nmemb,
+	                                            size);
+	size_t       index  = 0;
+
+	for (size_t i = first_eytzinger(flat->nmemb); i != k;
+	     i        = next_eytzinger(i, flat->nmemb))
+	{
+		index++;
+	}
+
+	to_sorted(flat, sorted);
+
+	memmove(sorted + index * size,
+	        sorted + (index + 1) * size,
+	        (flat->nmemb - index - 1) * size);
+
+	flat->nmemb--;
+
+	from_sorted(flat, sorted);
+
+	memory_free(HEAP_ARRAY, &flat->allocator, sorted);
+}
+
+void flat_clear(struct FlatArray *flat)
+{
+	flat->nmemb   = 0;
+	flat->p_nmemb = 0;
+}
+
+void *flat_search(struct FlatArray *flat, const void *key)
+{
+	flat_flush(flat);
+
+	const size_t k = search_eytzinger(flat, key);
+
+	return (k) ? slot(flat, k) : NULL;
+}
+
+size_t flat_size(struct FlatArray *flat)
+{
+	flat_flush(flat);
+
+	return flat->nmemb;
+}
+
+static bool table_iterator(const IteratorType type)
+{
+	return type == ITERATOR_FLAT_TABLE || type == ITERATOR_FLAT_TABLE_REVERSE;
+}
+
+static void refresh_pairs(struct FlatArray *flat)
+{
+	// pairs built for an array that has since moved are all stale
+	if (flat->pr_nmemb && flat->pairs->key != flat->array)
+	{
+		flat->pr_nmemb = 0;
+	}
+
+	if (flat->pr_nmemb >= flat->nmemb)
+	{
+		return;
+	}
+
+	generic_mempool_reserve(&flat->allocator,
+	                        (void **)&flat->pairs,
+	                        &flat->pr_capacity,
+	                        sizeof(PairKV),
+	                        flat->capacity);
+
+	for (size_t k = flat->pr_nmemb + 1; k <= flat->nmemb; k++)
+	{
+		void *key = slot(flat, k);
+
+		flat->pairs[k - 1] = (PairKV){ .key   = key,
+			                           .value = key + flat->v_offset };
+	}
+
+	flat->pr_nmemb = flat->nmemb;
+}
+
+Iter begin_flat(const IteratorType type, struct FlatArray *flat)
+{
+	flat_flush(flat);
+
+	if (table_iterator(type))
+	{
+		refresh_pairs(flat);
+	}
+
+	Iter iter = {
+		.type      = type,
+		.data.flat = { .flat = flat, .index = first_eytzinger(flat->nmemb) }
+	};
+
+	return iter;
+}
+
+Iter end_flat(const IteratorType type, struct FlatArray *flat)
+{
+	Iter iter = {
+		.type      = type,
+		.data.flat = { .flat = flat, .index = 0 }
+	};
+
+	return iter;
+}
+
+Iter rbegin_flat(const IteratorType type, struct FlatArray *flat)
+{
+	flat_flush(flat);
+
+	if (table_iterator(type))
+	{
+		refresh_pairs(flat);
+	}
+
+	Iter iter = {
+		.type      = type,
+		.data.flat = { .flat = flat, .index = last_eytzinger(flat->nmemb) }
+	};
+
+	return iter;
+}
+
+Iter rend_flat(const IteratorType type, struct FlatArray *flat)
+{
+	Iter iter = {
+		.type      = type,
+		.data.flat = { .flat = flat, .index = 0 }
+	};
+
+	return iter;
+}
+
+void next_flat(Iter *iter)
+{
+	const struct FlatArray *flat = iter->data.flat.flat;
+
+	iter->data.flat.index = next_eytzinger(iter->data.flat.index, flat->nmemb);
+}
+
+void prev_flat(Iter *iter)
+{
+	const struct FlatArray *flat = iter->data.flat.flat;
+
+	iter->data.flat.index = prev_eytzinger(iter->data.flat.index, flat->nmemb);
+}
+
+void *get_flat_set(const Iter iter)
+{
+	return slot(iter.data.flat.flat, iter.data.flat.index);
+}
+
+void *get_flat_table(const Iter iter)
+{
+	return &iter.data.flat.flat->pairs[iter.data.flat.index - 1];
+}
@@ -145,11 +145,60 @@ void clear_singly_linked(struct NodeAlloc         *alloc,
                          struct SingleLinkedNode **sentinel,
                          size_t                   *nmemb)
 {
-	clear_nodes(alloc);
+	// a shared allocator holds nodes of other containers, so only this
+	// list's nodes may be returned to it
+	if (shared_node_allocator(alloc))
+	{
+		while (*head)
+		{
+			struct SingleLinkedNode *next = (*head)->next;
+
+			free_node(alloc, *head);
+
+			*head = next;
+		}
+
+		(*sentinel)->next = NULL;
+	}
+	else
+	{
+		clear_nodes(alloc);
+
+		*sentinel = create_sentinel_node(alloc);
+	}
+
+	*nmemb = 0;
+	*head  = NULL;
+}
+
+void compact_singly_linked(struct NodeAlloc         *alloc,
+                           const size_t              nmemb,
+                           struct SingleLinkedNode **head,
+                           struct SingleLinkedNode **sentinel)
+{
+	if (shared_node_allocator(alloc))
+	{
+		return;
+	}
+
+	struct NodePage         *pages = detach_node_pages(alloc, nmemb + 1);
+	struct SingleLinkedNode *prev  = clone_node(alloc, *sentinel);
+
+	*sentinel = prev;
+
+	for (struct SingleLinkedNode *node = *head; node; node = node->next)
+	{
+		struct SingleLinkedNode *copy = clone_node(alloc, node);
+
+		copy->value = (void *)copy + sizeof(struct SingleLinkedNode);
+		prev->next  = copy;
+
+		prev = copy;
+	}
+
+	*head = (*sentinel)->next;
 
-	*nmemb    = 0;
-	*head     = NULL;
-	*sentinel = create_sentinel_node(alloc);
+	release_node_pages(alloc, pages);
 }
 
 void *access_singly_linked(struct SingleLinkedNode *node)
@@ -1,4 +1,5 @@
 #include "../../internals/hash.h"
+#include "../../internals/base.h"
 #include "../../internals/cassert.h"
 #include <memory.h>
 
@@ -7,6 +8,8 @@
 #define LF_UPPER_THRESHOLD 0.75f
 #define LF_LOWER_THRESHOLD 0.1f
 
+// unset buckets have every byte set, rather than zeroed as in base.h
+#undef UNSET
 #define UNSET     (-1)
 #define INVALID   UNSET
 #define NOT_FOUND INVALID
@@ -157,9 +160,10 @@ static struct Bucket create_bucket(const Hash        hash,
                                    const void       *value,
                                    const size_t      v_size)
 {
-	void *memory = alloc_node(alloc);
-	void *k      = memory;
-	void *v      = (value) ? memory + k_size : NULL;
+	void        *memory = alloc_node(alloc);
+	void        *k      = memory;
+	const size_t offset = node_field_offset(k_size, v_size);
+	void        *v      = (value) ? memory + offset : NULL;
 
 	memcpy(k, key, k_size);
 
@@ -177,16 +181,15 @@ static struct Bucket create_bucket(const Hash        hash,
 	return bucket;
 }
 
-static void initialise_buckets(struct Bucket **buckets, size_t *capacity)
+static void initialise_buckets(const Allocator *allocator,
+                               struct Bucket  **buckets,
+                               size_t          *capacity)
 {
-	if (*buckets)
-	{
-		free(*buckets);
-	}
+	memory_free(HEAP_HASH, allocator, *buckets);
 
 	*capacity         = TABLE_MIN;
 	const size_t size = *capacity * sizeof(struct Bucket);
-	*buckets          = malloc(size);
+	*buckets          = memory_alloc(HEAP_HASH, allocator, size);
 
 	memset(*buckets, UNSET, size);
 }
@@ -242,38 +245,33 @@ static float get_resize_factor(const size_t nmemb,
 	return factor;
 }
 
-static void resize_buckets(struct Bucket **buckets,
-                           KComp           k_comp,
-                           size_t         *capacity,
-                           const float     factor)
+static void resize_buckets(const Allocator *allocator,
+                           struct Bucket  **buckets,
+                           KComp            k_comp,
+                           size_t          *capacity,
+                           const float      factor)
 {
 	CHEAP_ASSERT(*buckets, "Buckets cannot be NULL.");
 
 	size_t old_capacity = *capacity;
 	size_t new_capacity = (size_t)((float)old_capacity * factor);
-	size_t t_size       = old_capacity * sizeof(struct Bucket);
 	size_t m_size       = new_capacity * sizeof(struct Bucket);
 	*capacity           = new_capacity;
-	struct Bucket *tmp  = malloc(t_size);
-
-	CHEAP_ASSERT(tmp, "Failed to allocate memory.");
-
-	memcpy(tmp, *buckets, t_size);
-	free(*buckets);
+	struct Bucket *tmp  = *buckets;
 
-	*buckets = malloc(m_size);
-
-	CHEAP_ASSERT(*buckets, "Failed to allocate memory,");
+	// the old buckets are only read while reindexing, so no copy is needed
+	*buckets = memory_alloc(HEAP_HASH, allocator, m_size);
 
 	memset(*buckets, UNSET, m_size);
 	reindex_buckets(*buckets, tmp, k_comp, old_capacity, new_capacity);
-	free(tmp);
+	memory_free(HEAP_HASH, allocator, tmp);
 }
 
-static void should_resize(struct Bucket **buckets,
-                          const KComp     k_comp,
-                          const size_t    nmemb,
-                          size_t         *capacity)
+static void should_resize(const Allocator *allocator,
+                          struct Bucket  **buckets,
+                          const KComp      k_comp,
+                          const size_t     nmemb,
+                          size_t          *capacity)
 {
 	float resize_factor = get_resize_factor(nmemb,
 	                                        *capacity,
@@ -281,11 +279,11 @@ static void should_resize(struct Bucket **buckets,
 
 	if (!*buckets)
 	{
-		initialise_buckets(buckets, capacity);
+		initialise_buckets(allocator, buckets, capacity);
 	}
 	else if (resize_factor)
 	{
-		resize_buckets(buckets, k_comp, capacity, resize_factor);
+		resize_buckets(allocator, buckets, k_comp, capacity, resize_factor);
 	}
 }
 
@@ -300,7 +298,7 @@ void hash_insert(struct Bucket   **buckets,
                  const void       *key,
                  const void       *value)
 {
-	should_resize(buckets, k_comp, *nmemb, capacity);
+	should_resize(&alloc->allocator, buckets, k_comp, *nmemb, capacity);
 
 	CHEAP_ASSERT(buckets, "Buckets cannot be NULL.");
 
@@ -326,13 +324,14 @@ void hash_insert(struct Bucket   **buckets,
 	}
 }
 
-void hash_erase(struct Bucket **buckets,
-                const HashFnc   fnc,
-                const size_t    k_size,
-                const KComp     k_comp,
-                size_t         *nmemb,
-                size_t         *capacity,
-                const void     *key)
+void hash_erase(struct Bucket   **buckets,
+                struct NodeAlloc *alloc,
+                const HashFnc     fnc,
+                const size_t      k_size,
+                const KComp       k_comp,
+                size_t           *nmemb,
+                size_t           *capacity,
+                const void       *key)
 {
 	size_t index = find_bucket(*buckets, fnc, k_size, k_comp, *capacity, key);
 
@@ -341,7 +340,10 @@ void hash_erase(struct Bucket **buckets,
 		struct Bucket *bucket_erase = &(*buckets)[index];
 		bucket_erase->tombstone     = true;
 		(*nmemb)--;
-		should_resize(buckets, k_comp, *nmemb, capacity);
+
+		// the key heads the node and is never read through a tombstone
+		free_node(alloc, (void *)bucket_erase->pair.key);
+		should_resize(&alloc->allocator, buckets, k_comp, *nmemb, capacity);
 	}
 }
 
@@ -350,13 +352,26 @@ void hash_clear(struct Bucket   **buckets,
                 size_t           *nmemb,
                 size_t           *capacity)
 {
-	if (*buckets)
+	// a shared allocator holds nodes of other containers, so only this
+	// table's nodes may be returned to it
+	if (shared_node_allocator(alloc))
 	{
-		free(*buckets);
-		*buckets = NULL;
+		for (size_t i = 0; i < *capacity; i++)
+		{
+			if (key_exists(*buckets, i))
+			{
+				free_node(alloc, (void *)(*buckets)[i].pair.key);
+			}
+		}
 	}
+	else
+	{
+		clear_nodes(alloc);
+	}
+
+	memory_free(HEAP_HASH, &alloc->allocator, *buckets);
 
-	clear_nodes(alloc);
+	*buckets = NULL;
 
 	*capacity = 0;
 	*nmemb    = 0;
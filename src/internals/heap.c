@@ -0,0 +1,180 @@
+#include "../../internals/heap.h"
+#include "../../internals/cassert.h"
+#include <assert.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+enum HeapCall
+{
+	CALL_ALLOC,
+	CALL_REALLOC,
+	CALL_FREE,
+	HEAP_CALLS
+};
+
+struct HeapCounter
+{
+	atomic_size_t calls[HEAP_CALLS];
+	atomic_size_t live;
+	atomic_size_t peak;
+};
+
+static HeapHooks hooks = { .malloc        = malloc,
+	                       .calloc        = calloc,
+	                       .realloc       = realloc,
+	                       .aligned_alloc = aligned_alloc,
+	                       .free          = free,
+	                       .usable_size   = malloc_usable_size };
+
+static struct HeapCounter counters[HEAP_TOTAL + 1];
+
+static size_t load_counter(atomic_size_t *counter)
+{
+	return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+static size_t block_size(void *ptr)
+{
+	return (ptr && hooks.usable_size) ? hooks.usable_size(ptr) : 0;
+}
+
+static void raise_peak(atomic_size_t *peak, const size_t live)
+{
+	size_t curr = atomic_load_explicit(peak, memory_order_relaxed);
+
+	while (live > curr &&
+	       !atomic_compare_exchange_weak_explicit(peak,
+	                                              &curr,
+	                                              live,
+	                                              memory_order_relaxed,
+	                                              memory_order_relaxed))
+	{
+	}
+}
+
+static void adjust_live(struct HeapCounter *counter,
+                        const size_t        added,
+                        const size_t        removed)
+{
+	if (added >= removed)
+	{
+		const size_t grown = added - removed;
+		const size_t prev  = atomic_fetch_add_explicit(&counter->live,
+		                                               grown,
+		                                               memory_order_relaxed);
+
+		raise_peak(&counter->peak, prev + grown);
+	}
+	else
+	{
+		atomic_fetch_sub_explicit(&counter->live,
+		                          removed - added,
+		                          memory_order_relaxed);
+	}
+}
+
+// counts the call and the change in bytes for the subsystem and the total
+static void record(const HeapSubsystem subsystem,
+                   const enum HeapCall call,
+                   const size_t        added,
+                   const size_t        removed)
+{
+	assert(subsystem < HEAP_TOTAL);
+
+	struct HeapCounter *counted[] = { &counters[subsystem],
+		                              &counters[HEAP_TOTAL] };
+
+	for (size_t i = 0; i < sizeof(counted) / sizeof(*counted); i++)
+	{
+		atomic_fetch_add_explicit(&counted[i]->calls[call],
+		                          1,
+		                          memory_order_relaxed);
+
+		adjust_live(counted[i], added, removed);
+	}
+}
+
+void set_heap_hooks(const HeapHooks *replacement)
+{
+	CHEAP_ASSERT(replacement->malloc && replacement->calloc &&
+	                 replacement->realloc && replacement->aligned_alloc &&
+	                 replacement->free,
+	             "Heap hooks must set every function but usable_size.");
+
+	CHEAP_ASSERT(!load_counter(&counters[HEAP_TOTAL].calls[CALL_ALLOC]) &&
+	                 !load_counter(&counters[HEAP_TOTAL].calls[CALL_REALLOC]),
+	             "Heap hooks must be set before the first allocation.");
+
+	hooks = *replacement;
+}
+
+HeapStats heap_stats(const HeapSubsystem subsystem)
+{
+	CHEAP_ASSERT(subsystem <= HEAP_TOTAL, "Unknown heap subsystem.");
+
+	struct HeapCounter *counter = &counters[subsystem];
+
+	return (HeapStats){ .live     = load_counter(&counter->live),
+		                .peak     = load_counter(&counter->peak),
+		                .allocs   = load_counter(&counter->calls[CALL_ALLOC]),
+		                .reallocs = load_counter(&counter->calls[CALL_REALLOC]),
+		                .frees    = load_counter(&counter->calls[CALL_FREE]) };
+}
+
+void *heap_malloc(const HeapSubsystem subsystem, const size_t size)
+{
+	void *ptr = hooks.malloc(size);
+
+	record(subsystem, CALL_ALLOC, block_size(ptr), 0);
+
+	return ptr;
+}
+
+void *heap_calloc(const HeapSubsystem subsystem,
+                  const size_t        nmemb,
+                  const size_t        size)
+{
+	void *ptr = hooks.calloc(nmemb, size);
+
+	record(subsystem, CALL_ALLOC, block_size(ptr), 0);
+
+	return ptr;
+}
+
+void *heap_realloc(const HeapSubsystem subsystem, void *ptr, const size_t size)
+{
+	const size_t old = block_size(ptr);
+	void        *tmp = hooks.realloc(ptr, size);
+
+	// a failed realloc leaves the block as it was
+	record(subsystem,
+	       CALL_REALLOC,
+	       block_size(tmp),
+	       (tmp || !size) ? old : 0);
+
+	return tmp;
+}
+
+void *heap_aligned_alloc(const HeapSubsystem subsystem,
+                         const size_t        align,
+                         const size_t        size)
+{
+	void *ptr = hooks.aligned_alloc(align, size);
+
+	record(subsystem, CALL_ALLOC, block_size(ptr), 0);
+
+	return ptr;
+}
+
+void heap_free(const HeapSubsystem subsystem, void *ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	record(subsystem, CALL_FREE, 0, block_size(ptr));
+
+	hooks.free(ptr);
+}
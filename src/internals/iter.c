@@ -22,6 +22,22 @@ extern void  prev_rbtree(Iter *iter);
 extern void *get_rbtree_set(Iter iter);
 extern void *get_rbtree_table(Iter iter);
 
+extern void  next_rbtree_snapshot(Iter *iter);
+extern void  prev_rbtree_snapshot(Iter *iter);
+extern void *get_rbtree_snapshot(Iter iter);
+
+extern void  next_itree(Iter *iter);
+extern void *get_itree(Iter iter);
+
+extern void  next_flat(Iter *iter);
+extern void  prev_flat(Iter *iter);
+extern void *get_flat_set(Iter iter);
+extern void *get_flat_table(Iter iter);
+
+extern void  next_art(Iter *iter);
+extern void  prev_art(Iter *iter);
+extern void *get_art_table(Iter iter);
+
 extern void  next_deque(Iter *iter);
 extern void  prev_deque(Iter *iter);
 extern void *get_deque(Iter iter);
@@ -50,6 +66,19 @@ void next_iter(Iter *iter)
 		case ITERATOR_TABLE:
 		case ITERATOR_TABLE_REVERSE:
 			return next_rbtree(iter);
+		case ITERATOR_TABLE_SNAPSHOT:
+		case ITERATOR_TABLE_SNAPSHOT_REVERSE:
+			return next_rbtree_snapshot(iter);
+		case ITERATOR_INTERVAL:
+			return next_itree(iter);
+		case ITERATOR_FLAT_SET:
+		case ITERATOR_FLAT_SET_REVERSE:
+		case ITERATOR_FLAT_TABLE:
+		case ITERATOR_FLAT_TABLE_REVERSE:
+			return next_flat(iter);
+		case ITERATOR_ART_TABLE:
+		case ITERATOR_ART_TABLE_REVERSE:
+			return next_art(iter);
 		case ITERATOR_DEQUE:
 		case ITERATOR_DEQUE_REVERSE:
 			return next_deque(iter);
@@ -84,6 +113,17 @@ void prev_iter(Iter *iter)
 		case ITERATOR_TABLE:
 		case ITERATOR_TABLE_REVERSE:
 			return prev_rbtree(iter);
+		case ITERATOR_TABLE_SNAPSHOT:
+		case ITERATOR_TABLE_SNAPSHOT_REVERSE:
+			return prev_rbtree_snapshot(iter);
+		case ITERATOR_FLAT_SET:
+		case ITERATOR_FLAT_SET_REVERSE:
+		case ITERATOR_FLAT_TABLE:
+		case ITERATOR_FLAT_TABLE_REVERSE:
+			return prev_flat(iter);
+		case ITERATOR_ART_TABLE:
+		case ITERATOR_ART_TABLE_REVERSE:
+			return prev_art(iter);
 		case ITERATOR_DEQUE:
 		case ITERATOR_DEQUE_REVERSE:
 			return prev_deque(iter);
@@ -134,6 +174,20 @@ void *get_iter(const Iter iter)
 		case ITERATOR_TABLE:
 		case ITERATOR_TABLE_REVERSE:
 			return get_rbtree_table(iter);
+		case ITERATOR_TABLE_SNAPSHOT:
+		case ITERATOR_TABLE_SNAPSHOT_REVERSE:
+			return get_rbtree_snapshot(iter);
+		case ITERATOR_INTERVAL:
+			return get_itree(iter);
+		case ITERATOR_FLAT_SET:
+		case ITERATOR_FLAT_SET_REVERSE:
+			return get_flat_set(iter);
+		case ITERATOR_FLAT_TABLE:
+		case ITERATOR_FLAT_TABLE_REVERSE:
+			return get_flat_table(iter);
+		case ITERATOR_ART_TABLE:
+		case ITERATOR_ART_TABLE_REVERSE:
+			return get_art_table(iter);
 		case ITERATOR_DEQUE:
 		case ITERATOR_DEQUE_REVERSE:
 			return get_deque(iter);
@@ -163,6 +217,15 @@ bool done_iter(const Iter begin, const Iter end)
 		case ITERATOR_SET:
 		case ITERATOR_TABLE:
 			return begin.data.balanced.node == end.data.balanced.node;
+		case ITERATOR_TABLE_SNAPSHOT:
+			return begin.data.snapshot.node == end.data.snapshot.node;
+		case ITERATOR_INTERVAL:
+			return begin.data.interval.node == end.data.interval.node;
+		case ITERATOR_FLAT_SET:
+		case ITERATOR_FLAT_TABLE:
+			return begin.data.flat.index == end.data.flat.index;
+		case ITERATOR_ART_TABLE:
+			return begin.data.art.leaf == end.data.art.leaf;
 		case ITERATOR_DEQUE:
 			return begin.data.deque.index == end.data.deque.index;
 		default:
@@ -189,6 +252,13 @@ bool done_iter_r(const Iter begin, const Iter end)
 		case ITERATOR_SET_REVERSE:
 		case ITERATOR_TABLE_REVERSE:
 			return begin.data.balanced.node == end.data.balanced.node;
+		case ITERATOR_TABLE_SNAPSHOT_REVERSE:
+			return begin.data.snapshot.node == end.data.snapshot.node;
+		case ITERATOR_FLAT_SET_REVERSE:
+		case ITERATOR_FLAT_TABLE_REVERSE:
+			return begin.data.flat.index == end.data.flat.index;
+		case ITERATOR_ART_TABLE_REVERSE:
+			return begin.data.art.leaf == end.data.art.leaf;
 		case ITERATOR_DEQUE_REVERSE:
 			return begin.data.deque.index == end.data.deque.index;
 		default:
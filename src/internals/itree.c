@@ -0,0 +1,236 @@
+#include "../../internals/itree.h"
+#include <assert.h>
+#include <memory.h>
+
+static void *node_lo(const struct TreeNode *node)
+{
+	return (void *)(node + 1);
+}
+
+static void *node_hi(const struct TreeNode *node, const size_t e_size)
+{
+	return (void *)(node + 1) + e_size;
+}
+
+static void *node_max(const struct TreeNode *node, const size_t e_size)
+{
+	return (void *)(node + 1) + 2 * e_size;
+}
+
+static void *node_value(const struct TreeNode *node,
+                        const size_t           e_size,
+                        const size_t           v_size)
+{
+	return (void *)(node + 1) + node_field_offset(3 * e_size, v_size);
+}
+
+static void update_max(struct TreeNode *node, Comp compare, const size_t e_size)
+{
+	const void *max = node_hi(node, e_size);
+
+	if (node->left && compare(node_max(node->left, e_size), max) > 0)
+	{
+		max = node_max(node->left, e_size);
+	}
+
+	if (node->right && compare(node_max(node->right, e_size), max) > 0)
+	{
+		max = node_max(node->right, e_size);
+	}
+
+	memcpy(node_max(node, e_size), max, e_size);
+}
+
+// A rotation only moves nodes onto the path from the change to the root, or
+// just below it with their own subtrees intact, so refreshing each node on the
+// path and its children restores every maximum.
+static void repair_path(struct TreeNode *node,
+                        Comp             compare,
+                        const size_t     e_size)
+{
+	while (node)
+	{
+		if (node->left)
+		{
+			update_max(node->left, compare, e_size);
+		}
+
+		if (node->right)
+		{
+			update_max(node->right, compare, e_size);
+		}
+
+		update_max(node, compare, e_size);
+
+		node = rbt_parent(node);
+	}
+}
+
+static bool overlaps(const struct TreeNode         *node,
+                     const struct IteratorInterval *q)
+{
+	return !q->lo || (q->order->compare(node_lo(node), q->hi) <= 0 &&
+	                  q->order->compare(node_hi(node, q->order->e_size),
+	                                    q->lo) >= 0);
+}
+
+// whether any interval in the subtree ends at or after the query begins
+static bool reaches(const struct TreeNode         *node,
+                    const struct IteratorInterval *q)
+{
+	return node &&
+	       (!q->lo ||
+	        q->order->compare(node_max(node, q->order->e_size), q->lo) >= 0);
+}
+
+// whether this and every later interval begins after the query ends
+static bool beyond(const struct TreeNode         *node,
+                   const struct IteratorInterval *q)
+{
+	return q->lo && q->order->compare(node_lo(node), q->hi) > 0;
+}
+
+// the first node in key order whose left subtree cannot reach the query
+static struct TreeNode *leftmost(struct TreeNode               *node,
+                                 const struct IteratorInterval *q)
+{
+	while (reaches(node->left, q))
+	{
+		node = node->left;
+	}
+
+	return node;
+}
+
+// The next node of the walk in key order, skipping every subtree that ends
+// before the query. Parent links stand in for the
+// stack of an in-order walk, so each edge is taken at most once each way.
+static struct TreeNode *step(struct TreeNode               *node,
+                             const struct IteratorInterval *q)
+{
+	if (reaches(node->right, q))
+	{
+		return leftmost(node->right, q);
+	}
+
+	struct TreeNode *parent = rbt_parent(node);
+
+	while (parent && node == parent->right)
+	{
+		node   = parent;
+		parent = rbt_parent(parent);
+	}
+
+	return parent;
+}
+
+// the first overlap from node onwards, stopping once intervals begin too late
+static struct TreeNode *walk(struct TreeNode               *node,
+                             const struct IteratorInterval *q)
+{
+	while (node && !beyond(node, q))
+	{
+		if (overlaps(node, q))
+		{
+			return node;
+		}
+
+		node = step(node, q);
+	}
+
+	return NULL;
+}
+
+struct TreeNode *insert_itree(struct NodeAlloc *alloc,
+                              struct TreeNode **head,
+                              const void       *lo,
+                              const void       *hi,
+                              const void       *value,
+                              const Comp        compare,
+                              const size_t      e_size,
+                              const size_t      v_size,
+                              size_t           *nmemb)
+{
+	assert(compare(lo, hi) <= 0);
+
+	// the tree orders by the low endpoint alone, the rest is filled in after
+	struct TreeNode *node = insert_multi_rbtree(alloc,
+	                                            head,
+	                                            lo,
+	                                            NULL,
+	                                            compare,
+	                                            e_size,
+	                                            0,
+	                                            nmemb);
+
+	Interval *interval = (Interval *)node - 1;
+
+	interval->lo    = node_lo(node);
+	interval->hi    = node_hi(node, e_size);
+	interval->value = node_value(node, e_size, v_size);
+
+	memcpy(node_hi(node, e_size), hi, e_size);
+	memcpy(node_max(node, e_size), hi, e_size);
+
+	if (v_size)
+	{
+		memcpy(node_value(node, e_size, v_size), value, v_size);
+	}
+
+	repair_path(node, compare, e_size);
+
+	return node;
+}
+
+bool erase_itree(struct NodeAlloc *alloc,
+                 struct TreeNode **head,
+                 const void       *lo,
+                 const void       *hi,
+                 const Comp        compare,
+                 const size_t      e_size,
+                 const size_t      v_size,
+                 size_t           *nmemb)
+{
+	const struct IteratorInterval all = { .lo = NULL };
+
+	for (struct TreeNode *node = rbt_lower_bound(*head, lo, compare);
+	     node && compare(lo, node_lo(node)) == 0;
+	     node = step(node, &all))
+	{
+		if (compare(hi, node_hi(node, e_size)) == 0)
+		{
+			struct TreeNode *changed = delete_node_rbtree(alloc,
+			                                              head,
+			                                              node,
+			                                              3 * e_size,
+			                                              v_size,
+			                                              nmemb);
+
+			repair_path(changed, compare, e_size);
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void first_itree(struct TreeNode *head, struct IteratorInterval *cursor)
+{
+	struct TreeNode *node = (reaches(head, cursor)) ? leftmost(head, cursor)
+	                                                : NULL;
+
+	cursor->node = walk(node, cursor);
+}
+
+void next_itree(Iter *iter)
+{
+	struct IteratorInterval *cursor = &iter->data.interval;
+
+	cursor->node = walk(step(cursor->node, cursor), cursor);
+}
+
+void *get_itree(const Iter iter)
+{
+	return (Interval *)iter.data.interval.node - 1;
+}
@@ -10,6 +10,10 @@ static struct DoubleLinkedNode *create_node(struct NodeAlloc *alloc,
 	struct DoubleLinkedNode *node   = memory;
 	node->value                     = memory + sizeof(struct DoubleLinkedNode);
 
+	// a recycled node still holds the links it had when it was freed
+	node->next = NULL;
+	node->prev = NULL;
+
 	memcpy(node->value, value, size);
 
 	return node;
@@ -163,17 +167,25 @@ Iter insert_doubly_linked(struct NodeAlloc         *alloc,
 }
 
 void pop_front_doubly_linked(struct NodeAlloc         *alloc,
+                             size_t                   *nmemb,
                              struct DoubleLinkedNode **head,
                              struct DoubleLinkedNode **tail)
 {
+	CHEAP_ASSERT(*nmemb, "Cannot pop an empty list");
+
 	erase(alloc, *head, head, tail);
+	(*nmemb)--;
 }
 
 void pop_back_doubly_linked(struct NodeAlloc         *alloc,
+                            size_t                   *nmemb,
                             struct DoubleLinkedNode **head,
                             struct DoubleLinkedNode **tail)
 {
+	CHEAP_ASSERT(*nmemb, "Cannot pop an empty list");
+
 	erase(alloc, *tail, head, tail);
+	(*nmemb)--;
 }
 
 Iter erase_doubly_linked(struct NodeAlloc         *alloc,
@@ -188,7 +200,7 @@ Iter erase_doubly_linked(struct NodeAlloc         *alloc,
 	struct DoubleLinkedNode *node = pos.data.linked.node;
 	pos.data.linked.node          = erase(alloc, node, head, tail);
 
-	(*nmemb)++;
+	(*nmemb)--;
 
 	return pos;
 }
@@ -198,13 +210,66 @@ void clear_doubly_linked(struct NodeAlloc         *alloc,
                          struct DoubleLinkedNode **tail,
                          size_t                   *nmemb)
 {
-	clear_nodes(alloc);
+	// a shared allocator holds nodes of other containers, so only this
+	// list's nodes may be returned to it
+	if (shared_node_allocator(alloc))
+	{
+		while (*head)
+		{
+			struct DoubleLinkedNode *next = (*head)->next;
+
+			free_node(alloc, *head);
+
+			*head = next;
+		}
+	}
+	else
+	{
+		clear_nodes(alloc);
+	}
 
 	*head = NULL;
 	*tail = NULL;
 	*nmemb = 0;
 }
 
+void compact_doubly_linked(struct NodeAlloc         *alloc,
+                           const size_t              nmemb,
+                           struct DoubleLinkedNode **head,
+                           struct DoubleLinkedNode **tail)
+{
+	if (shared_node_allocator(alloc))
+	{
+		return;
+	}
+
+	struct NodePage         *pages = detach_node_pages(alloc, nmemb);
+	struct DoubleLinkedNode *prev  = NULL;
+
+	for (struct DoubleLinkedNode *node = *head; node; node = node->next)
+	{
+		struct DoubleLinkedNode *copy = clone_node(alloc, node);
+
+		copy->value = (void *)copy + sizeof(struct DoubleLinkedNode);
+		copy->prev  = prev;
+
+		if (prev)
+		{
+			prev->next = copy;
+		}
+		else
+		{
+			*head = copy;
+		}
+
+		prev = copy;
+	}
+
+	*tail = prev;
+
+	release_node_pages(alloc, pages);
+}
+
 void *access_doubly_linked(struct DoubleLinkedNode *node)
 {
 	return node->value;
@@ -4,44 +4,47 @@
 #include "../../iter.h"
 #include <memory.h>
 
-ALLOC static void *mempool_alloc(const size_t nmemb, const size_t size)
+ALLOC static void *mempool_alloc(const Allocator *allocator,
+                                 const size_t     nmemb,
+                                 const size_t     size)
 {
-	void *tmp = malloc(nmemb * size);
-
-	CHEAP_ASSERT(tmp, "Failed to allocate additional memory.");
-
-	return tmp;
+	return memory_alloc(HEAP_ARRAY, allocator, nmemb * size);
 }
 
-ALLOC static void *mempool_realloc(void *array, const size_t size)
+ALLOC static void *mempool_realloc(const Allocator *allocator,
+                                   void            *array,
+                                   const size_t     old_size,
+                                   const size_t     size)
 {
-	void *tmp = realloc(array, size);
-
-	CHEAP_ASSERT(tmp, "Failed to reallocate memory.");
-
-	return tmp;
+	return memory_realloc(HEAP_ARRAY, allocator, array, old_size, size);
 }
 
-ALLOC static void *mempool_resize(void        *array,
-                                  size_t      *capacity,
-                                  const size_t size)
+ALLOC static void *mempool_resize(const Allocator *allocator,
+                                  void            *array,
+                                  size_t          *capacity,
+                                  const size_t     size)
 {
+	const size_t old_size = *capacity * size;
+
 	*capacity = (*capacity > EMPTY) ? *capacity * SEQUENTIAL_GROWTH
 	                                : SEQUENTIAL_INIT;
 
-	return mempool_realloc(array, *capacity * size);
+	return mempool_realloc(allocator, array, old_size, *capacity * size);
 }
 
-ALLOC static void *mempool_range_resize(void        *array,
-                                        size_t      *capacity,
-                                        const size_t size,
-                                        const size_t r_nmemb)
+ALLOC static void *mempool_range_resize(const Allocator *allocator,
+                                        void            *array,
+                                        size_t          *capacity,
+                                        const size_t     size,
+                                        const size_t     r_nmemb)
 {
+	const size_t old_size = *capacity * size;
+
 	*capacity = (*capacity + r_nmemb > *capacity * SEQUENTIAL_GROWTH)
 	                ? *capacity + r_nmemb
 	                : *capacity * SEQUENTIAL_GROWTH;
 
-	return mempool_realloc(array, *capacity * size);
+	return mempool_realloc(allocator, array, old_size, *capacity * size);
 }
 
 static void mempool_insert(void        *array,
@@ -93,45 +96,56 @@ static void mempool_remove(void        *array,
 	        (nmemb - index - 1) * size);
 }
 
-void *generic_mempool_alloc(size_t nmemb, size_t size)
+void *generic_mempool_alloc(const Allocator *allocator,
+                            const size_t     nmemb,
+                            const size_t     size)
 {
-	return mempool_alloc(nmemb, size);
+	return mempool_alloc(allocator, nmemb, size);
 }
 
-void generic_mempool_push_back(void       **array,
-                               const void  *value,
-                               size_t      *capacity,
-                               size_t      *nmemb,
-                               const size_t size)
+void generic_mempool_push_back(const Allocator *allocator,
+                               void           **array,
+                               const void      *value,
+                               size_t          *capacity,
+                               size_t          *nmemb,
+                               const size_t     size)
 {
 	CHEAP_ASSERT(value, "Value cannot be NULL.");
 
-	generic_mempool_insert(array, value, *nmemb, capacity, nmemb, size);
+	generic_mempool_insert(allocator,
+	                       array,
+	                       value,
+	                       *nmemb,
+	                       capacity,
+	                       nmemb,
+	                       size);
 }
 
-void generic_mempool_push_front(void       **array,
-                                const void  *value,
-                                size_t      *capacity,
-                                size_t      *nmemb,
-                                const size_t size)
+void generic_mempool_push_front(const Allocator *allocator,
+                                void           **array,
+                                const void      *value,
+                                size_t          *capacity,
+                                size_t          *nmemb,
+                                const size_t     size)
 {
 	CHEAP_ASSERT(value, "Value cannot be NULL.");
 
-	generic_mempool_insert(array, value, 0, capacity, nmemb, size);
+	generic_mempool_insert(allocator, array, value, 0, capacity, nmemb, size);
 }
 
-void generic_mempool_insert(void       **array,
-                            const void  *value,
-                            const size_t index,
-                            size_t      *capacity,
-                            size_t      *nmemb,
-                            const size_t size)
+void generic_mempool_insert(const Allocator *allocator,
+                            void           **array,
+                            const void      *value,
+                            const size_t     index,
+                            size_t          *capacity,
+                            size_t          *nmemb,
+                            const size_t     size)
 {
 	CHEAP_ASSERT(value, "Value cannot be NULL.");
 
 	if (*nmemb >= *capacity)
 	{
-		*array = mempool_resize(*array, capacity, size);
+		*array = mempool_resize(allocator, *array, capacity, size);
 	}
 
 	mempool_insert(*array, index, value, *nmemb, size);
@@ -150,12 +164,13 @@ void generic_mempool_set(void        *array,
 	mempool_set(array, value, index, size);
 }
 
-void generic_mempool_range_insert(void       **array,
-                                  size_t index,
-                                  size_t      *capacity,
-                                  size_t      *nmemb,
-                                  const size_t size,
-                                  Range       range)
+void generic_mempool_range_insert(const Allocator *allocator,
+                                  void           **array,
+                                  size_t           index,
+                                  size_t          *capacity,
+                                  size_t          *nmemb,
+                                  const size_t     size,
+                                  Range            range)
 {
 	bool forward = range.begin.type < ITERATOR_REVERSE;
 	bool (*done)(Range) = (forward) ? done_range : done_range_r;
@@ -164,7 +179,13 @@ void generic_mempool_range_insert(void       **array,
 	for (; !done(range); iterate(&range.begin))
 	{
 		void *value = get_range(range);
-		generic_mempool_insert(array, value, index, capacity, nmemb, size);
+		generic_mempool_insert(allocator,
+		                       array,
+		                       value,
+		                       index,
+		                       capacity,
+		                       nmemb,
+		                       size);
 		index++;
 	}
 }
@@ -224,27 +245,35 @@ void *generic_mempool_random_access(void        *array,
 	return mempool_random_access(array, index, size);
 }
 
-void generic_mempool_reserve(void       **array,
-                             size_t      *capacity,
-                             const size_t size,
-                             const size_t new_cap)
+void generic_mempool_reserve(const Allocator *allocator,
+                             void           **array,
+                             size_t          *capacity,
+                             const size_t     size,
+                             const size_t     new_cap)
 {
 	if (new_cap > *capacity)
 	{
-		*array    = mempool_realloc(*array, new_cap * size);
+		*array    = mempool_realloc(allocator,
+		                            *array,
+		                            *capacity * size,
+		                            new_cap * size);
 		*capacity = new_cap;
 	}
 }
 
-void generic_mempool_shrink_to_fit(void       **array,
-                                   size_t      *capacity,
-                                   const size_t nmemb,
-                                   const size_t size)
+void generic_mempool_shrink_to_fit(const Allocator *allocator,
+                                   void           **array,
+                                   size_t          *capacity,
+                                   const size_t     nmemb,
+                                   const size_t     size)
 {
 	if (nmemb < *capacity)
 	{
+		*array    = mempool_realloc(allocator,
+		                            *array,
+		                            *capacity * size,
+		                            nmemb * size);
 		*capacity = nmemb;
-		*array    = mempool_realloc(*array, *capacity * size);
 	}
 }
 
@@ -1,54 +1,164 @@
 #include "../../internals/nalloc.h"
+#include "../../internals/base.h"
 #include <assert.h>
 #include <malloc.h>
+#include <memory.h>
+#include <stdint.h>
+
+// pages stop doubling once they reach this size
+#define PAGE_BYTES_MAX (64 * 1024)
 
 struct NodeBlock
 {
 	struct NodeBlock *next;
 };
 
-struct NodePage
+// Slots are size bytes apart and start bias bytes past a multiple of align, so
+// that whatever follows the header bytes of the node lands on the alignment of
+// its fields.
+struct NodeLayout
 {
-	void  *pool;
-	size_t cursor;
-	size_t max;
 	size_t size;
+	size_t align;
+	size_t bias;
+	size_t header;
+};
+
+struct NodePage
+{
+	void             *pool;
+	size_t            cursor;
+	size_t            max;
+	struct NodeLayout layout;
 
 	struct NodePage *prev;
 };
 
+// one shared allocator per slot layout, searched in order
+struct NodePool
+{
+	struct NodeAlloc **allocs;
+	size_t             nmemb;
+	Allocator          allocator;
+};
+
+struct NodeEpoch
+{
+	struct NodeEpoch *older;
+	struct NodeAlloc *allocator;
+	void            **retired;
+	size_t            r_nmemb;
+	size_t            r_capacity;
+	atomic_bool       closed;
+};
+
 static size_t growth_policy(const size_t x)
 {
 	return x * 2;
 }
 
-static struct NodePage *create_page(struct NodePage *prev,
-                                    const size_t     nmemb,
-                                    const size_t     size)
+static size_t page_growth(const struct NodePage *page)
+{
+	const size_t limit = PAGE_BYTES_MAX / page->layout.size;
+	const size_t nmemb = growth_policy(page->max);
+
+	if (nmemb <= limit)
+	{
+		return nmemb;
+	}
+
+	// a first page that was asked for larger than the cap keeps its size
+	return (page->max > limit) ? page->max : limit;
+}
+
+static size_t round_up(const size_t size, const size_t align)
 {
-	void *mem = calloc(1, sizeof(struct NodePage) + nmemb * size);
+	return (size + align - 1) & ~(align - 1);
+}
+
+static struct NodeLayout slot_layout(const size_t node_size,
+                                     const size_t t1_size,
+                                     const size_t t2_size)
+{
+	// every slot must be able to hold a free block, and node headers and free
+	// blocks must stay on a pointer boundary
+	size_t align = _Alignof(struct NodeBlock);
+
+	if (node_field_align(t1_size) > align)
+	{
+		align = node_field_align(t1_size);
+	}
+
+	if (node_field_align(t2_size) > align)
+	{
+		align = node_field_align(t2_size);
+	}
+
+	size_t size = node_size + node_field_offset(t1_size, t2_size) + t2_size;
+
+	size = round_up((size > sizeof(struct NodeBlock))
+	                    ? size
+	                    : sizeof(struct NodeBlock),
+	                align);
 
-	assert(mem);
+	// a small slot is rounded up to a power of two when that wastes no more
+	// than a quarter of it, so slots line up with cache lines and none spans
+	// two of them
+	const size_t bias = (align - node_size % align) % align;
+	const size_t pow2 = (size_t)1 << (sizeof(unsigned long) * 8 -
+	                                  __builtin_clzl(size - 1));
+
+	if (!bias && size < CACHE_LINE_SIZE && pow2 - size <= size / 4)
+	{
+		size  = pow2;
+		align = pow2;
+	}
+
+	return (struct NodeLayout){ .size   = size,
+		                        .align  = align,
+		                        .bias   = bias,
+		                        .header = node_size };
+}
+
+// the header is compared as well, as containers read their nodes through it
+static bool same_layout(const struct NodeLayout *a, const struct NodeLayout *b)
+{
+	return a->size == b->size && a->align == b->align && a->bias == b->bias &&
+	       a->header == b->header;
+}
+
+static struct NodePage *create_page(const Allocator        *allocator,
+                                    struct NodePage        *prev,
+                                    const size_t            nmemb,
+                                    const struct NodeLayout layout)
+{
+	void *mem = memory_calloc(HEAP_NODES,
+	                          allocator,
+	                          sizeof(struct NodePage) + layout.align - 1 +
+	                              nmemb * layout.size);
 
 	struct NodePage *page = mem;
 	void            *pool = mem + sizeof(struct NodePage);
 
+	pool += (layout.bias - (uintptr_t)pool) & (layout.align - 1);
+
 	*page = (struct NodePage){ .pool   = pool,
 		                       .cursor = 0,
 		                       .max    = nmemb,
-		                       .size   = size,
+		                       .layout = layout,
 		                       .prev   = prev };
 
 	return page;
 }
 
-static struct NodePage *destroy_page(struct NodePage *page)
+static struct NodePage *destroy_page(const Allocator *allocator,
+                                     struct NodePage *page)
 {
 	assert(page);
 
 	struct NodePage *prev = page->prev;
 
-	free(page);
+	memory_free(HEAP_NODES, allocator, page);
 
 	return prev;
 }
@@ -64,89 +174,192 @@ static void *search_freeblocks(struct NodeBlock **blocks)
 	return ptr;
 }
 
-static void *page_allocate(struct NodePage **page)
+// keeps the larger of an emptied page and the spare
+static void retain_page(struct NodeAlloc *alloc, struct NodePage *page)
 {
-	assert(*page);
+	if (alloc->spare && alloc->spare->max >= page->max)
+	{
+		destroy_page(&alloc->allocator, page);
 
-	struct NodePage *curr = *page;
+		return;
+	}
+
+	if (alloc->spare)
+	{
+		destroy_page(&alloc->allocator, alloc->spare);
+	}
+
+	alloc->spare = page;
+}
+
+static struct NodePage *next_page(struct NodeAlloc *alloc,
+                                  struct NodePage  *curr)
+{
+	struct NodePage *page = alloc->spare;
+
+	if (!page)
+	{
+		return create_page(&alloc->allocator,
+		                   curr,
+		                   page_growth(curr),
+		                   curr->layout);
+	}
+
+	alloc->spare = NULL;
+
+	page->cursor = 0;
+	page->prev   = curr;
+
+	return page;
+}
+
+static void *page_allocate(struct NodeAlloc *alloc)
+{
+	assert(alloc->pages);
+
+	struct NodePage *curr = alloc->pages;
 
 	if (curr->cursor >= curr->max)
 	{
-		*page = create_page(curr, growth_policy(curr->max), curr->size);
+		alloc->pages = next_page(alloc, curr);
 
-		curr = *page;
+		curr = alloc->pages;
 	}
 
-	void *ptr = curr->pool + curr->cursor * curr->size;
+	void *ptr = curr->pool + curr->cursor * curr->layout.size;
 
 	curr->cursor++;
 
 	return ptr;
 }
 
-static void *allocate_memory(struct NodeBlock **blocks, struct NodePage **page)
+static void *allocate_memory(struct NodeAlloc *alloc)
 {
-	assert(page);
-
 	void *ptr = NULL;
 
-	if (*blocks)
+	if (alloc->blocks)
 	{
-		ptr = search_freeblocks(blocks);
+		ptr = search_freeblocks(&alloc->blocks);
 	}
 	else
 	{
-		ptr = page_allocate(page);
+		ptr = page_allocate(alloc);
 	}
 
 	return ptr;
 }
 
-static void free_memory(struct NodePage  **page,
-                        struct NodeBlock **blocks,
-                        void              *ptr)
+static void free_memory(struct NodeAlloc *alloc, void *ptr)
 {
-	struct NodePage *curr = *page;
+	struct NodePage *curr = alloc->pages;
 
-	static int i = 0;
-
-	if (curr->pool + (curr->cursor - 1) * curr->size == ptr)
+	if (curr->pool + (curr->cursor - 1) * curr->layout.size == ptr)
 	{
 		curr->cursor--;
 
 		if (!curr->cursor && curr->prev)
 		{
-			*page = destroy_page(curr);
+			alloc->pages = curr->prev;
+
+			retain_page(alloc, curr);
 		}
 	}
 	else
 	{
 		struct NodeBlock *block = ptr;
 
-		block->next = *blocks;
+		block->next = alloc->blocks;
 
-		*blocks = block;
+		alloc->blocks = block;
 	}
 }
 
+static void queue_retired(struct NodeEpoch *epoch, void *ptr)
+{
+	if (epoch->r_nmemb >= epoch->r_capacity)
+	{
+		const size_t capacity = (epoch->r_capacity)
+		                            ? growth_policy(epoch->r_capacity)
+		                            : NODE_COUNT_DEFAULT;
+
+		epoch->retired    = memory_realloc(HEAP_NODES,
+		                                   &epoch->allocator->allocator,
+		                                   epoch->retired,
+		                                   epoch->r_capacity * sizeof(void *),
+		                                   capacity * sizeof(void *));
+		epoch->r_capacity = capacity;
+	}
+
+	epoch->retired[epoch->r_nmemb++] = ptr;
+}
+
+static void destroy_epoch(struct NodeEpoch *epoch)
+{
+	struct NodeEpoch *older = epoch->older;
+
+	// an older reader may still reach what was retired during this epoch
+	for (size_t i = 0; i < epoch->r_nmemb; i++)
+	{
+		if (older)
+		{
+			queue_retired(older, epoch->retired[i]);
+		}
+		else
+		{
+			free_node(epoch->allocator, epoch->retired[i]);
+		}
+	}
+
+	const Allocator *allocator = &epoch->allocator->allocator;
+
+	memory_free(HEAP_NODES, allocator, epoch->retired);
+	memory_free(HEAP_NODES, allocator, epoch);
+}
+
 static void destroy_pages(struct NodeAlloc *allocator)
 {
 	while (allocator->pages)
 	{
-		allocator->pages = destroy_page(allocator->pages);
+		allocator->pages = destroy_page(&allocator->allocator,
+		                                allocator->pages);
 	}
+
+	shrink_nodes(allocator);
 }
 
-struct NodeAlloc create_node_allocator(const size_t node_size,
-                                       const size_t nmemb,
-                                       const size_t t1_size,
-                                       const size_t t2_size)
+size_t node_field_align(const size_t size)
 {
-	struct NodePage *pages = create_page(NULL,
-	                                     nmemb,
-	                                     node_size + t1_size + t2_size);
+	const size_t max = _Alignof(max_align_t);
+	const size_t low = size & -size;
+
+	return (!size) ? 1 : (low < max) ? low : max;
+}
+
+size_t node_field_offset(const size_t offset, const size_t size)
+{
+	return round_up(offset, node_field_align(size));
+}
 
-	struct NodeAlloc allocator = { .blocks = NULL, .pages = pages };
+struct NodeAlloc create_node_allocator(const size_t    node_size,
+                                       const size_t    nmemb,
+                                       const size_t    t1_size,
+                                       const size_t    t2_size,
+                                       const Allocator source)
+{
+	struct NodePage *pages = create_page(&source,
+	                                     NULL,
+	                                     nmemb,
+	                                     slot_layout(node_size,
+	                                                 t1_size,
+	                                                 t2_size));
+
+	struct NodeAlloc allocator = { .blocks    = NULL,
+		                           .pages     = pages,
+		                           .spare     = NULL,
+		                           .refs      = 1,
+		                           .epochs    = NULL,
+		                           .closed    = 0,
+		                           .allocator = source };
 
 	return allocator;
 }
@@ -156,23 +369,326 @@ void destroy_node_allocator(struct NodeAlloc *allocator)
 	destroy_pages(allocator);
 }
 
+struct NodeAlloc *create_shared_node_allocator(const size_t    node_size,
+                                               const size_t    nmemb,
+                                               const size_t    t1_size,
+                                               const size_t    t2_size,
+                                               const Allocator source)
+{
+	struct NodeAlloc *allocator = memory_alloc(HEAP_NODES,
+	                                           &source,
+	                                           sizeof(struct NodeAlloc));
+
+	*allocator = create_node_allocator(node_size,
+	                                   nmemb,
+	                                   t1_size,
+	                                   t2_size,
+	                                   source);
+
+	return allocator;
+}
+
+struct NodeAlloc *acquire_node_allocator(struct NodeAlloc *allocator)
+{
+	allocator->refs++;
+
+	return allocator;
+}
+
+void release_node_allocator(struct NodeAlloc **allocator)
+{
+	assert((*allocator)->refs);
+
+	if (!--(*allocator)->refs)
+	{
+		collect_node_epochs(*allocator);
+
+		assert(!(*allocator)->epochs);
+
+		destroy_pages(*allocator);
+		memory_release_container(HEAP_NODES,
+		                         (void **)allocator,
+		                         &(*allocator)->allocator);
+	}
+
+	*allocator = NULL;
+}
+
+bool shared_node_allocator(const struct NodeAlloc *allocator)
+{
+	return allocator->refs > 1;
+}
+
+struct NodeAlloc *pool_node_allocator(NodePool    *pool,
+                                      const size_t node_size,
+                                      const size_t t1_size,
+                                      const size_t t2_size)
+{
+	// nodes of other fields can share slots that align them alike
+	const struct NodeLayout layout = slot_layout(node_size, t1_size, t2_size);
+
+	for (size_t i = 0; i < pool->nmemb; i++)
+	{
+		if (same_layout(&pool->allocs[i]->pages->layout, &layout))
+		{
+			return acquire_node_allocator(pool->allocs[i]);
+		}
+	}
+
+	pool->allocs = memory_realloc(HEAP_NODES,
+	                              &pool->allocator,
+	                              pool->allocs,
+	                              pool->nmemb * sizeof(struct NodeAlloc *),
+	                              (pool->nmemb + 1) *
+	                                  sizeof(struct NodeAlloc *));
+
+	struct NodeAlloc *alloc = create_shared_node_allocator(node_size,
+	                                                       NODE_COUNT_DEFAULT,
+	                                                       t1_size,
+	                                                       t2_size,
+	                                                       pool->allocator);
+
+	pool->allocs[pool->nmemb++] = alloc;
+
+	return acquire_node_allocator(alloc);
+}
+
+NodePool *create_node_pool(void)
+{
+	return create_node_pool_with_allocator((Allocator){ 0 });
+}
+
+NodePool *create_node_pool_with_allocator(const Allocator allocator)
+{
+	NodePool *pool = memory_calloc(HEAP_NODES, &allocator, sizeof(NodePool));
+
+	pool->allocator = allocator;
+
+	return pool;
+}
+
+void destroy_node_pool(NodePool **pool)
+{
+	for (size_t i = 0; i < (*pool)->nmemb; i++)
+	{
+		release_node_allocator(&(*pool)->allocs[i]);
+	}
+
+	memory_free(HEAP_NODES, &(*pool)->allocator, (*pool)->allocs);
+	memory_release_container(HEAP_NODES, (void **)pool, &(*pool)->allocator);
+}
+
+void merge_node_allocator(struct NodeAlloc *dest, struct NodeAlloc *src)
+{
+	assert(dest != src);
+	assert(same_layout(&dest->pages->layout, &src->pages->layout));
+	assert(!memcmp(&dest->allocator, &src->allocator, sizeof(Allocator)));
+
+	struct NodePage *tail = src->pages;
+
+	while (tail->prev)
+	{
+		tail = tail->prev;
+	}
+
+	// keep the current page of dest in front so its cursor stays in use, the
+	// pages of src hold live nodes and are released with the rest
+	tail->prev        = dest->pages->prev;
+	dest->pages->prev = src->pages;
+
+	if (src->blocks)
+	{
+		struct NodeBlock *block = src->blocks;
+
+		while (block->next)
+		{
+			block = block->next;
+		}
+
+		block->next  = dest->blocks;
+		dest->blocks = src->blocks;
+	}
+
+	if (src->spare)
+	{
+		retain_page(dest, src->spare);
+	}
+
+	src->pages  = NULL;
+	src->spare  = NULL;
+	src->blocks = NULL;
+}
+
+size_t node_header_size(const struct NodeAlloc *allocator)
+{
+	return allocator->pages->layout.header;
+}
+
 void *alloc_node(struct NodeAlloc *allocator)
 {
-	return allocate_memory(&allocator->blocks, &allocator->pages);
+	return allocate_memory(allocator);
 }
 
 void free_node(struct NodeAlloc *allocator, void *ptr)
 {
-	free_memory(&allocator->pages, &allocator->blocks, ptr);
+	free_memory(allocator, ptr);
 }
 
 void clear_nodes(struct NodeAlloc *allocator)
 {
 	while (allocator->pages->prev)
 	{
-		allocator->pages = destroy_page(allocator->pages);
+		struct NodePage *page = allocator->pages;
+
+		allocator->pages = page->prev;
+
+		retain_page(allocator, page);
 	}
 
 	allocator->blocks        = NULL;
 	allocator->pages->cursor = 0;
 }
+
+void reserve_nodes(struct NodeAlloc *allocator, const size_t nmemb)
+{
+	const struct NodePage *curr = allocator->pages;
+	const size_t           room = curr->max - curr->cursor;
+
+	if (room >= nmemb ||
+	    (allocator->spare && allocator->spare->max >= nmemb - room))
+	{
+		return;
+	}
+
+	const size_t growth = page_growth(curr);
+
+	shrink_nodes(allocator);
+
+	allocator->spare = create_page(&allocator->allocator,
+	                               NULL,
+	                               (nmemb - room > growth) ? nmemb - room
+	                                                       : growth,
+	                               curr->layout);
+}
+
+struct NodePage *detach_node_pages(struct NodeAlloc *allocator,
+                                   const size_t      nmemb)
+{
+	assert(!shared_node_allocator(allocator));
+	assert(!live_node_epochs(allocator));
+
+	struct NodePage *pages = allocator->pages;
+	const size_t     limit = PAGE_BYTES_MAX / pages->layout.size;
+
+	// every node fits on the first fresh page unless that passes the cap
+	const size_t count = (nmemb < limit) ? nmemb : limit;
+
+	allocator->pages  = create_page(&allocator->allocator,
+	                                NULL,
+	                                (count) ? count : 1,
+	                                pages->layout);
+	allocator->blocks = NULL;
+
+	return pages;
+}
+
+void release_node_pages(struct NodeAlloc *allocator, struct NodePage *pages)
+{
+	while (pages)
+	{
+		pages = destroy_page(&allocator->allocator, pages);
+	}
+}
+
+void shrink_nodes(struct NodeAlloc *allocator)
+{
+	if (allocator->spare)
+	{
+		destroy_page(&allocator->allocator, allocator->spare);
+
+		allocator->spare = NULL;
+	}
+}
+
+void *clone_node(struct NodeAlloc *allocator, const void *ptr)
+{
+	void *clone = alloc_node(allocator);
+
+	memcpy(clone, ptr, allocator->pages->layout.size);
+
+	return clone;
+}
+
+struct NodeEpoch *open_node_epoch(struct NodeAlloc *allocator)
+{
+	struct NodeEpoch *epoch = memory_alloc(HEAP_NODES,
+	                                       &allocator->allocator,
+	                                       sizeof(struct NodeEpoch));
+
+	*epoch = (struct NodeEpoch){ .older      = allocator->epochs,
+		                         .allocator  = allocator,
+		                         .retired    = NULL,
+		                         .r_nmemb    = 0,
+		                         .r_capacity = 0,
+		                         .closed     = false };
+
+	allocator->epochs = epoch;
+
+	return epoch;
+}
+
+void close_node_epoch(struct NodeEpoch *epoch)
+{
+	struct NodeAlloc *allocator = epoch->allocator;
+
+	// the epoch may be collected as soon as it is marked, so the allocator
+	// must be read first
+	atomic_store_explicit(&epoch->closed, true, memory_order_release);
+	atomic_fetch_add_explicit(&allocator->closed, 1, memory_order_release);
+}
+
+bool live_node_epochs(const struct NodeAlloc *allocator)
+{
+	return allocator->epochs;
+}
+
+void retire_node(struct NodeAlloc *allocator, void *ptr)
+{
+	if (allocator->epochs)
+	{
+		queue_retired(allocator->epochs, ptr);
+	}
+	else
+	{
+		free_node(allocator, ptr);
+	}
+}
+
+void collect_node_epochs(struct NodeAlloc *allocator)
+{
+	if (!allocator->epochs ||
+	    !atomic_exchange_explicit(&allocator->closed, 0, memory_order_acquire))
+	{
+		return;
+	}
+
+	struct NodeEpoch **link = &allocator->epochs;
+
+	// newest to oldest, so the retired nodes of a closed epoch are handed to
+	// the next older one before it is inspected
+	while (*link)
+	{
+		struct NodeEpoch *epoch = *link;
+
+		if (atomic_load_explicit(&epoch->closed, memory_order_acquire))
+		{
+			*link = epoch->older;
+
+			destroy_epoch(epoch);
+		}
+		else
+		{
+			link = &epoch->older;
+		}
+	}
+}
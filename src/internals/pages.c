@@ -0,0 +1,154 @@
+#define _GNU_SOURCE
+#include "../../internals/pages.h"
+#include "../../internals/cassert.h"
+#include "../../large_page.h"
+#include <memory.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static size_t page_size(const unsigned flags)
+{
+	return (flags & LARGE_PAGES_HUGE) ? HUGE_PAGE_SIZE
+	                                  : (size_t)sysconf(_SC_PAGESIZE);
+}
+
+static size_t round_pages(const size_t size, const unsigned flags)
+{
+	const size_t page = page_size(flags);
+
+	return (size + page - 1) & ~(page - 1);
+}
+
+static void populate(void *ptr, const size_t size)
+{
+#ifdef MADV_POPULATE_WRITE
+	if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0)
+	{
+		return;
+	}
+#endif
+
+	// older kernels fault the range in one write per page
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+	for (size_t offset = 0; offset < size; offset += page)
+	{
+		((volatile char *)ptr)[offset] = 0;
+	}
+}
+
+static void *map_anonymous(const size_t size, const int flags)
+{
+	return mmap(NULL,
+	            size,
+	            PROT_READ | PROT_WRITE,
+	            MAP_PRIVATE | MAP_ANONYMOUS | flags,
+	            -1,
+	            0);
+}
+
+// maps a spare huge page and trims either end, so that transparent huge pages
+// can cover the range from its first byte
+static void *map_aligned(const size_t size)
+{
+	void *ptr = map_anonymous(size + HUGE_PAGE_SIZE, 0);
+
+	if (ptr == MAP_FAILED)
+	{
+		return ptr;
+	}
+
+	const uintptr_t base = (uintptr_t)ptr;
+	const uintptr_t head = ((base + HUGE_PAGE_SIZE - 1) &
+	                        ~(uintptr_t)(HUGE_PAGE_SIZE - 1)) -
+	                       base;
+
+	if (head)
+	{
+		munmap(ptr, head);
+	}
+
+	munmap(ptr + head + size, HUGE_PAGE_SIZE - head);
+
+	return ptr + head;
+}
+
+void *map_pages(size_t *size, const unsigned flags)
+{
+	const size_t length = round_pages(*size, flags);
+	void        *ptr    = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+	if (flags & LARGE_PAGES_HUGE)
+	{
+		ptr = map_anonymous(length,
+		                    MAP_HUGETLB |
+		                        ((flags & LARGE_PAGES_POPULATE) ? MAP_POPULATE
+		                                                        : 0));
+	}
+#endif
+
+	if (ptr == MAP_FAILED)
+	{
+		ptr = (flags & LARGE_PAGES_HUGE) ? map_aligned(length)
+		                                 : map_anonymous(length, 0);
+
+		CHEAP_ASSERT(ptr != MAP_FAILED, "Unable to map pages.");
+
+#ifdef MADV_HUGEPAGE
+		if (flags & LARGE_PAGES_HUGE)
+		{
+			madvise(ptr, length, MADV_HUGEPAGE);
+		}
+#endif
+
+		if (flags & LARGE_PAGES_POPULATE)
+		{
+			populate(ptr, length);
+		}
+	}
+
+	*size = length;
+
+	return ptr;
+}
+
+void unmap_pages(void *ptr, const size_t size)
+{
+	munmap(ptr, size);
+}
+
+void *remap_pages(void          *ptr,
+                  const size_t   old_size,
+                  size_t        *new_size,
+                  const unsigned flags)
+{
+	const size_t length = round_pages(*new_size, flags);
+
+	if (length == old_size)
+	{
+		return ptr;
+	}
+
+	void *dest = mremap(ptr, old_size, length, MREMAP_MAYMOVE);
+
+	if (dest == MAP_FAILED)
+	{
+		// hugetlb mappings cannot be remapped on older kernels
+		size_t size = length;
+
+		dest = map_pages(&size, flags);
+
+		memcpy(dest, ptr, (old_size < length) ? old_size : length);
+		munmap(ptr, old_size);
+	}
+	else if (length > old_size && (flags & LARGE_PAGES_POPULATE))
+	{
+		populate(dest + old_size, length - old_size);
+	}
+
+	*new_size = length;
+
+	return dest;
+}
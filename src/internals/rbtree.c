@@ -2,17 +2,106 @@
 // https://web.archive.org/web/20140328232325/http://en.literateprograms.org/Red-black_tree_(C)
 
 #include "../../internals/rbtree.h"
+#include "../../internals/base.h"
 #include "../../internals/cassert.h"
 #include <assert.h>
+#include <malloc.h>
 #include <memory.h>
 #include <stdbool.h>
 #include <stddef.h>
 
+#define COLOUR_MASK ((uintptr_t)1)
+#define FROZEN_MASK ((uintptr_t)2)
+#define LINK_MASK   (COLOUR_MASK | FROZEN_MASK)
+
+// descents interleaved by a batched search, enough to cover the latency of a
+// miss to memory with the comparisons of the other lanes
+#define SEARCH_LANES 8
+
+static_assert(RED == 0 && BLACK == COLOUR_MASK, "Colour must fit in one bit.");
+static_assert(_Alignof(struct TreeNode) > LINK_MASK,
+              "Node alignment must leave the two low pointer bits free.");
+
 typedef int (*KComp)(const void *, const void *);
 
+static struct TreeNode *parent_of(const struct TreeNode *node)
+{
+	return (struct TreeNode *)(node->parent & ~LINK_MASK);
+}
+
+static void set_parent(struct TreeNode *node, struct TreeNode *parent)
+{
+	node->parent = (uintptr_t)parent | (node->parent & LINK_MASK);
+}
+
+static void set_colour(struct TreeNode *node, const enum Colour colour)
+{
+	node->parent = (node->parent & ~COLOUR_MASK) | (uintptr_t)colour;
+}
+
+static void *node_key(const struct TreeNode *node)
+{
+	return (void *)(node + 1);
+}
+
+static void *node_value(const struct TreeNode *node,
+                        const size_t           k_size,
+                        const size_t           v_size)
+{
+	return (void *)(node + 1) + node_field_offset(k_size, v_size);
+}
+
+// the bytes of the node header in front of the node itself
+static size_t view_size(const struct NodeAlloc *alloc)
+{
+	return node_header_size(alloc) - sizeof(struct TreeNode);
+}
+
+static void *node_slot(const struct NodeAlloc     *alloc,
+                       const struct TreeNode *node)
+{
+	return (void *)node - view_size(alloc);
+}
+
+static struct TreeNode *new_node(struct NodeAlloc *alloc)
+{
+	return alloc_node(alloc) + view_size(alloc);
+}
+
+static void release_node(struct NodeAlloc *alloc, struct TreeNode *node)
+{
+	free_node(alloc, node_slot(alloc, node));
+}
+
+static void retire_tree_node(struct NodeAlloc *alloc, struct TreeNode *node)
+{
+	retire_node(alloc, node_slot(alloc, node));
+}
+
+// The view only holds pointers into its own node, so a copy moves each of them
+// by the distance between the two nodes.
+static struct TreeNode *copy_node(struct NodeAlloc      *alloc,
+                                  const struct TreeNode *node)
+{
+	const size_t     view = view_size(alloc);
+	void            *slot = clone_node(alloc, node_slot(alloc, node));
+	struct TreeNode *copy = slot + view;
+
+	for (size_t i = 0; i < view; i += sizeof(uintptr_t))
+	{
+		uintptr_t link;
+
+		memcpy(&link, slot + i, sizeof(link));
+		link += (uintptr_t)copy - (uintptr_t)node;
+		memcpy(slot + i, &link, sizeof(link));
+	}
+
+	return copy;
+}
+
 static enum Colour node_colour(const struct TreeNode *node)
 {
-	return (!node) ? BLACK : node->colour;
+	return (!node) ? BLACK : (enum Colour)(node->parent & COLOUR_MASK);
 }
 
 static bool is_red(const struct TreeNode *node)
@@ -25,6 +114,90 @@ static bool is_black(const struct TreeNode *node)
 	return node_colour(node) == BLACK;
 }
 
+static bool is_frozen(const struct TreeNode *node)
+{
+	return node->parent & FROZEN_MASK;
+}
+
+static void freeze(struct TreeNode *node, struct TreeNode *parent)
+{
+	if (node)
+	{
+		node->parent |= FROZEN_MASK;
+		set_parent(node, parent);
+	}
+}
+
+// A frozen node and everything below it may be reachable from a snapshot, so
+// its children, key and value must not change. The node is replaced in the
+// tree by a private copy whose children become frozen in turn, and is retired
+// until the snapshots that can reach it are released. The caller must have
+// thawed the owner of link already. Parent links are only ever read by the
+// live tree, so they may still be rewritten on shared nodes.
+static struct TreeNode *thaw_node(struct NodeAlloc  *alloc,
+                                  struct TreeNode  **link)
+{
+	struct TreeNode *node = *link;
+
+	if (!node || !is_frozen(node))
+	{
+		return node;
+	}
+
+	if (!live_node_epochs(alloc))
+	{
+		node->parent &= ~FROZEN_MASK;
+		return node;
+	}
+
+	struct TreeNode *copy = copy_node(alloc, node);
+
+	copy->parent &= ~FROZEN_MASK;
+
+	freeze(copy->left, copy);
+	freeze(copy->right, copy);
+
+	retire_tree_node(alloc, node);
+
+	*link = copy;
+
+	return copy;
+}
+
+static struct TreeNode *thaw_path(struct NodeAlloc *alloc,
+                                  struct TreeNode **head,
+                                  const void       *key,
+                                  KComp             compare)
+{
+	struct TreeNode **link = head;
+
+	while (true)
+	{
+		struct TreeNode *node   = thaw_node(alloc, link);
+		int              result = compare(key, node_key(node));
+
+		if (result == 0)
+		{
+			return node;
+		}
+
+		link = (result < 0) ? &node->left : &node->right;
+	}
+}
+
+static void thaw_sibling(struct NodeAlloc *alloc, struct TreeNode *node)
+{
+	struct TreeNode *parent = parent_of(node);
+	struct TreeNode *sibling;
+
+	sibling = thaw_node(alloc,
+	                    (node == parent->left) ? &parent->right
+	                                           : &parent->left);
+
+	thaw_node(alloc, &sibling->left);
+	thaw_node(alloc, &sibling->right);
+}
+
 static struct TreeNode *create_node(struct NodeAlloc *alloc,
                                     struct TreeNode  *parent,
                                     const void       *key,
@@ -32,18 +205,26 @@ static struct TreeNode *create_node(struct NodeAlloc *alloc,
                                     const size_t      k_size,
                                     const size_t      v_size)
 {
-	void            *memory = alloc_node(alloc);
-	struct TreeNode *node   = memory;
+	struct TreeNode *node = new_node(alloc);
+
+	node->parent = (uintptr_t)parent | RED;
+	node->left   = NULL;
+	node->right  = NULL;
+
+	if (view_size(alloc) >= sizeof(PairKV))
+	{
+		PairKV *pair = (PairKV *)node - 1;
 
-	node->pair.key   = memory + sizeof(struct TreeNode);
-	node->pair.value = memory + sizeof(struct TreeNode) + k_size;
-	node->colour     = RED;
-	node->parent     = parent;
-	node->left       = NULL;
-	node->right      = NULL;
+		pair->key   = node_key(node);
+		pair->value = node_value(node, k_size, v_size);
+	}
+
+	memcpy(node_key(node), key, k_size);
 
-	memcpy((void *)node->pair.key, key, k_size);
-	memcpy(node->pair.value, value, v_size);
+	if (v_size)
+	{
+		memcpy(node_value(node, k_size, v_size), value, v_size);
+	}
 
 	return node;
 }
@@ -51,41 +232,42 @@ static struct TreeNode *create_node(struct NodeAlloc *alloc,
 static struct TreeNode *grandparent(struct TreeNode *node)
 {
 	assert(node);
-	assert(node->parent);
-	assert(node->parent->parent);
+	assert(parent_of(node));
+	assert(parent_of(parent_of(node)));
 
-	return node->parent->parent;
+	return parent_of(parent_of(node));
 }
 
 static struct TreeNode *sibling(struct TreeNode *node)
 {
 	assert(node);
-	assert(node->parent);
+	assert(parent_of(node));
 
-	return (node == node->parent->left) ? node->parent->right
-	                                    : node->parent->left;
+	struct TreeNode *parent = parent_of(node);
+
+	return (node == parent->left) ? parent->right : parent->left;
 }
 
 static struct TreeNode *uncle(struct TreeNode *n)
 {
 	assert(n);
-	assert(n->parent);
-	assert(n->parent->parent);
+	assert(parent_of(n));
+	assert(parent_of(parent_of(n)));
 
-	return sibling(n->parent);
+	return sibling(parent_of(n));
 }
 
 static struct TreeNode *lookup_node(struct TreeNode *head,
                                     const void      *key,
                                     KComp            compare)
 {
-	assert(!head || !head->parent);
+	assert(!head || !parent_of(head));
 
 	struct TreeNode *node = head;
 
 	while (node)
 	{
-		int result = compare(key, node->pair.key);
+		int result = compare(key, node_key(node));
 
 		if (result == 0)
 		{
@@ -104,29 +286,111 @@ static struct TreeNode *lookup_node(struct TreeNode *head,
 	return node;
 }
 
+// The first node whose key is not less than key, or greater than key if after
+// is set.
+static struct TreeNode *bound_node(struct TreeNode *head,
+                                   const void      *key,
+                                   KComp            compare,
+                                   const bool       after)
+{
+	struct TreeNode *bound = NULL;
+	struct TreeNode *node  = head;
+
+	while (node)
+	{
+		if (compare(key, node_key(node)) < !after)
+		{
+			bound = node;
+			node  = node->left;
+		}
+		else
+		{
+			node = node->right;
+		}
+	}
+
+	return bound;
+}
+
+// Searches for up to SEARCH_LANES keys at once, advancing every descent by one
+// level per round and prefetching the next node of each, so the cache misses of
+// independent lookups overlap instead of following one another.
+static void lookup_nodes(struct TreeNode  *head,
+                         const void       *keys,
+                         const size_t      n,
+                         KComp             compare,
+                         const size_t      k_size,
+                         struct TreeNode **found)
+{
+	assert(n <= SEARCH_LANES);
+
+	struct TreeNode *cursor[SEARCH_LANES];
+	size_t           active = n;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		cursor[i] = head;
+		found[i]  = NULL;
+	}
+
+	while (active)
+	{
+		active = 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			struct TreeNode *node = cursor[i];
+
+			if (!node)
+			{
+				continue;
+			}
+
+			int result = compare(keys + i * k_size, node_key(node));
+
+			if (result == 0)
+			{
+				found[i]  = node;
+				cursor[i] = NULL;
+				continue;
+			}
+
+			node = (result < 0) ? node->left : node->right;
+
+			if (node)
+			{
+				__builtin_prefetch(node);
+				active++;
+			}
+
+			cursor[i] = node;
+		}
+	}
+}
+
 static void replace_node(struct TreeNode **head,
                          struct TreeNode  *old,
                          struct TreeNode *new)
 {
-	if (!old->parent)
+	if (!parent_of(old))
 	{
 		*head = new;
 	}
 	else
 	{
-		if (old == old->parent->left)
+		if (old == parent_of(old)->left)
 		{
-			old->parent->left = new;
+			parent_of(old)->left = new;
 		}
 		else
 		{
-			old->parent->right = new;
+			parent_of(old)->right = new;
 		}
 	}
 
 	if (new)
 	{
-		new->parent = old->parent;
+		set_parent(new, parent_of(old));
 	}
 }
 
@@ -140,11 +404,11 @@ static void rotate_left(struct TreeNode **head, struct TreeNode *node)
 
 	if (right->left)
 	{
-		right->left->parent = node;
+		set_parent(right->left, node);
 	}
 
 	right->left  = node;
-	node->parent = right;
+	set_parent(node, right);
 }
 
 static void rotate_right(struct TreeNode **head, struct TreeNode *node)
@@ -157,61 +421,64 @@ static void rotate_right(struct TreeNode **head, struct TreeNode *node)
 
 	if (left->right)
 	{
-		left->right->parent = node;
+		set_parent(left->right, node);
 	}
 
 	left->right  = node;
-	node->parent = left;
+	set_parent(node, left);
 }
 
-static void insert_fixup(struct TreeNode **head, struct TreeNode *node)
+// returns true if the fixup blackened a red root, i.e. the black height of the
+// whole tree grew by one
+static bool insert_fixup(struct TreeNode **head, struct TreeNode *node)
 {
-	if (!node->parent)
+	if (!parent_of(node))
 	{
-		node->colour = BLACK;
-		return;
+		set_colour(node, BLACK);
+		return true;
 	}
 
-	if (is_red(node->parent))
+	if (is_red(parent_of(node)))
 	{
 		if (is_red(uncle(node)))
 		{
-			node->parent->colour      = BLACK;
-			uncle(node)->colour       = BLACK;
-			grandparent(node)->colour = RED;
-			insert_fixup(head, grandparent(node));
-			return;
+			set_colour(parent_of(node), BLACK);
+			set_colour(uncle(node), BLACK);
+			set_colour(grandparent(node), RED);
+			return insert_fixup(head, grandparent(node));
 		}
 
-		if (node == node->parent->right &&
-		    node->parent == grandparent(node)->left)
+		if (node == parent_of(node)->right &&
+		    parent_of(node) == grandparent(node)->left)
 		{
-			rotate_left(head, node->parent);
+			rotate_left(head, parent_of(node));
 			node = node->left;
 		}
-		else if (node == node->parent->left &&
-		         node->parent == grandparent(node)->right)
+		else if (node == parent_of(node)->left &&
+		         parent_of(node) == grandparent(node)->right)
 		{
-			rotate_right(head, node->parent);
+			rotate_right(head, parent_of(node));
 			node = node->right;
 		}
 
-		node->parent->colour      = BLACK;
-		grandparent(node)->colour = RED;
+		set_colour(parent_of(node), BLACK);
+		set_colour(grandparent(node), RED);
 
-		if (node == node->parent->left &&
-		    node->parent == grandparent(node)->left)
+		if (node == parent_of(node)->left &&
+		    parent_of(node) == grandparent(node)->left)
 		{
 			rotate_right(head, grandparent(node));
 		}
 		else
 		{
-			assert(node == node->parent->right &&
-			       node->parent == grandparent(node)->right);
+			assert(node == parent_of(node)->right &&
+			       parent_of(node) == grandparent(node)->right);
 
 			rotate_left(head, grandparent(node));
 		}
 	}
+
+	return false;
 }
 
 static struct TreeNode *insert_node(struct NodeAlloc *alloc,
@@ -227,13 +494,17 @@ static struct TreeNode *insert_node(struct NodeAlloc *alloc,
 	return *sentinel;
 }
 
-static void rbt_insert(struct NodeAlloc *alloc,
-                       struct TreeNode **head,
-                       const void       *key,
-                       const void       *value,
-                       KComp             compare,
-                       const size_t      k_size,
-                       const size_t      v_size)
+// A key equal to an existing one replaces its value if unique is set, and is
+// otherwise placed after every equal key, so duplicates keep insertion order.
+// Returns the new node, or NULL if a value was replaced.
+static struct TreeNode *rbt_insert(struct NodeAlloc *alloc,
+                                   struct TreeNode **head,
+                                   const void       *key,
+                                   const void       *value,
+                                   KComp             compare,
+                                   const size_t      k_size,
+                                   const size_t      v_size,
+                                   const bool        unique)
 {
 	struct TreeNode *inserted_node = NULL;
 
@@ -249,15 +520,19 @@ static void rbt_insert(struct NodeAlloc *alloc,
 	}
 	else
 	{
-		struct TreeNode *node = *head;
+		// every node on the path may be rotated or overwritten
+		struct TreeNode *node = thaw_node(alloc, head);
 
 		while (true)
 		{
-			int result = compare(key, node->pair.key);
+			int result = compare(key, node_key(node));
 
-			if (result == 0)
+			if (result == 0 && unique)
 			{
-				memcpy(node->pair.value, value, v_size);
+				if (v_size)
+				{
+					memcpy(node_value(node, k_size, v_size), value, v_size);
+				}
 				break;
 			}
 			else if (result < 0)
@@ -275,7 +550,7 @@ static void rbt_insert(struct NodeAlloc *alloc,
 				}
 				else
 				{
-					node = node->left;
+					node = thaw_node(alloc, &node->left);
 				}
 			}
 			else
@@ -293,7 +568,7 @@ static void rbt_insert(struct NodeAlloc *alloc,
 				}
 				else
 				{
-					node = node->right;
+					node = thaw_node(alloc, &node->right);
 				}
 			}
 		}
@@ -303,97 +578,164 @@ static void rbt_insert(struct NodeAlloc *alloc,
 	{
 		insert_fixup(head, inserted_node);
 	}
+
+	return inserted_node;
 }
 
-static struct TreeNode *maximum_node(struct TreeNode *node)
+static struct TreeNode *maximum_node(struct NodeAlloc  *alloc,
+                                     struct TreeNode  **link)
 {
+	struct TreeNode *node = thaw_node(alloc, link);
+
 	assert(node);
 
 	while (node->right)
 	{
-		node = node->right;
+		node = thaw_node(alloc, &node->right);
 	}
 
 	return node;
 }
 
-static void remove_fixup(struct TreeNode **head, struct TreeNode *node)
+static void remove_fixup(struct NodeAlloc *alloc,
+                         struct TreeNode **head,
+                         struct TreeNode  *node)
 {
-	if (!node->parent)
+	if (!parent_of(node))
 	{
 		return;
 	}
 
+	// the rotations below rewrite the sibling and its children
+	thaw_sibling(alloc, node);
+
 	if (is_red(sibling(node)))
 	{
-		node->parent->colour  = RED;
-		sibling(node)->colour = BLACK;
+		set_colour(parent_of(node), RED);
+		set_colour(sibling(node), BLACK);
 
-		if (node == node->parent->left)
+		if (node == parent_of(node)->left)
 		{
-			rotate_left(head, node->parent);
+			rotate_left(head, parent_of(node));
 		}
 		else
 		{
-			rotate_right(head, node->parent);
+			rotate_right(head, parent_of(node));
 		}
+
+		thaw_sibling(alloc, node);
 	}
 
-	if (is_black(node->parent) && is_black(sibling(node)) &&
+	if (is_black(parent_of(node)) && is_black(sibling(node)) &&
 	    is_black(sibling(node)->left) && is_black(sibling(node)->right))
 	{
-		sibling(node)->colour = RED;
-		remove_fixup(head, node->parent);
+		set_colour(sibling(node), RED);
+		remove_fixup(alloc, head, parent_of(node));
 		return;
 	}
 
-	if (is_red(node->parent) && is_black(sibling(node)) &&
+	if (is_red(parent_of(node)) && is_black(sibling(node)) &&
 	    is_black(sibling(node)->left) && is_black(sibling(node)->right))
 	{
-		sibling(node)->colour = RED;
-		node->parent->colour  = BLACK;
+		set_colour(sibling(node), RED);
+		set_colour(parent_of(node), BLACK);
 		return;
 	}
 
-	if (node == node->parent->left && is_black(sibling(node)) &&
+	if (node == parent_of(node)->left && is_black(sibling(node)) &&
 	    is_red(sibling(node)->left) && is_black(sibling(node)->right))
 	{
-		sibling(node)->colour       = RED;
-		sibling(node)->left->colour = BLACK;
+		set_colour(sibling(node), RED);
+		set_colour(sibling(node)->left, BLACK);
 		rotate_right(head, sibling(node));
 	}
-	else if (node == node->parent->right && is_black(sibling(node)) &&
+	else if (node == parent_of(node)->right && is_black(sibling(node)) &&
 	         is_red(sibling(node)->right) && is_black(sibling(node)->left))
 	{
-		sibling(node)->colour        = RED;
-		sibling(node)->right->colour = BLACK;
+		set_colour(sibling(node), RED);
+		set_colour(sibling(node)->right, BLACK);
 		rotate_left(head, sibling(node));
 	}
 
-	sibling(node)->colour = node_colour(node->parent);
-	node->parent->colour  = BLACK;
+	set_colour(sibling(node), node_colour(parent_of(node)));
+	set_colour(parent_of(node), BLACK);
 
-	if (node == node->parent->left)
+	if (node == parent_of(node)->left)
 	{
 		assert(is_red(sibling(node)->right));
-		sibling(node)->right->colour = BLACK;
-		rotate_left(head, node->parent);
+		set_colour(sibling(node)->right, BLACK);
+		rotate_left(head, parent_of(node));
 	}
 	else
 	{
 		assert(is_red(sibling(node)->left));
-		sibling(node)->left->colour = BLACK;
-		rotate_right(head, node->parent);
+		set_colour(sibling(node)->left, BLACK);
+		rotate_right(head, parent_of(node));
+	}
+}
+
+static void unlink_node(struct NodeAlloc *alloc,
+                        struct TreeNode **head,
+                        struct TreeNode  *node)
+{
+	assert(!node->left || !node->right);
+
+	struct TreeNode *child = (!node->right) ? node->left : node->right;
+
+	if (is_black(node))
+	{
+		set_colour(node, node_colour(child));
+		remove_fixup(alloc, head, node);
+	}
+
+	replace_node(head, node, child);
+
+	if (!parent_of(node) && child)
+	{
+		set_colour(child, BLACK);
+	}
+}
+
+// Returns the parent of the node that was unlinked, the lowest node whose
+// subtree changed.
+static struct TreeNode *remove_node(struct NodeAlloc *alloc,
+                                    struct TreeNode **head,
+                                    struct TreeNode  *node,
+                                    const size_t      k_size,
+                                    const size_t      v_size,
+                                    size_t           *nmemb)
+{
+	// the predecessor is next in order, so moving it into the removed node
+	// keeps the order of equal keys
+	if (node->left && node->right)
+	{
+		struct TreeNode *pred = maximum_node(alloc, &node->left);
+
+		memcpy(node_key(node),
+		       node_key(pred),
+		       node_field_offset(k_size, v_size) + v_size);
+
+		node = pred;
 	}
+
+	unlink_node(alloc, head, node);
+
+	struct TreeNode *parent = parent_of(node);
+
+	release_node(alloc, node);
+	(*nmemb)--;
+
+	return parent;
 }
 
 static void rbt_delete(struct NodeAlloc *alloc,
                        struct TreeNode **head,
                        const void       *key,
                        KComp             compare,
+                       const size_t      k_size,
+                       const size_t      v_size,
                        size_t           *nmemb)
 {
-	struct TreeNode *child;
 	struct TreeNode *node = lookup_node(*head, key, compare);
 
 	if (!node)
@@ -401,131 +743,928 @@ static void rbt_delete(struct NodeAlloc *alloc,
 		return;
 	}
 
-	if (node->left && node->right)
+	if (live_node_epochs(alloc))
 	{
-		struct TreeNode *pred = maximum_node(node->left);
-		node->pair            = pred->pair;
-		node                  = pred;
+		node = thaw_path(alloc, head, key, compare);
 	}
 
-	assert(!node->left || !node->right);
-
-	child = (!node->right) ? node->left : node->right;
+	remove_node(alloc, head, node, k_size, v_size, nmemb);
+}
 
-	if (is_black(node))
+static struct TreeNode *successor(struct TreeNode *node)
+{
+	if (node->right)
 	{
-		node->colour = node_colour(child);
-		remove_fixup(head, node);
+		return rbt_min(node->right);
 	}
 
-	replace_node(head, node, child);
+	struct TreeNode *parent = parent_of(node);
 
-	if (!node->parent && child)
+	while (parent && node == parent->right)
 	{
-		child->colour = BLACK;
+		node   = parent;
+		parent = parent_of(parent);
 	}
 
-	free_node(alloc, node);
-	(*nmemb)--;
+	return parent;
 }
 
-void insert_rbtree(struct NodeAlloc *alloc,
-                   struct TreeNode **head,
-                   const void       *key,
-                   const void       *value,
-                   const KComp       compare,
-                   const size_t      k_size,
-                   const size_t      v_size,
-                   size_t           *nmemb)
+static struct TreeNode *predecessor(struct TreeNode *node)
 {
-	assert(key);
+	if (node->left)
+	{
+		return rbt_max(node->left);
+	}
 
-	rbt_insert(alloc, head, key, value, compare, k_size, v_size);
+	struct TreeNode *parent = parent_of(node);
 
-	assert(is_black(*head));
+	while (parent && node == parent->left)
+	{
+		node   = parent;
+		parent = parent_of(parent);
+	}
 
-	(*nmemb)++;
+	return parent;
 }
 
-void insert_range_rbtree_set(struct NodeAlloc *alloc,
-                             struct TreeNode **head,
-                             Range             range,
-                             Comp              compare,
-                             size_t            size,
-                             size_t           *nmemb)
+static struct TreeNode *detach_tree(struct TreeNode *node)
 {
-	bool forward            = range.begin.type < ITERATOR_REVERSE;
-	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
-	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
-
-	for (; !done(range); iterate(&range.begin))
+	if (node)
 	{
-		void *key = get_range(range);
-
-		insert_rbtree(alloc,
-					  head,
-					  key,
-					  NULL,
-					  compare,
-					  size,
-		              0,
-					  nmemb);
+		set_parent(node, NULL);
+		set_colour(node, BLACK);
 	}
+
+	return node;
 }
 
-void insert_range_rbtree_table(struct NodeAlloc *alloc,
-                               struct TreeNode **head,
-                               Range             range,
-                               Comp              compare,
-                               size_t            k_size,
-                               size_t            v_size,
-                               size_t           *nmemb)
+static size_t black_height(const struct TreeNode *node)
 {
-	bool forward            = range.begin.type < ITERATOR_REVERSE;
-	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
-	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+	size_t height = 0;
 
-	for (; !done(range); iterate(&range.begin))
+	for (; node; node = node->left)
 	{
-		PairKV *pair = get_range(range);
-
-		insert_rbtree(alloc,
-		              head,
-		              pair->key,
-		              pair->value,
-		              compare,
-		              k_size,
-		              v_size,
-		              nmemb);
+		height += is_black(node);
 	}
+
+	return height;
 }
 
-void delete_rbtree(struct NodeAlloc *alloc,
-                   struct TreeNode **head,
-                   const void       *key,
-                   const KComp       compare,
-                   size_t           *nmemb)
+// Joins two trees with black roots around mid, where every key in left is less
+// than mid and every key in mid is less than right. The cost is proportional
+// to the difference in black height.
+static struct TreeNode *join_trees(struct TreeNode *left,
+                                   const size_t     l_height,
+                                   struct TreeNode *mid,
+                                   struct TreeNode *right,
+                                   const size_t     r_height,
+                                   size_t          *height)
 {
-	if (!(*head))
+	mid->parent = (uintptr_t)NULL | BLACK;
+	mid->left   = left;
+	mid->right  = right;
+
+	if (l_height == r_height)
 	{
-		return;
-	}
+		if (left)
+		{
+			set_parent(left, mid);
+		}
 
-	rbt_delete(alloc, head, key, compare, nmemb);
+		if (right)
+		{
+			set_parent(right, mid);
+		}
 
-	assert(!(*head) || (!(*head)->parent));
+		*height = l_height + 1;
+
+		return mid;
+	}
+
+	const bool   taller_left = l_height > r_height;
+	const size_t target      = (taller_left) ? r_height : l_height;
+	size_t       h           = (taller_left) ? l_height : r_height;
+
+	struct TreeNode *head   = (taller_left) ? left : right;
+	struct TreeNode *parent = NULL;
+	struct TreeNode *node   = head;
+
+	// follow the inner spine of the taller tree down to a black node with the
+	// same black height as the shorter tree
+	while (is_red(node) || h > target)
+	{
+		h      -= is_black(node);
+		parent  = node;
+		node    = (taller_left) ? node->right : node->left;
+	}
+
+	assert(parent);
+
+	if (taller_left)
+	{
+		mid->left     = node;
+		parent->right = mid;
+	}
+	else
+	{
+		mid->right   = node;
+		parent->left = mid;
+	}
+
+	if (mid->left)
+	{
+		set_parent(mid->left, mid);
+	}
+
+	if (mid->right)
+	{
+		set_parent(mid->right, mid);
+	}
+
+	mid->parent = (uintptr_t)parent | RED;
+
+	*height = ((taller_left) ? l_height : r_height) +
+	          insert_fixup(&head, mid);
+
+	return head;
+}
+
+static struct TreeNode *join_two(struct NodeAlloc *alloc,
+                                 struct TreeNode  *left,
+                                 const size_t      l_height,
+                                 struct TreeNode  *right,
+                                 const size_t      r_height,
+                                 size_t           *height)
+{
+	if (!right || !left)
+	{
+		*height = (left) ? l_height : r_height;
+
+		return (left) ? left : right;
+	}
+
+	struct TreeNode *mid = rbt_min(right);
+
+	unlink_node(alloc, &right, mid);
+
+	return join_trees(left, l_height, mid, right, black_height(right), height);
+}
+
+// Splits a tree with a black root into keys less than key and the rest, or
+// into keys not greater than key and the rest if after is set. Each level joins
+// onto a tree whose height is bounded by the previous one, so the total cost
+// telescopes to O(log n).
+static void split_trees(struct TreeNode  *node,
+                        const size_t      height,
+                        const void       *key,
+                        KComp             compare,
+                        const bool        after,
+                        struct TreeNode **left,
+                        size_t           *l_height,
+                        struct TreeNode **right,
+                        size_t           *r_height)
+{
+	if (!node)
+	{
+		*left     = NULL;
+		*right    = NULL;
+		*l_height = 0;
+		*r_height = 0;
+
+		return;
+	}
+
+	struct TreeNode *l = node->left;
+	struct TreeNode *r = node->right;
+
+	// a red child gains a level once it is blackened as a root
+	const size_t lh = height - 1 + is_red(l);
+	const size_t rh = height - 1 + is_red(r);
+
+	detach_tree(l);
+	detach_tree(r);
+
+	struct TreeNode *sub;
+	size_t           sub_height;
+
+	if (compare(key, node_key(node)) < !after)
+	{
+		split_trees(l,
+		            lh,
+		            key,
+		            compare,
+		            after,
+		            left,
+		            l_height,
+		            &sub,
+		            &sub_height);
+		*right = join_trees(sub, sub_height, node, r, rh, r_height);
+	}
+	else
+	{
+		split_trees(r,
+		            rh,
+		            key,
+		            compare,
+		            after,
+		            &sub,
+		            &sub_height,
+		            right,
+		            r_height);
+		*left = join_trees(l, lh, node, sub, sub_height, l_height);
+	}
+}
+
+static size_t free_tree(struct NodeAlloc *alloc, struct TreeNode *node)
+{
+	if (!node)
+	{
+		return 0;
+	}
+
+	size_t count = 1 + free_tree(alloc, node->left) +
+	               free_tree(alloc, node->right);
+
+	release_node(alloc, node);
+
+	return count;
+}
+
+// Snapshots may still reach frozen nodes and everything below them, so those
+// are retired rather than freed.
+static void retire_tree(struct NodeAlloc *alloc,
+                        struct TreeNode  *node,
+                        bool              frozen)
+{
+	if (!node)
+	{
+		return;
+	}
+
+	frozen = frozen || is_frozen(node);
+
+	retire_tree(alloc, node->left, frozen);
+	retire_tree(alloc, node->right, frozen);
+
+	if (frozen)
+	{
+		retire_tree_node(alloc, node);
+	}
+	else
+	{
+		release_node(alloc, node);
+	}
+}
+
+// Finds where key belongs if that is next to hint, or next to either end of the
+// tree when hint is NULL. Returns false if key belongs elsewhere. Otherwise
+// either *found is the node already holding key, or key becomes the new left or
+// right child of *parent.
+static bool hint_position(struct TreeNode   *hint,
+                          const void        *key,
+                          KComp              compare,
+                          struct TreeEdges  *edges,
+                          struct TreeNode  **found,
+                          struct TreeNode  **parent,
+                          bool              *left)
+{
+	struct TreeNode *prev;
+	struct TreeNode *next;
+
+	*found = NULL;
+
+	if (!hint)
+	{
+		int result = compare(key, node_key(edges->max));
+
+		if (result >= 0)
+		{
+			*found  = (result == 0) ? edges->max : NULL;
+			*parent = edges->max;
+			*left   = false;
+			return true;
+		}
+
+		hint = edges->min;
+	}
+
+	int result = compare(key, node_key(hint));
+
+	if (result == 0)
+	{
+		*found = hint;
+		return true;
+	}
+
+	if (result < 0)
+	{
+		prev = (hint == edges->min) ? NULL : predecessor(hint);
+		next = hint;
+	}
+	else
+	{
+		prev = hint;
+		next = (hint == edges->max) ? NULL : successor(hint);
+	}
+
+	result = (prev && prev != hint) ? compare(key, node_key(prev)) : 1;
+
+	if (result <= 0)
+	{
+		*found = (result == 0) ? prev : NULL;
+		return result == 0;
+	}
+
+	result = (next && next != hint) ? compare(key, node_key(next)) : -1;
+
+	if (result >= 0)
+	{
+		*found = (result == 0) ? next : NULL;
+		return result == 0;
+	}
+
+	// the gap between two neighbours is either the empty left of the later
+	// one or the empty right of the earlier one
+	*left   = next && !next->left;
+	*parent = (*left) ? next : prev;
+
+	return true;
+}
+
+struct TreeNode *insert_hint_rbtree(struct NodeAlloc *alloc,
+                                    struct TreeNode **head,
+                                    struct TreeNode  *hint,
+                                    struct TreeEdges *edges,
+                                    const void       *key,
+                                    const void       *value,
+                                    const KComp       compare,
+                                    const size_t      k_size,
+                                    const size_t      v_size,
+                                    size_t           *nmemb)
+{
+	assert(key);
+
+	collect_node_epochs(alloc);
+
+	struct TreeNode *found  = NULL;
+	struct TreeNode *parent = NULL;
+	bool             left   = false;
+
+	// while snapshots are alive the whole path from the root has to be thawed
+	// and the thawed copies replace the remembered edges
+	if (*head && !live_node_epochs(alloc))
+	{
+		if (!edges->min)
+		{
+			edges->min = rbt_min(*head);
+		}
+
+		if (!edges->max)
+		{
+			edges->max = rbt_max(*head);
+		}
+
+		if (hint_position(hint, key, compare, edges, &found, &parent, &left))
+		{
+			if (found)
+			{
+				if (v_size)
+				{
+					memcpy(node_value(found, k_size, v_size), value, v_size);
+				}
+
+				return found;
+			}
+
+			struct TreeNode *node = create_node(alloc,
+			                                    parent,
+			                                    key,
+			                                    value,
+			                                    k_size,
+			                                    v_size);
+
+			if (left)
+			{
+				parent->left = node;
+				edges->min   = (parent == edges->min) ? node : edges->min;
+			}
+			else
+			{
+				parent->right = node;
+				edges->max    = (parent == edges->max) ? node : edges->max;
+			}
+
+			insert_fixup(head, node);
+			(*nmemb)++;
+
+			assert(is_black(*head));
+
+			return node;
+		}
+	}
+
+	*edges = (struct TreeEdges){ .min = NULL, .max = NULL };
+
+	if (rbt_insert(alloc, head, key, value, compare, k_size, v_size, true))
+	{
+		(*nmemb)++;
+	}
+
+	assert(is_black(*head));
+
+	return lookup_node(*head, key, compare);
+}
+
+void insert_rbtree(struct NodeAlloc *alloc,
+                   struct TreeNode **head,
+                   const void       *key,
+                   const void       *value,
+                   const KComp       compare,
+                   const size_t      k_size,
+                   const size_t      v_size,
+                   size_t           *nmemb)
+{
+	assert(key);
+
+	collect_node_epochs(alloc);
+
+	if (rbt_insert(alloc, head, key, value, compare, k_size, v_size, true))
+	{
+		(*nmemb)++;
+	}
+
+	assert(is_black(*head));
+}
+
+void insert_range_rbtree_set(struct NodeAlloc *alloc,
+                             struct TreeNode **head,
+                             Range             range,
+                             Comp              compare,
+                             size_t            size,
+                             size_t           *nmemb)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		void *key = get_range(range);
+
+		insert_rbtree(alloc,
+					  head,
+					  key,
+					  NULL,
+					  compare,
+					  size,
+		              0,
+					  nmemb);
+	}
+}
+
+void insert_range_rbtree_table(struct NodeAlloc *alloc,
+                               struct TreeNode **head,
+                               Range             range,
+                               Comp              compare,
+                               size_t            k_size,
+                               size_t            v_size,
+                               size_t           *nmemb)
+{
+	bool forward            = range.begin.type < ITERATOR_REVERSE;
+	bool (*done)(Range)     = (forward) ? done_range : done_range_r;
+	void (*iterate)(Iter *) = (forward) ? next_iter : prev_iter;
+
+	for (; !done(range); iterate(&range.begin))
+	{
+		PairKV *pair = get_range(range);
+
+		insert_rbtree(alloc,
+		              head,
+		              pair->key,
+		              pair->value,
+		              compare,
+		              k_size,
+		              v_size,
+		              nmemb);
+	}
+}
+
+void delete_rbtree(struct NodeAlloc *alloc,
+                   struct TreeNode **head,
+                   const void       *key,
+                   const KComp       compare,
+                   const size_t      k_size,
+                   const size_t      v_size,
+                   size_t           *nmemb)
+{
+	if (!(*head))
+	{
+		return;
+	}
+
+	collect_node_epochs(alloc);
+
+	rbt_delete(alloc, head, key, compare, k_size, v_size, nmemb);
+
+	assert(!(*head) || !parent_of(*head));
+}
+
+struct TreeNode *insert_multi_rbtree(struct NodeAlloc *alloc,
+                                     struct TreeNode **head,
+                                     const void       *key,
+                                     const void       *value,
+                                     const KComp       compare,
+                                     const size_t      k_size,
+                                     const size_t      v_size,
+                                     size_t           *nmemb)
+{
+	assert(key);
+
+	struct TreeNode *node = rbt_insert(alloc,
+	                                   head,
+	                                   key,
+	                                   value,
+	                                   compare,
+	                                   k_size,
+	                                   v_size,
+	                                   false);
+	(*nmemb)++;
+
+	assert(is_black(*head));
+
+	return node;
+}
+
+struct TreeNode *delete_node_rbtree(struct NodeAlloc *alloc,
+                                    struct TreeNode **head,
+                                    struct TreeNode  *node,
+                                    const size_t      k_size,
+                                    const size_t      v_size,
+                                    size_t           *nmemb)
+{
+	assert(!live_node_epochs(alloc));
+
+	struct TreeNode *parent = remove_node(alloc,
+	                                      head,
+	                                      node,
+	                                      k_size,
+	                                      v_size,
+	                                      nmemb);
+
+	assert(!(*head) || !parent_of(*head));
+
+	return parent;
+}
+
+void delete_first_rbtree(struct NodeAlloc *alloc,
+                         struct TreeNode **head,
+                         const void       *key,
+                         const KComp       compare,
+                         const size_t      k_size,
+                         const size_t      v_size,
+                         size_t           *nmemb)
+{
+	assert(!live_node_epochs(alloc));
+
+	struct TreeNode *node = bound_node(*head, key, compare, false);
+
+	if (node && compare(key, node_key(node)) == 0)
+	{
+		remove_node(alloc, head, node, k_size, v_size, nmemb);
+	}
+
+	assert(!(*head) || !parent_of(*head));
+}
+
+size_t delete_equal_rbtree(struct NodeAlloc *alloc,
+                           struct TreeNode **head,
+                           const void       *key,
+                           const KComp       compare,
+                           size_t           *nmemb)
+{
+	assert(!live_node_epochs(alloc));
+
+	if (!(*head))
+	{
+		return 0;
+	}
+
+	struct TreeNode *left;
+	struct TreeNode *rest;
+	struct TreeNode *mid;
+	struct TreeNode *right;
+	size_t           l_height;
+	size_t           rest_height;
+	size_t           m_height;
+	size_t           r_height;
+	size_t           height;
+
+	split_trees(*head,
+	            black_height(*head),
+	            key,
+	            compare,
+	            false,
+	            &left,
+	            &l_height,
+	            &rest,
+	            &rest_height);
+
+	split_trees(rest,
+	            rest_height,
+	            key,
+	            compare,
+	            true,
+	            &mid,
+	            &m_height,
+	            &right,
+	            &r_height);
+
+	*head = join_two(alloc, left, l_height, right, r_height, &height);
+
+	const size_t count = free_tree(alloc, mid);
+
+	*nmemb -= count;
+
+	return count;
 }
 
 void clear_rbtree(struct NodeAlloc *alloc,
                   struct TreeNode **head,
                   size_t           *nmemb)
 {
-	clear_nodes(alloc);
+	collect_node_epochs(alloc);
+
+	// a shared allocator holds nodes of other trees, so only this tree's
+	// nodes may be returned to it
+	if (live_node_epochs(alloc))
+	{
+		retire_tree(alloc, *head, false);
+	}
+	else if (shared_node_allocator(alloc))
+	{
+		free_tree(alloc, *head);
+	}
+	else
+	{
+		clear_nodes(alloc);
+	}
 
 	*head  = NULL;
 	*nmemb = 0;
 }
 
+// in order, so that each node lands between its left and right subtrees
+static struct TreeNode *relocate_tree(struct NodeAlloc      *alloc,
+                                      const struct TreeNode *node,
+                                      struct TreeNode       *parent)
+{
+	if (!node)
+	{
+		return NULL;
+	}
+
+	struct TreeNode *left = relocate_tree(alloc, node->left, NULL);
+	struct TreeNode *copy = copy_node(alloc, node);
+
+	set_parent(copy, parent);
+
+	copy->left = left;
+
+	if (left)
+	{
+		set_parent(left, copy);
+	}
+
+	copy->right = relocate_tree(alloc, node->right, copy);
+
+	return copy;
+}
+
+void compact_rbtree(struct NodeAlloc *alloc,
+                    struct TreeNode **head,
+                    const size_t      nmemb)
+{
+	collect_node_epochs(alloc);
+
+	if (live_node_epochs(alloc) || shared_node_allocator(alloc))
+	{
+		return;
+	}
+
+	struct NodePage *pages = detach_node_pages(alloc, nmemb);
+
+	*head = relocate_tree(alloc, *head, NULL);
+
+	release_node_pages(alloc, pages);
+}
+
+void split_rbtree(struct TreeNode **head,
+                  struct TreeNode **right,
+                  const void       *key,
+                  const KComp       compare,
+                  size_t           *nmemb,
+                  size_t           *r_nmemb)
+{
+	struct TreeNode *left;
+	size_t           l_height;
+	size_t           r_height;
+
+	split_trees(*head,
+	            black_height(*head),
+	            key,
+	            compare,
+	            false,
+	            &left,
+	            &l_height,
+	            right,
+	            &r_height);
+
+	*head = left;
+
+	// nodes carry no subtree sizes, so count both halves in lockstep and stop
+	// when the smaller one runs out
+	struct TreeNode *l     = (left) ? rbt_min(left) : NULL;
+	struct TreeNode *r     = (*right) ? rbt_min(*right) : NULL;
+	const size_t     total = *nmemb;
+	size_t           count = 0;
+
+	while (l && r)
+	{
+		l = successor(l);
+		r = successor(r);
+		count++;
+	}
+
+	*nmemb   = (!l) ? count : total - count;
+	*r_nmemb = total - *nmemb;
+}
+
+bool disjoint_rbtree(struct TreeNode *a,
+                     struct TreeNode *b,
+                     const KComp      compare)
+{
+	return !a || !b ||
+	       compare(node_key(rbt_max(a)), node_key(rbt_min(b))) < 0 ||
+	       compare(node_key(rbt_max(b)), node_key(rbt_min(a))) < 0;
+}
+
+void join_rbtree(struct NodeAlloc *alloc,
+                 struct TreeNode **head,
+                 struct TreeNode  *other,
+                 const KComp       compare,
+                 size_t           *nmemb,
+                 const size_t      o_nmemb)
+{
+	assert(disjoint_rbtree(*head, other, compare));
+
+	struct TreeNode *left  = *head;
+	struct TreeNode *right = other;
+	size_t           height;
+
+	if (left && right &&
+	    compare(node_key(rbt_min(left)), node_key(rbt_min(right))) > 0)
+	{
+		left  = other;
+		right = *head;
+	}
+
+	*head = join_two(alloc,
+	                 left,
+	                 black_height(left),
+	                 right,
+	                 black_height(right),
+	                 &height);
+
+	*nmemb += o_nmemb;
+}
+
+void merge_rbtree(struct NodeAlloc *alloc,
+                  struct TreeNode **head,
+                  struct TreeNode  *other,
+                  const KComp       compare,
+                  const size_t      k_size,
+                  const size_t      v_size,
+                  size_t           *nmemb)
+{
+	for (struct TreeNode *node = (other) ? rbt_min(other) : NULL; node;
+	     node                  = successor(node))
+	{
+		insert_rbtree(alloc,
+		              head,
+		              node_key(node),
+		              node_value(node, k_size, v_size),
+		              compare,
+		              k_size,
+		              v_size,
+		              nmemb);
+	}
+}
+
+void erase_range_rbtree(struct NodeAlloc *alloc,
+                        struct TreeNode **head,
+                        const void       *lo,
+                        const void       *hi,
+                        const KComp       compare,
+                        const size_t      k_size,
+                        const size_t      v_size,
+                        size_t           *nmemb)
+{
+	if (!(*head) || compare(lo, hi) >= 0)
+	{
+		return;
+	}
+
+	collect_node_epochs(alloc);
+
+	// snapshots still read the nodes of the range, so they are erased one by
+	// one along thawed paths instead of being cut out of the tree
+	if (live_node_epochs(alloc))
+	{
+		struct TreeNode *node;
+
+		while ((node = bound_node(*head, lo, compare, false)) &&
+		       compare(node_key(node), hi) < 0)
+		{
+			rbt_delete(alloc,
+			           head,
+			           node_key(node),
+			           compare,
+			           k_size,
+			           v_size,
+			           nmemb);
+		}
+
+		return;
+	}
+
+	struct TreeNode *left;
+	struct TreeNode *rest;
+	struct TreeNode *mid;
+	struct TreeNode *right;
+	size_t           l_height;
+	size_t           rest_height;
+	size_t           m_height;
+	size_t           r_height;
+	size_t           height;
+
+	split_trees(*head,
+	            black_height(*head),
+	            lo,
+	            compare,
+	            false,
+	            &left,
+	            &l_height,
+	            &rest,
+	            &rest_height);
+
+	split_trees(rest,
+	            rest_height,
+	            hi,
+	            compare,
+	            false,
+	            &mid,
+	            &m_height,
+	            &right,
+	            &r_height);
+
+	*head   = join_two(alloc, left, l_height, right, r_height, &height);
+	*nmemb -= free_tree(alloc, mid);
+}
+
+struct TreeSnapshot *snapshot_rbtree(struct NodeAlloc *alloc,
+                                     struct TreeNode  *head,
+                                     const KComp       compare)
+{
+	struct TreeSnapshot *snapshot = memory_alloc(HEAP_TREE,
+	                                             &alloc->allocator,
+	                                             sizeof(struct TreeSnapshot));
+
+	collect_node_epochs(alloc);
+
+	// freezing the root freezes the whole tree, the mark is pushed down one
+	// level each time the writer copies a frozen node
+	if (head)
+	{
+		head->parent |= FROZEN_MASK;
+	}
+
+	*snapshot = (struct TreeSnapshot){ .head      = head,
+		                               .compare   = compare,
+		                               .epoch     = open_node_epoch(alloc),
+		                               .allocator = alloc->allocator };
+
+	return snapshot;
+}
+
+void release_rbtree_snapshot(struct TreeSnapshot **snapshot)
+{
+	close_node_epoch((*snapshot)->epoch);
+
+	memory_release_container(HEAP_TREE,
+	                         (void **)snapshot,
+	                         &(*snapshot)->allocator);
+}
+
 void *rbt_search_k(struct TreeNode *head, const void *key, KComp compare)
 {
 	void *result = NULL;
@@ -534,13 +1673,17 @@ void *rbt_search_k(struct TreeNode *head, const void *key, KComp compare)
 
 	if (node)
 	{
-		result = (void *)node->pair.key;
+		result = node_key(node);
 	}
 
 	return result;
 }
 
-void *rbt_search_v(struct TreeNode *head, const void *key, KComp compare)
+void *rbt_search_v(struct TreeNode *head,
+                   const void      *key,
+                   KComp            compare,
+                   const size_t     k_size,
+                   const size_t     v_size)
 {
 	void *result = NULL;
 
@@ -548,12 +1691,111 @@ void *rbt_search_v(struct TreeNode *head, const void *key, KComp compare)
 
 	if (node)
 	{
-		result = node->pair.value;
+		result = node_value(node, k_size, v_size);
 	}
 
 	return result;
 }
 
+void rbt_search_many_k(struct TreeNode *head,
+                       const void      *keys,
+                       const size_t     n,
+                       KComp            compare,
+                       const size_t     k_size,
+                       void           **out)
+{
+	struct TreeNode *found[SEARCH_LANES];
+
+	for (size_t i = 0; i < n; i += SEARCH_LANES)
+	{
+		const size_t lanes = (n - i < SEARCH_LANES) ? n - i : SEARCH_LANES;
+
+		lookup_nodes(head, keys + i * k_size, lanes, compare, k_size, found);
+
+		for (size_t j = 0; j < lanes; j++)
+		{
+			out[i + j] = (found[j]) ? node_key(found[j]) : NULL;
+		}
+	}
+}
+
+void rbt_search_many_v(struct TreeNode *head,
+                       const void      *keys,
+                       const size_t     n,
+                       KComp            compare,
+                       const size_t     k_size,
+                       const size_t     v_size,
+                       void           **out)
+{
+	struct TreeNode *found[SEARCH_LANES];
+
+	for (size_t i = 0; i < n; i += SEARCH_LANES)
+	{
+		const size_t lanes = (n - i < SEARCH_LANES) ? n - i : SEARCH_LANES;
+
+		lookup_nodes(head, keys + i * k_size, lanes, compare, k_size, found);
+
+		for (size_t j = 0; j < lanes; j++)
+		{
+			out[i + j] = (found[j]) ? node_value(found[j], k_size, v_size)
+			                        : NULL;
+		}
+	}
+}
+
+void *rbt_first_k(struct TreeNode *head, const void *key, KComp compare)
+{
+	struct TreeNode *node = bound_node(head, key, compare, false);
+
+	return (node && compare(key, node_key(node)) == 0) ? node_key(node) : NULL;
+}
+
+void *rbt_first_v(struct TreeNode *head,
+                  const void      *key,
+                  KComp            compare,
+                  const size_t     k_size,
+                  const size_t     v_size)
+{
+	struct TreeNode *node = bound_node(head, key, compare, false);
+
+	return (node && compare(key, node_key(node)) == 0)
+	           ? node_value(node, k_size, v_size)
+	           : NULL;
+}
+
+struct TreeNode *rbt_lower_bound(struct TreeNode *head,
+                                 const void      *key,
+                                 KComp            compare)
+{
+	return bound_node(head, key, compare, false);
+}
+
+struct TreeNode *rbt_upper_bound(struct TreeNode *head,
+                                 const void      *key,
+                                 KComp            compare)
+{
+	return bound_node(head, key, compare, true);
+}
+
+size_t rbt_count(struct TreeNode *head, const void *key, KComp compare)
+{
+	size_t count = 0;
+
+	for (struct TreeNode *node = bound_node(head, key, compare, false);
+	     node && compare(key, node_key(node)) == 0;
+	     node = successor(node))
+	{
+		count++;
+	}
+
+	return count;
+}
+
+struct TreeNode *rbt_parent(const struct TreeNode *node)
+{
+	return parent_of(node);
+}
+
 struct TreeNode *rbt_min(struct TreeNode *node)
 {
 	while (node->left)
@@ -578,55 +1820,93 @@ struct TreeNode *rbt_max(struct TreeNode *head)
 
 void *get_rbtree_set(const Iter iter)
 {
-	return (void*)iter.data.balanced.node->pair.key;
+	return node_key(iter.data.balanced.node);
 }
 
 void *get_rbtree_table(const Iter iter)
 {
-	return &iter.data.balanced.node->pair;
+	return (PairKV *)iter.data.balanced.node - 1;
 }
 
 void next_rbtree(Iter *iter)
 {
-	struct TreeNode *node = iter->data.balanced.node;
+	iter->data.balanced.node = successor(iter->data.balanced.node);
+}
 
+void prev_rbtree(Iter *iter)
+{
+	iter->data.balanced.node = predecessor(iter->data.balanced.node);
+}
+
+// The parent links of a snapshot belong to the live tree, so a snapshot is only
+// walked downwards and a missing subtree is found by searching from the root.
+static struct TreeNode *snapshot_next(const struct TreeSnapshot *snapshot,
+                                      struct TreeNode           *node)
+{
 	if (node->right)
 	{
-		iter->data.balanced.node = rbt_min(node->right);
+		return rbt_min(node->right);
 	}
-	else
+
+	struct TreeNode *next = NULL;
+
+	for (struct TreeNode *curr = snapshot->head; curr != node;)
 	{
-		struct TreeNode *parent = node->parent;
-		while (parent && node == parent->right)
+		if (snapshot->compare(node_key(node), node_key(curr)) < 0)
 		{
-			node   = parent;
-			parent = parent->parent;
+			next = curr;
+			curr = curr->left;
+		}
+		else
+		{
+			curr = curr->right;
 		}
-
-		iter->data.balanced.node = parent;
 	}
+
+	return next;
 }
 
-void prev_rbtree(Iter *iter)
+static struct TreeNode *snapshot_prev(const struct TreeSnapshot *snapshot,
+                                      struct TreeNode           *node)
 {
-	struct TreeNode *node = iter->data.balanced.node;
-
 	if (node->left)
 	{
-		node                     = node->left;
-		node                     = rbt_max(node);
-		iter->data.balanced.node = node;
+		return rbt_max(node->left);
 	}
-	else
-	{
-		struct TreeNode *parent = node->parent;
 
-		while (parent && node == parent->left)
+	struct TreeNode *prev = NULL;
+
+	for (struct TreeNode *curr = snapshot->head; curr != node;)
+	{
+		if (snapshot->compare(node_key(node), node_key(curr)) > 0)
 		{
-			node   = parent;
-			parent = parent->parent;
+			prev = curr;
+			curr = curr->right;
+		}
+		else
+		{
+			curr = curr->left;
 		}
-
-		iter->data.balanced.node = parent;
 	}
+
+	return prev;
+}
+
+void next_rbtree_snapshot(Iter *iter)
+{
+	iter->data.snapshot.node = snapshot_next(iter->data.snapshot.snapshot,
+	                                         iter->data.snapshot.node);
+}
+
+void prev_rbtree_snapshot(Iter *iter)
+{
+	iter->data.snapshot.node = snapshot_prev(iter->data.snapshot.snapshot,
+	                                         iter->data.snapshot.node);
+}
+
+// a frozen node is never written again, so readers on any thread may share
+// its pair
+void *get_rbtree_snapshot(const Iter iter)
+{
+	return (PairKV *)iter.data.snapshot.node - 1;
 }
@@ -45,6 +45,23 @@ typedef struct Stack Stack;
  */
 ALLOC Stack *create_stack(size_t size);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a Stack object whose memory comes from @p allocator
+ *
+ * @param size The size of the type the stack is specialised to contain
+ * @param allocator The source of every allocation the stack makes
+ * @return Stack object specialised to hold values of size @p size
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass stack to destroy_stack() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The stack keeps a copy of @p allocator, whose context must
+ * outlive the stack
+ */
+ALLOC Stack *create_stack_with_allocator(size_t size, Allocator allocator);
+#endif
+
 /**
  * @brief Destroy a Stack object
  *
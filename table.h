@@ -68,6 +68,51 @@ typedef int (*KComp)(const void *a, const void *b);
  */
 ALLOC Table *create_table(size_t k_size, size_t v_size, KComp compare);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a Table object whose memory comes from @p allocator
+ *
+ * @param k_size The size of the key type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing keys
+ * @param allocator The source of every allocation the table makes
+ * @return Table object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ * @note The table keeps a copy of @p allocator, whose context must
+ * outlive the table
+ */
+ALLOC Table *create_table_with_allocator(size_t    k_size,
+                                         size_t    v_size,
+                                         KComp     compare,
+                                         Allocator allocator);
+#endif
+
+#ifdef CHEAP_NODE_POOL_AVAILABLE
+/**
+ * @brief Create a Table object whose nodes come from @p pool
+ *
+ * @param k_size The size of the key type
+ * @param v_size The size of the value type
+ * @param compare A function pointer for comparing keys
+ * @param pool The node pool shared with other containers
+ * @return Table object specialised for the given key-value pairs
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass table to destroy_table() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p k_size and @p v_size
+ * @note The table shares node pages with every container of @p pool whose
+ * nodes are the same size, and may outlive the pool
+ * @note compact_table() does nothing for a pooled table
+ */
+ALLOC Table *create_table_with_pool(size_t    k_size,
+                                    size_t    v_size,
+                                    KComp     compare,
+                                    NodePool *pool);
+#endif
+
 /**
  * @brief Destroy a Table object
  *
@@ -92,6 +137,31 @@ void destroy_table(Table **table);
  */
 void insert_table(Table *table, const void *key, const void *value);
 
+#ifdef CHEAP_ITERATOR_AVAILABLE
+/**
+ * @brief Insert a @p key @p value pair into the table, searching next to
+ * @p hint first
+ *
+ * @param table The Table object
+ * @param hint Iterator to a pair next to where @p key belongs, or end_table()
+ * for a key beyond either end of the table
+ * @param key The key to insert
+ * @param value The value to insert
+ * @return Iterator to the pair with key equivalent to @p key
+ *
+ * @warning Ensure @p key and @p value are of the correct specialised types
+ * @note If the key already exists its value is replaced
+ * @note If @p key does not belong next to @p hint the table is searched as by
+ * insert_table()
+ * @note Consecutive hinted inserts remember the first and last pairs, so
+ * ascending keys passed with end_table() are appended without a search
+ */
+Iter insert_hint_table(Table      *table,
+                       Iter        hint,
+                       const void *key,
+                       const void *value);
+#endif
+
 #ifdef CHEAP_RANGE_AVAILABLE
 /**
  * @brief Inserts unique copies of @p range kay-value pairs into the table
@@ -128,6 +198,24 @@ size_t count_table(const Table *table, const void *key);
  */
 void *find_table(const Table *table, const void *key);
 
+/**
+ * @brief Finds the @c value of each of @p n keys
+ *
+ * @param table The Table object
+ * @param keys Array of @p n keys to find
+ * @param n Number of keys in @p keys
+ * @param out Array of @p n results, each a pointer to the @c value if found,
+ * @c NULL otherwise
+ * @return Nothing
+ *
+ * @note Several searches are advanced together so that their cache misses
+ * overlap, which is faster than @p n calls to find_table() on large tables
+ */
+void find_many_table(const Table *table,
+                     const void  *keys,
+                     size_t       n,
+                     void       **out);
+
 /**
  * @brief Check if there is a @c value with @p key equivalent in the table
  *
@@ -156,6 +244,94 @@ void erase_table(Table *table, const void *key);
  */
 void clear_table(Table *table);
 
+/**
+ * @brief Moves the nodes of the table into fresh memory in key order
+ *
+ * @param table The Table object
+ * @return Nothing
+ *
+ * @note After many inserts and erases the nodes are scattered across memory,
+ * compacting makes in-order traversal sequential again without a rebuild
+ * @note Does nothing while a snapshot of @p table is alive, or while @p table
+ * shares its node allocator with another table after a split or a join
+ * @warning Invalidates every iterator to @p table
+ * @warning Cannot be called on a snapshot
+ */
+void compact_table(Table *table);
+
+/**
+ * @brief Erases every pair with a key in the half-open interval [@p lo, @p hi)
+ *
+ * @param table The Table object
+ * @param lo The smallest key to erase
+ * @param hi The first key past the range to keep
+ * @return Nothing
+ *
+ * @note The range is cut out with two splits and one join, so the cost is
+ * O(log n) plus the cost of releasing the erased nodes. While a snapshot of
+ * @p table is alive the pairs are erased one by one instead
+ */
+void erase_range_table(Table *table, const void *lo, const void *hi);
+
+/**
+ * @brief Moves the pairs of the table into two new tables, divided at @p key
+ *
+ * @param table The Table object
+ * @param key The key at which to split
+ * @param left Receives a new Table with every key less than @p key
+ * @param right Receives a new Table with every key not less than @p key
+ * @return Nothing
+ *
+ * @warning Must pass @p left and @p right to destroy_table() or memory will be
+ * leaked
+ * @note Costs O(log n + min(k, n - k)), where k keys go to @p left. The tree
+ * is cut in O(log n), but sizing the halves walks the smaller one
+ * @note @p table is left empty. All three tables share one node allocator,
+ * which is released when the last of them is destroyed
+ * @note While a snapshot of @p table is alive the pairs are copied into the
+ * new tables rather than moved
+ */
+void split_table(Table *table, const void *key, Table **left, Table **right);
+
+/**
+ * @brief Moves every pair of @p other into the table
+ *
+ * @param table The Table object
+ * @param other The Table object to move from
+ * @return Nothing
+ *
+ * @note If every key of one table is less than every key of the other the
+ * trees are joined in O(log n), otherwise the pairs of @p other are inserted
+ * one by one and replace the values of equal keys. Pairs are also inserted
+ * one by one while a snapshot of either table is alive
+ * @note @p other is left empty
+ */
+void join_table(Table *table, Table *other);
+
+/**
+ * @brief Takes a read-only snapshot of the table
+ *
+ * @param table The Table object
+ * @return Table object holding the pairs of @p table at the time of the call
+ *
+ * @warning Must pass the snapshot to destroy_table() or memory will be leaked
+ * @warning Every snapshot must be destroyed before @p table
+ * @note Taking a snapshot is O(1). The snapshot shares its nodes with @p table,
+ * which copies only the nodes on the path it changes, so neither side ever
+ * copies the whole tree
+ * @note A snapshot may be read on another thread without locking while
+ * @p table is modified. Nodes replaced by @p table are freed once every
+ * snapshot that can reach them has been destroyed
+ * @note A snapshot is allocated from the allocator of @p table and freed
+ * through it by destroy_table(). It may be destroyed on another thread only
+ * if that allocator is thread-safe, as the default heap is; otherwise destroy
+ * it on the thread that modifies @p table
+ * @note Snapshots cannot be modified
+ * @note Writing through a pointer returned by find_table() on @p table also
+ * changes the value seen by its snapshots, use insert_table() instead
+ */
+ALLOC Table *snapshot_table(Table *table);
+
 #ifdef CHEAP_ITERATOR_AVAILABLE
 /**
  * @brief Returns an iterator to the first element of the table
@@ -54,6 +54,23 @@ typedef struct Vector Vector;
  */
 ALLOC Vector *create_vector(size_t size);
 
+#ifdef CHEAP_ALLOCATOR_AVAILABLE
+/**
+ * @brief Create a Vector object whose memory comes from @p allocator
+ *
+ * @param size The size of the type the vector is specialised to contain
+ * @param allocator The source of every allocation the vector makes
+ * @return Vector object specialised to hold values of size @p size
+ *
+ * @warning Must capture the returned object or memory will be leaked
+ * @warning Must pass vector to destroy_vector() or memory will be leaked
+ * @note Use sizeof() to capture the correct @p size
+ * @note The vector keeps a copy of @p allocator, whose context must
+ * outlive the vector
+ */
+ALLOC Vector *create_vector_with_allocator(size_t size, Allocator allocator);
+#endif
+
 /**
  * @brief Destroy a Vector object
  *